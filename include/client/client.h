@@ -32,8 +32,11 @@ struct _Cerver;
 struct _Client;
 struct _Connection;
 struct _Packet;
-struct _PacketsPerType;
+struct _StatsShard;
 struct _Handler;
+struct _Reactor;
+struct _Routes;
+struct _Uring;
 
 struct _FileHeader;
 
@@ -58,16 +61,9 @@ struct _ClientStats {
 
 	time_t threshold_time;			// every time we want to reset the client's stats
 
-	u64 n_receives_done;			// n calls to recv ()
-
-	u64 total_bytes_received;		// total amount of bytes received from this client
-	u64 total_bytes_sent;			// total amount of bytes that have been sent to the client (all of its connections)
-
-	u64 n_packets_received;			// total number of packets received from this client (packet header + data)
-	u64 n_packets_sent;				// total number of packets sent to this client (all connections)
-
-	struct _PacketsPerType *received_packets;
-	struct _PacketsPerType *sent_packets;
+	// the packets counters of the client (all of its connections)
+	// that are read with client_stats_get ()
+	struct _StatsShard *shards;
 
 };
 
@@ -107,6 +103,9 @@ CLIENT_PUBLIC void client_file_stats_print (
 #define CLIENT_MAX_EVENTS				32
 #define CLIENT_MAX_ERRORS				32
 
+// one app handler for each packet header's handler id
+#define CLIENT_MAX_APP_HANDLERS			256
+
 #define CLIENT_CONNECTIONS_STATUS_MAP(XX)									\
 	XX(0,	NONE,		None, 		Undefined)								\
 	XX(1,	ERROR,		Error, 		Failed to remove connection)			\
@@ -162,9 +161,30 @@ struct _Client {
 	struct _Handler *app_packet_handler;
 	struct _Handler *app_error_packet_handler;
 	struct _Handler *custom_packet_handler;
+	struct _Handler *game_packet_handler;
+
+	// app packets are handled by the handler registered
+	// with the same id as their header's handler id
+	bool multiple_app_handlers;
+	unsigned int n_app_packet_handlers;
+	struct _Handler *app_packet_handlers[CLIENT_MAX_APP_HANDLERS];
+
+	// callbacks for app packets by packet type & request type
+	struct _Routes *routes;
 
 	bool check_packets;              // enable / disbale packet checking
 
+	// connections are read by a set of epoll threads
+	// instead of a dedicated update thread per connection
+	bool use_reactor;
+	unsigned int reactor_threads;
+	struct _Reactor *reactor;
+
+	// connections receives and sends are performed using io_uring
+	// falls back to the reactor or update threads if it is not supported
+	bool use_uring;
+	struct _Uring *uring;
+
 	// general client lock
 	pthread_mutex_t *lock;
 
@@ -246,6 +266,35 @@ CLIENT_EXPORT void client_set_custom_handler (
 	Client *client, struct _Handler *custom_handler
 );
 
+// sets a PACKET_TYPE_GAME packet type handler
+// game packets are discarded if the client does not have one
+CLIENT_EXPORT void client_set_game_handler (
+	Client *client, struct _Handler *game_handler
+);
+
+// sets whether PACKET_TYPE_APP packets will be handled by the handler
+// registered with the same id as the packet header's handler id
+// packets without a matching handler go to the app_packet_handler
+// by default, this option is turned off
+CLIENT_EXPORT void client_set_multiple_app_handlers (
+	Client *client, bool multiple_app_handlers
+);
+
+// registers a handler created with handler_create_with_id ()
+// to handle the app packets with the same handler id
+// each handler has its own job queue & workers
+// must be called before the client starts
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 client_app_handlers_register (
+	Client *client, struct _Handler *handler
+);
+
+// returns the handler that will handle app packets with the handler id
+// returns NULL if there is none
+CLIENT_EXPORT struct _Handler *client_app_handlers_get (
+	Client *client, const u8 handler_id
+);
+
 // set whether to check or not incoming packets
 // check packet's header protocol id & version compatibility
 // if packets do not pass the checks, won't be handled and will be inmediately destroyed
@@ -255,6 +304,21 @@ CLIENT_EXPORT void client_set_check_packets (
 	Client *client, bool check_packets
 );
 
+// sets whether the client's connections will be handled by a reactor
+// a fixed number of epoll threads that read from all the connections sockets
+// instead of creating an update thread for each connection (default false)
+// if n_threads is 0, one thread per online cpu will be used
+// this must be set before starting any connection
+CLIENT_EXPORT void client_set_reactor (
+	Client *client, bool use_reactor, unsigned int n_threads
+);
+
+// sets whether the client's connections will be handled by an io_uring (default false)
+// using multishot receives into provided buffers & batched sends submissions
+// if the kernel lacks io_uring support, the reactor or update threads will be used
+// this must be set before starting any connection
+CLIENT_EXPORT void client_set_uring (Client *client, bool use_uring);
+
 // compare clients based on their client ids
 CLIENT_PUBLIC int client_comparator_client_id (
 	const void *a, const void *b
@@ -324,6 +388,7 @@ CLIENT_EXPORT int client_connection_unregister (
 
 // performs a receive in the connection's socket
 // to get a complete packet & handle it
+// fails if the connection is already being updated by another thread
 // returns 0 on success, 1 on error
 CLIENT_PUBLIC unsigned int client_connection_get_next_packet (
 	Client *client, struct _Connection *connection
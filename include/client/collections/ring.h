@@ -0,0 +1,89 @@
+#ifndef _COLLECTIONS_RING_H_
+#define _COLLECTIONS_RING_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define RING_DEFAULT_CAPACITY				1024
+
+// keeps the producers & consumers positions in different cache lines
+#define RING_CACHE_LINE_SIZE				64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RING_TYPE_MAP(XX)					\
+	XX(0,	MPMC, 		Mpmc)				\
+	XX(1,	SPSC, 		Spsc)
+
+typedef enum RingType {
+
+	#define XX(num, name, string) RING_TYPE_##name = num,
+	RING_TYPE_MAP (XX)
+	#undef XX
+
+} RingType;
+
+extern const char *ring_type_to_string (const RingType type);
+
+// a bounded lock-free queue that copies its elements into its slots
+// multiple producers & consumers can use a RING_TYPE_MPMC ring at the same time
+// a RING_TYPE_SPSC ring must only be used by one producer & one consumer at a time
+typedef struct Ring {
+
+	RingType type;
+
+	size_t capacity;
+	size_t mask;
+
+	size_t element_size;
+	size_t slot_size;
+
+	// each slot starts with its sequence followed by its element
+	char *slots;
+
+	char pad_0[RING_CACHE_LINE_SIZE];
+
+	// the next position to be pushed
+	size_t tail;
+
+	char pad_1[RING_CACHE_LINE_SIZE - sizeof (size_t)];
+
+	// the next position to be popped
+	size_t head;
+
+	char pad_2[RING_CACHE_LINE_SIZE - sizeof (size_t)];
+
+} Ring;
+
+// creates a new ring that can hold capacity elements of element_size bytes
+// the capacity is rounded up to the next power of 2
+extern Ring *ring_create (
+	const RingType type,
+	const size_t capacity, const size_t element_size
+);
+
+extern void ring_delete (void *ring_ptr);
+
+// returns how many elements are inside the ring
+// the value is only an approximation while it is being used
+extern size_t ring_size (const Ring *ring);
+
+extern bool ring_is_empty (const Ring *ring);
+
+extern bool ring_is_full (const Ring *ring);
+
+// copies the element at the end of the ring
+// returns 0 on success, 1 if the ring is full
+extern unsigned int ring_push (Ring *ring, const void *element);
+
+// copies the element at the start of the ring into element
+// returns 0 on success, 1 if the ring is empty
+extern unsigned int ring_pop (Ring *ring, void *element);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -33,6 +33,13 @@
 
 #define CONNECTION_DEFAULT_RECEIVE_BUFFER_SIZE		4096
 
+#define CONNECTION_DEFAULT_ZERO_COPY_RECEIVE		false
+
+#define CONNECTION_DEFAULT_ADAPTIVE_RECEIVE			false
+
+#define CONNECTION_DEFAULT_MAX_PACKET_SIZE			65536
+#define CONNECTION_DEFAULT_MAX_STREAM_PACKET_SIZE	1073741824
+
 #define CONNECTION_DEFAULT_UPDATE_TIMEOUT			2
 
 #define CONNECTION_DEFAULT_RECEIVE_PACKETS			true
@@ -40,32 +47,71 @@
 #define CONNECTION_DEFAULT_USE_SEND_QUEUE			false
 #define CONNECTION_DEFAULT_SEND_FLAGS				0
 
+// max queued packets drained at once by the send thread
+#define CONNECTION_SEND_QUEUE_BATCH_SIZE			64
+
+// by default the send queue is unbounded
+#define CONNECTION_DEFAULT_SEND_QUEUE_MAX_PACKETS	0
+#define CONNECTION_DEFAULT_SEND_QUEUE_MAX_BYTES		0
+#define CONNECTION_DEFAULT_SEND_QUEUE_POLICY		CONNECTION_SEND_QUEUE_POLICY_BLOCK
+
+// by default the send lanes are lists, 0 for no ring
+#define CONNECTION_DEFAULT_SEND_QUEUE_RING_SIZE		0
+
+#define CONNECTION_DEFAULT_NONBLOCKING_SEND			false
+
+// max bytes parked in the output buffer of a non-blocking connection
+#define CONNECTION_DEFAULT_MAX_OUTPUT_SIZE			4194304
+#define CONNECTION_OUTPUT_MIN_BUFFER_SIZE			4096
+
+// how long the send thread waits for the socket to become writable (ms)
+#define CONNECTION_OUTPUT_FLUSH_TIMEOUT				1000
+
+// max packets taken from each lane in every round of the send thread
+#define CONNECTION_DEFAULT_SEND_LANE_CONTROL_WEIGHT			CONNECTION_SEND_QUEUE_BATCH_SIZE
+#define CONNECTION_DEFAULT_SEND_LANE_INTERACTIVE_WEIGHT		8
+#define CONNECTION_DEFAULT_SEND_LANE_BULK_WEIGHT			2
+
+// max bulk bytes in a batch while control packets are waiting
+#define CONNECTION_SEND_QUEUE_CONTROL_BULK_MAX_BYTES		16384
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct iovec;
+
 struct _Socket;
 struct _Cerver;
 struct _CerverReport;
 struct _Client;
 struct _Connection;
-struct _PacketsPerType;
+struct _StatsShard;
 struct _AdminCerver;
+struct _ReactorThread;
+struct _Requests;
+struct _Uring;
+struct _UringRequest;
+struct _UringConnection;
 
 struct _ConnectionStats {
 
 	time_t threshold_time;                  // every time we want to reset the connection's stats
 
-	u64 n_receives_done;                    // n calls to recv ()
+	// the packets counters of the connection
+	// that are read with connection_stats_get ()
+	struct _StatsShard *counters;
 
-	u64 total_bytes_received;               // total amount of bytes received from this connection
-	u64 total_bytes_sent;                   // total amount of bytes that have been sent to the connection
+	// the values chosen by the adaptive receive
+	u64 receive_buffer_size;                // the current receive buffer size
+	u64 receive_low_watermark;              // the current SO_RCVLOWAT value
+	u64 n_receive_buffer_resizes;
 
-	u64 n_packets_received;                 // total number of packets received from this connection (packet header + data)
-	u64 n_packets_sent;                     // total number of packets sent to this connection
+	u64 n_resyncs;                          // times the receive state machine got lost
+	u64 resync_skipped_bytes;               // bytes discarded while looking for a valid header
 
-	struct _PacketsPerType *received_packets;
-	struct _PacketsPerType *sent_packets;
+	u64 n_send_queue_rejected;              // packets refused by a full send queue
+	u64 n_send_queue_dropped;               // queued packets dropped to make room for new ones
 
 };
 
@@ -77,6 +123,44 @@ CLIENT_PUBLIC void connection_stats_print (
 	struct _Connection *connection
 );
 
+#define CONNECTION_SEND_QUEUE_POLICY_MAP(XX)							\
+	XX(0,	BLOCK,			Block until there is room in the queue)		\
+	XX(1,	FAIL,			Fail without queueing the packet)			\
+	XX(2,	DROP_OLDEST,	Drop the oldest queued packets)
+
+// what happens when a packet is sent to a full send queue
+typedef enum ConnectionSendQueuePolicy {
+
+	#define XX(num, name, description) CONNECTION_SEND_QUEUE_POLICY_##name = num,
+	CONNECTION_SEND_QUEUE_POLICY_MAP (XX)
+	#undef XX
+
+} ConnectionSendQueuePolicy;
+
+CLIENT_PUBLIC const char *connection_send_queue_policy_description (
+	const ConnectionSendQueuePolicy policy
+);
+
+#define CONNECTION_SEND_LANES				3
+
+// the priority classes of the outgoing packets, from highest to lowest
+#define CONNECTION_SEND_LANE_MAP(XX)			\
+	XX(0,	CONTROL,		Control)			\
+	XX(1,	INTERACTIVE,	Interactive)		\
+	XX(2,	BULK,			Bulk)
+
+typedef enum ConnectionSendLane {
+
+	#define XX(num, name, string) CONNECTION_SEND_LANE_##name = num,
+	CONNECTION_SEND_LANE_MAP (XX)
+	#undef XX
+
+} ConnectionSendLane;
+
+CLIENT_PUBLIC const char *connection_send_lane_to_string (
+	const ConnectionSendLane lane
+);
+
 // a connection from a client
 struct _Connection {
 
@@ -102,18 +186,60 @@ struct _Connection {
 	u8 bad_packets;                         // number of bad packets before being disconnected
 
 	u32 receive_packet_buffer_size;         // read packets into a buffer of this size in client_receive ()
+
+	// grow or shrink the receive buffer from the observed reads
+	bool adaptive_receive;
+	size_t receive_min_buffer_size;
+	size_t receive_max_buffer_size;
+
+	size_t max_packet_size;                 // bigger packets are considered bad
+
+	// packets with more data than the threshold
+	// are delivered to the stream handler in chunks
+	// and are limited by max_stream_packet_size instead
+	size_t stream_threshold;
+	size_t max_stream_packet_size;
+	void (*stream_handler)(PacketStream *stream);
+	void *stream_handler_data;
+
+	// received packets reference pooled receive buffers instead of copying their data
+	bool zero_copy_receive;
+	u32 receive_buffer_pool_size;           // max idle buffers kept by the pool
+	ReceiveBufferPool *receive_buffer_pool;
 	
 	ReceiveHandle receive_handle;
 
 	pthread_t update_thread_id;
 	u32 update_timeout;
 
+	// the reactor thread that handles the connection's socket
+	// when the client uses a reactor instead of update threads
+	struct _ReactorThread *reactor_thread;
+	u32 reactor_slot;
+
+	// the io_uring that handles the connection's receives and sends
+	// only accessed atomically as senders read it while it is unregistered
+	struct _Uring *uring;
+	struct _UringConnection *uring_connection;
+
+	// the sends that are waiting for the ring, sent one after the other
+	// and only used by the ring's thread
+	struct _UringRequest *uring_sends;
+	struct _UringRequest *uring_sends_tail;
+
+	// sends given to the ring that have not been completed
+	// new sends go after them to keep the stream in order
+	unsigned int uring_pending_sends;
+
 	// a place to safely store the request response
 	// like when using client_connection_request_to_cerver ()
 	void *received_data;
 	size_t received_data_size;
 	Action received_data_delete;
 
+	// requests in flight matched to their responses by correlation ids
+	struct _Requests *requests;
+
 	bool receive_packets;                   // set if the connection will receive packets or not (default true)
 	
 	// custom receive method to handle incomming packets in the connection
@@ -127,7 +253,38 @@ struct _Connection {
 	bool use_send_queue;
 	int send_flags;
 	pthread_t send_thread_id;
-	JobQueue *send_queue;
+
+	// a queue for each priority lane, drained by a weighted scheduler
+	JobQueue *send_queues[CONNECTION_SEND_LANES];
+	u32 send_lane_weights[CONNECTION_SEND_LANES];
+	u32 send_lane_packets[CONNECTION_SEND_LANES];
+	bsem *send_has_packets;                 // wakes up the send thread
+	u32 send_queue_ring_size;               // slots of each lane's ring, 0 to use lists
+
+	// limits of the packets waiting in the send queue, 0 for no limit
+	// control packets are queued even when the limits are reached
+	u32 send_queue_max_packets;
+	size_t send_queue_max_bytes;
+	ConnectionSendQueuePolicy send_queue_policy;
+
+	u32 send_queue_packets;
+	size_t send_queue_bytes;
+	bool send_queue_full;                   // the limits were reached & not yet drained to half
+	struct _Client *send_queue_client;      // used to trigger the queue's events
+	pthread_mutex_t send_queue_mutex;
+	pthread_cond_t send_queue_cond;         // signaled when queued packets are taken & sent
+	u32 send_control_sending;               // control packets in the batch that is being sent
+	bool send_failed;                       // the send thread has ended after failing to send
+
+	// sends never block, the bytes that the socket can't take are parked
+	// in the output buffer until it becomes writable again
+	// the output is protected by the socket's write mutex
+	bool nonblocking_send;
+	size_t max_output_size;
+	char *output_buffer;
+	size_t output_buffer_size;
+	size_t output_start;
+	size_t output_end;
 
 	bool authenticated;                     // the connection has been authenticated to the cerver
 	void *auth_data;                        // maybe auth credentials
@@ -193,6 +350,15 @@ CLIENT_EXPORT void connection_set_receive_buffer_size (
 	Connection *connection, u32 size
 );
 
+// enables zero-copy receives in connection_update ()
+// packets that fit inside a receive buffer will reference it instead of copying
+// their data, and buffers are returned to the connection's pool
+// once the last packet that references them has been deleted
+// pool_size is the max number of idle buffers to keep (0 to use the default)
+CLIENT_EXPORT void connection_set_zero_copy_receive (
+	Connection *connection, bool zero_copy, u32 pool_size
+);
+
 // sets the connection received data
 // 01/01/2020 - a place to safely store the request response, like when using client_connection_request_to_cerver ()
 CLIENT_EXPORT void connection_set_received_data (
@@ -200,6 +366,59 @@ CLIENT_EXPORT void connection_set_received_data (
 	void *data, size_t data_size, Action data_delete
 );
 
+// enables adaptive receives in connection_update ()
+// the receive buffer grows while reads keep filling it or packets are split
+// and shrinks after many small reads, always within min_size and max_size
+// SO_RCVLOWAT is used to wait for the complete data of a large pending packet
+// the chosen values are available in the connection's stats
+// use 0 for min_size and max_size to use the default values
+// zero-copy & custom receives take precedence over adaptive receives
+// the reactor & io_uring backends use their own buffers and ignore it
+CLIENT_EXPORT void connection_set_adaptive_receive (
+	Connection *connection, bool adaptive,
+	size_t min_size, size_t max_size
+);
+
+// sets the max size of the packets (including their header)
+// that the connection will accept, bigger packets are considered bad
+// streamed packets are checked against the max stream packet size
+// by default the value CONNECTION_DEFAULT_MAX_PACKET_SIZE is used
+CLIENT_EXPORT void connection_set_max_packet_size (
+	Connection *connection, size_t max_packet_size
+);
+
+// packets with more than threshold bytes of data will be delivered
+// to the stream handler in chunks as their bytes arrive
+// instead of being buffered whole and sent to the packet handlers
+// they can be bigger than the connection's max packet size
+// up to its max stream packet size
+// the stream's done flag is set with the packet's last chunk
+// data is passed to the handler in the stream's data field
+CLIENT_EXPORT void connection_set_stream_handler (
+	Connection *connection, size_t threshold,
+	void (*stream_handler)(PacketStream *stream), void *data
+);
+
+// sets the max size of the packets (including their header)
+// that are delivered to the stream handler, bigger packets are considered bad
+// by default the value CONNECTION_DEFAULT_MAX_STREAM_PACKET_SIZE is used
+CLIENT_EXPORT void connection_set_max_stream_packet_size (
+	Connection *connection, size_t max_stream_packet_size
+);
+
+// checks if a packet of packet_size bytes (including its header)
+// will be delivered to the connection's stream handler
+CLIENT_PRIVATE bool connection_packet_is_streamed (
+	const Connection *connection, const size_t packet_size
+);
+
+// checks if a packet of packet_size bytes (including its header)
+// is accepted by the connection, using the max stream packet size
+// for the packets that are streamed and the max packet size for the rest
+CLIENT_PRIVATE bool connection_packet_size_is_valid (
+	const Connection *connection, const size_t packet_size
+);
+
 // sets the timeout (in secs) the connection's socket will have
 // this refers to the time the socket will block waiting for new data to araive
 // note that this only has effect in connection_update ()
@@ -234,6 +453,42 @@ CLIENT_PUBLIC void connection_set_send_queue (
 	Connection *connection, int flags
 );
 
+// limits the packets waiting in the connection's send queue
+// by their count and by their total size, 0 for no limit
+// the policy decides what happens to packets sent to a full queue
+// CLIENT_EVENT_SEND_QUEUE_HIGH is triggered when the queue reaches its limits
+// and CLIENT_EVENT_SEND_QUEUE_LOW once it has been drained below half of them
+CLIENT_EXPORT void connection_set_send_queue_limits (
+	Connection *connection,
+	u32 max_packets, size_t max_bytes,
+	ConnectionSendQueuePolicy policy
+);
+
+// stores the packets of each send lane inline in a bounded ring
+// instead of a list, a full lane is handled using the queue's policy
+// must be called before the connection starts
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 connection_set_send_queue_ring (
+	Connection *connection, u32 ring_size
+);
+
+// enables non-blocking sends in the connection, sends will return
+// as soon as the socket stops taking bytes, and the rest will be parked
+// in the connection's output buffer, up to max_output_size bytes (0 for the default)
+// the parked bytes are sent when the reactor finds the socket writable,
+// by the connection's send and update threads, and by any other send
+// must be set before the connection gets started
+CLIENT_EXPORT void connection_set_nonblocking_send (
+	Connection *connection, bool nonblocking, size_t max_output_size
+);
+
+// sets the max packets that the send thread takes from the lane
+// in every round, lanes are visited from the highest priority to the lowest
+// so control packets preempt the others between batches
+CLIENT_EXPORT void connection_set_send_lane_weight (
+	Connection *connection, const ConnectionSendLane lane, u32 weight
+);
+
 
 // sets the connection auth data to send whenever the cerver requires authentication
 // and a method to destroy it once the connection has ended,
@@ -289,10 +544,51 @@ CLIENT_PRIVATE void *connection_update (
 	void *client_connection_ptr
 );
 
-CLIENT_PUBLIC void connection_send_packet (
+// sends the buffers without blocking, parking in the output buffer
+// the bytes that the socket can't take right now
+// fails without sending anything if they would not fit
+// the socket's write mutex must be locked by the caller
+CLIENT_PRIVATE PacketSendResult connection_output_send (
+	Connection *connection,
+	const struct iovec *iov, const size_t n_iov,
+	int flags, size_t *total_sent
+);
+
+// sends as much of the parked output as the socket takes without blocking
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+CLIENT_PRIVATE PacketSendResult connection_output_flush (
+	Connection *connection
+);
+
+// waits up to timeout ms for the parked output to be sent
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+CLIENT_EXPORT PacketSendResult connection_flush (
+	Connection *connection, const int timeout
+);
+
+// pushes a generated packet into the connection's send queue
+// the lane is selected from the packet's type, auth, requests, pings
+// & close packets go to the control lane and app packets to the bulk lane
+// the queue takes ownership of the packet only on success
+// returns 0 on success, 1 if the packet was not queued
+CLIENT_PUBLIC u8 connection_send_packet (
 	Connection *connection, Packet *packet
 );
 
+// works as connection_send_packet () but using the selected lane
+CLIENT_PUBLIC u8 connection_send_packet_lane (
+	Connection *connection, Packet *packet, const ConnectionSendLane lane
+);
+
+// sends a packet generated by the library, like auth, ping & close ones
+// a copy goes through the control lane if the connection has a send queue
+// if wait is set, waits until the control packets have been sent
+// the packet is never consumed
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 connection_send_control_packet (
+	Connection *connection, const Packet *packet, const bool wait
+);
+
 CLIENT_PRIVATE void *connection_send_thread (
 	void *client_connection_ptr
 );
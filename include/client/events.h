@@ -34,7 +34,9 @@ struct _Connection;
 	XX(14,	LOBBY_JOIN, 		Correctly joined a new lobby)																					\
 	XX(15,	LOBBY_LEAVE, 		Successfully exited a lobby)																					\
 	XX(16,	LOBBY_START, 		The game in the lobby has started)																				\
-	XX(17,	UNKNOWN, 			Unknown event)
+	XX(17,	SEND_QUEUE_HIGH, 	A connection send queue has reached its limits; producers should slow down)									\
+	XX(18,	SEND_QUEUE_LOW, 	A full connection send queue has been drained below half of its limits)										\
+	XX(19,	UNKNOWN, 			Unknown event)
 
 typedef enum ClientEventType {
 
@@ -9,6 +9,21 @@
 
 #define RECEIVE_PACKET_BUFFER_SIZE          8192
 
+#define HANDLER_DEFAULT_N_WORKERS           1
+
+#define HANDLER_DEFAULT_BATCH_SIZE          32
+
+// packets that can wait in a job queue, 0 for no limit
+#define HANDLER_DEFAULT_QUEUE_LIMIT         0
+
+#define HANDLER_DEFAULT_QUEUE_POLICY        HANDLER_QUEUE_POLICY_DROP_NEWEST
+
+// packets priorities go from 0 (lowest) to HANDLER_PRIORITY_LEVELS - 1
+#define HANDLER_PRIORITY_LEVELS             4
+
+// ms between checks if a paused read can continue
+#define HANDLER_QUEUE_PAUSE_INTERVAL        100
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -17,6 +32,9 @@ struct _Client;
 struct _Connection;
 struct _Packet;
 
+struct _Handler;
+struct _Mailbox;
+
 typedef enum HandlerType {
 
 	HANDLER_TYPE_NONE         = 0,
@@ -31,12 +49,69 @@ typedef enum HandlerType {
 typedef struct HandlerData {
 
 	int handler_id;
+	unsigned int worker_id;         // the handler's thread that is handling the packet
 
 	void *data;                     // handler's own data
 	struct _Packet *packet;         // the packet to handle
 
 } HandlerData;
 
+// the structure that will be passed to a batch handler
+typedef struct HandlerBatchData {
+
+	int handler_id;
+	unsigned int worker_id;         // the handler's thread that is handling the packets
+
+	void *data;                     // handler's own data
+
+	struct _Packet **packets;       // the packets to handle in the order they arrived
+	unsigned int n_packets;
+
+} HandlerBatchData;
+
+// returns the key of a packet
+// packets with the same key are handled in order by the same worker
+typedef u64 (*HandlerKey) (const struct _Packet *packet);
+
+// returns the priority of a packet, from 0 to HANDLER_PRIORITY_LEVELS - 1
+typedef u8 (*HandlerPriority) (const struct _Packet *packet);
+
+#define HANDLER_QUEUE_POLICY_MAP(XX)																		\
+	XX(0,	DROP_NEWEST,	Drop the new packets that do not fit in the queue)							\
+	XX(1,	DROP_OLDEST,	Drop the oldest queued packets to make room for new ones)					\
+	XX(2,	DROP_PRIORITY,	Drop lower priority packets as the queue fills up)							\
+	XX(3,	PAUSE_READS,	Stop reading from the connection until there is room in the queue)
+
+// what happens when a packet arrives to a full job queue
+typedef enum HandlerQueuePolicy {
+
+	#define XX(num, name, description) HANDLER_QUEUE_POLICY_##name = num,
+	HANDLER_QUEUE_POLICY_MAP (XX)
+	#undef XX
+
+} HandlerQueuePolicy;
+
+CLIENT_PUBLIC const char *handler_queue_policy_description (
+	const HandlerQueuePolicy policy
+);
+
+// a thread that handles packets from its handler's job queue
+typedef struct HandlerWorker {
+
+	unsigned int id;
+	pthread_t thread_id;
+
+	struct _Handler *handler;
+
+	// the handler's job queue, or the worker's own one if the handler has a key
+	JobQueue *job_queue;
+
+	// the worker's own data, created with the handler's data_create ()
+	// or the handler's data if there is no method to create it
+	void *data;
+
+} HandlerWorker;
+
 struct _Handler {
 
 	HandlerType type;
@@ -47,12 +122,17 @@ struct _Handler {
 	int id;
 	pthread_t thread_id;
 
+	// the threads that share the job queue to handle packets
+	unsigned int n_workers;
+	unsigned int n_workers_alive;
+	HandlerWorker *workers;
+
 	// unique handler data
 	// will be passed to jobs alongside any job specific data as the args
 	void *data;
 
 	// must return a newly allocated handler unique data
-	// will be executed when the handler starts
+	// will be executed by each of the handler's workers when it starts
 	void *(*data_create) (void *args);
 	void *data_create_args;
 
@@ -63,6 +143,11 @@ struct _Handler {
 	// the method that this handler will execute to handle packets
 	Action handler;
 
+	// if set, it is called with a HandlerBatchData instead of the handler method
+	// with up to batch_size packets that were pulled at once
+	Action batch_handler;
+	unsigned int batch_size;
+
 	// used to avoid pushing job to the queue and instead handle
 	// the packet directly in the same thread
 	// this option is set to false as default
@@ -76,6 +161,26 @@ struct _Handler {
 	// passed as args to the handler method
 	JobQueue *job_queue;
 
+	// if set, each worker gets its own job queue
+	// and packets are pushed to the one that matches their key
+	HandlerKey key;
+
+	// if set, only the latest packet of each key waits to be handled
+	// and the new packets replace the pending ones in the mailbox
+	HandlerKey conflate_key;
+	struct _Mailbox *mailbox;
+
+	// packets that can wait in each job queue, 0 for no limit
+	// packets that are shed are counted in the stats shed packets
+	size_t queue_limit;
+	HandlerQueuePolicy queue_policy;
+	HandlerPriority priority;
+
+	// readers that are paused waiting for room in a job queue
+	unsigned int n_paused;
+	pthread_mutex_t queue_mutex;
+	pthread_cond_t queue_cond;      // signaled when workers take packets
+
 	struct _Cerver *cerver;     // the cerver this handler belongs to
 	struct _Client *client;     // the client this handler belongs to
 
@@ -129,10 +234,88 @@ CLIENT_EXPORT void handler_set_direct_handle (
 	Handler *handler, bool direct_handle
 );
 
-// starts the new handler by creating a dedicated thread for it
+// sets a method that handles up to batch_size packets at once
+// with a HandlerBatchData instead of calling the handler method for each one
+// the packets are deleted after the method returns
+// if batch_size is 0, HANDLER_DEFAULT_BATCH_SIZE will be used
+// must be called before the handler gets registered
+CLIENT_EXPORT void handler_set_batch_handler (
+	Handler *handler, Action batch_handler, unsigned int batch_size
+);
+
+// keeps only the latest packet of each key waiting to be handled
+// a new packet with the same key as a pending one replaces it in place
+// and the replaced packet is deleted without being handled
+// with many workers, the packets of each key are handled by the same worker
+// using the conflate key instead of the one from handler_set_key ()
+// must be called before the handler gets registered
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 handler_set_conflate (
+	Handler *handler, HandlerKey conflate_key
+);
+
+// sets how many packets can wait in each of the handler's job queues
+// and what happens to the packets that arrive when a queue is full
+// HANDLER_QUEUE_POLICY_PAUSE_READS blocks the thread that reads
+// from the connection so the cerver gets TCP back pressure,
+// only update threads get paused, as the reactor & io_uring threads are
+// shared by many connections, their packets are dropped like with DROP_NEWEST
+// if queue_limit is 0, packets are queued without limit (default)
+CLIENT_EXPORT void handler_set_queue_limit (
+	Handler *handler,
+	size_t queue_limit, HandlerQueuePolicy queue_policy
+);
+
+// sets the method to get the priority of the packets
+// used by HANDLER_QUEUE_POLICY_DROP_PRIORITY, where packets with priority p
+// are dropped once the queue has limit * (p + 1) / HANDLER_PRIORITY_LEVELS packets
+// without a method, every packet gets the highest priority
+CLIENT_EXPORT void handler_set_priority (
+	Handler *handler, HandlerPriority priority
+);
+
+// stores the handler's packets in a bounded lock-free ring
+// instead of a list, packets that don't fit are discarded
+// must be called before the handler gets registered
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 handler_set_ring (
+	Handler *handler, const size_t capacity
+);
+
+// sets how many threads will handle the packets from the handler's job queue
+// each worker gets its own data from the handler's data_create () method
+// packets can be handled in a different order than they arrived
+// must be called before the handler gets registered
+CLIENT_EXPORT void handler_set_workers (
+	Handler *handler, unsigned int n_workers
+);
+
+// handles the packets with the same key in order by the same worker
+// while packets with different keys are handled in parallel by the others
+// a packet's worker is selected with its key modulo the number of workers
+// must be called before the handler gets registered
+CLIENT_EXPORT void handler_set_key (
+	Handler *handler, HandlerKey key
+);
+
+// uses the packet's request type as its key
+CLIENT_EXPORT u64 handler_key_request_type (const struct _Packet *packet);
+
+// starts the new handler by creating its dedicated worker threads
 // called by internal cerver methods
 CLIENT_PRIVATE int handler_start (Handler *handler);
 
+// wakes up every worker that is waiting for new packets
+CLIENT_PRIVATE void handler_wake_up (Handler *handler);
+
+// pushes the packet to the job queue of the worker that will handle it
+// the worker calls work instead of the handler's method if it is set
+// packets shed by the handler's queue policy are deleted
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 handler_push_packet (
+	Handler *handler, Action work, struct _Packet *packet
+);
+
 #define CLIENT_HANDLER_ERROR_MAP(XX)										\
 	XX(0,	NONE,		None,				No handler error)				\
 	XX(1,	PACKET,		Bad Packet,			Packet check failed)			\
@@ -156,6 +339,12 @@ CLIENT_PUBLIC const char *client_handler_error_description (
 
 CLIENT_PRIVATE u8 client_packet_handler (Packet *packet);
 
+// handles a failed recive from a connection associatd with a client
+// ends the connection to prevent seg faults or signals for bad sock fd
+CLIENT_PRIVATE void client_receive_handle_failed (
+	struct _Client *client, struct _Connection *connection
+);
+
 // performs the actual recv () method on the connection's sock fd
 // handles if the receive method failed
 // the amount of bytes read from the socket is placed in rc
@@ -175,6 +364,27 @@ CLIENT_PRIVATE ReceiveError client_receive_data (
 	size_t requested_data
 );
 
+// returns the offset of the first valid header in the buffer
+// or size if none was found
+// only offsets with a complete header in the buffer are checked
+CLIENT_PRIVATE size_t client_receive_resync_scan (
+	const ReceiveHandle *receive_handle,
+	const char *buffer, size_t size
+);
+
+// handles the received bytes using the connection's receive handle state machine
+CLIENT_PRIVATE void client_receive_handle_data (
+	struct _Client *client, struct _Connection *connection,
+	char *buffer, const size_t buffer_size,
+	const size_t received
+);
+
+// handles the bytes that were read ahead by client_connection_get_next_packet ()
+// before the connection's socket starts being read by the receive handle
+CLIENT_PRIVATE void client_receive_handle_read_ahead (
+	struct _Client *client, struct _Connection *connection
+);
+
 // receive data from connection's socket
 // this method does not perform any checks and expects a valid buffer
 // to handle incomming data
@@ -184,6 +394,22 @@ CLIENT_PRIVATE unsigned int client_receive_internal (
 	char *buffer, const size_t buffer_size
 );
 
+// receives data from the connection's socket into a buffer taken from the pool
+// complete packets will reference the buffer instead of copying their data
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE unsigned int client_receive_zero_copy (
+	struct _Client *client, struct _Connection *connection,
+	ReceiveBufferPool *pool
+);
+
+// receives data from the connection's socket into the adaptive buffer
+// and tunes its size from the amount of data that was received
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE unsigned int client_receive_adaptive (
+	struct _Client *client, struct _Connection *connection,
+	ReceiveAdaptive *adaptive
+);
+
 // allocates a new packet buffer to receive incoming data from the connection's socket
 // returns 0 on success handle, 1 if any error ocurred and must likely the connection was ended
 CLIENT_PUBLIC unsigned int client_receive (
@@ -0,0 +1,84 @@
+#ifndef _CLIENT_MAILBOX_H_
+#define _CLIENT_MAILBOX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/config.h"
+
+// initial buckets of the pending keys table
+// must be a power of 2
+#define MAILBOX_DEFAULT_N_BUCKETS				64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Packet;
+
+// the latest packet of a key that is waiting to be handled
+struct _MailboxEntry {
+
+	u64 key;
+
+	struct _Packet *packet;
+
+	struct _MailboxEntry *next;
+
+};
+
+typedef struct _MailboxEntry MailboxEntry;
+
+// keeps only the latest packet of each key until it gets handled
+// a new packet for a pending key replaces the previous one in place
+struct _Mailbox {
+
+	MailboxEntry **buckets;
+	size_t n_buckets;
+	size_t n_pending;
+
+	// entries that are reused for new pending keys
+	MailboxEntry *free_entries;
+
+	// packets that were replaced before being handled
+	u64 n_conflated;
+
+	pthread_mutex_t mutex;
+
+};
+
+typedef struct _Mailbox Mailbox;
+
+CLIENT_PRIVATE Mailbox *mailbox_create (void);
+
+// deletes the mailbox with its pending packets
+CLIENT_PRIVATE void mailbox_delete (void *mailbox_ptr);
+
+// stores the packet as the latest value of its key
+// returns the new entry that should be queued to be handled
+// returns NULL if the packet replaced a pending one, that is placed in replaced
+CLIENT_PRIVATE MailboxEntry *mailbox_put (
+	Mailbox *mailbox,
+	const u64 key, struct _Packet *packet,
+	struct _Packet **replaced
+);
+
+// removes the queued entry from the mailbox
+// returns the latest packet of its key
+CLIENT_PRIVATE struct _Packet *mailbox_take (
+	Mailbox *mailbox, MailboxEntry *entry
+);
+
+CLIENT_PUBLIC size_t mailbox_get_n_pending (Mailbox *mailbox);
+
+CLIENT_PUBLIC u64 mailbox_get_n_conflated (Mailbox *mailbox);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
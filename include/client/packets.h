@@ -9,6 +9,10 @@
 #include "client/config.h"
 #include "client/network.h"
 
+// max packets and bytes sent with a single sendmsg () by packet_send_batch ()
+#define PACKETS_SEND_BATCH_MAX_IOVECS		64
+#define PACKETS_SEND_BATCH_MAX_BYTES		262144
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -17,6 +21,8 @@ struct _Client;
 struct _Connection;
 struct _Socket;
 
+struct _ReceiveBuffer;
+
 #pragma region protocol
 
 typedef u32 ProtocolID;
@@ -189,6 +195,60 @@ CLIENT_PUBLIC void packet_header_log (
 
 #pragma endregion
 
+#pragma region pool
+
+// packets data is taken from size classes
+// starting at 64 bytes, each class is 4 times bigger
+#define PACKETS_POOL_N_CLASSES				6
+#define PACKETS_POOL_MIN_CLASS_SIZE			64
+
+// max items of each class cached by every thread
+#define PACKETS_POOL_CACHE_SIZE				16
+
+// items moved between a thread's cache and the global pool at once
+#define PACKETS_POOL_TRANSFER_SIZE			8
+
+// max bytes of each class kept by the global pool
+#define PACKETS_POOL_GLOBAL_SIZE			4194304
+
+struct _PacketsPoolStats {
+
+	u64 packets_hits;                   // packets taken from a cache
+	u64 packets_misses;                 // packets that had to be allocated
+
+	u64 data_hits;                      // data buffers taken from a cache
+	u64 data_misses;                    // data buffers that had to be allocated
+	u64 data_oversized;                 // data bigger than the largest class
+
+};
+
+typedef struct _PacketsPoolStats PacketsPoolStats;
+
+// gets the sum of the pool stats of every thread
+CLIENT_EXPORT void packets_pool_get_stats (PacketsPoolStats *stats);
+
+CLIENT_EXPORT void packets_pool_stats_print (void);
+
+// frees the packets & buffers cached by the global pool
+// and by the calling thread
+CLIENT_EXPORT void packets_pool_clear (void);
+
+// gets a buffer that can hold at least size bytes
+// data_class is set to the buffer's class that is required to release it
+CLIENT_PRIVATE void *packets_pool_data_get (
+	const size_t size, u8 *data_class
+);
+
+// returns the buffer to the pool or frees it if it was not pooled
+CLIENT_PRIVATE void packets_pool_data_release (
+	void *data, const u8 data_class
+);
+
+// returns the amount of bytes that a buffer of the class can hold
+CLIENT_PRIVATE size_t packets_pool_data_capacity (const u8 data_class);
+
+#pragma endregion
+
 #pragma region packets
 
 #define CERVER_PACKET_TYPE_MAP(XX)			\
@@ -277,6 +337,15 @@ struct _Packet {
 	char *data_ptr;
 	char *data_end;
 	bool data_ref;
+	u8 data_class;                      // pool class of the data, 0 if malloc () was used
+
+	// the data is allocated with room for the header in front of it
+	// so the packet can be generated without copying its data
+	bool data_headroom;
+
+	// the receive buffer that holds the packet's data
+	// when it was received using zero-copy receives
+	struct _ReceiveBuffer *receive_buffer;
 
 	// used to handle big packets
 	// that don't fit inside a single buffer
@@ -290,6 +359,7 @@ struct _Packet {
 	size_t packet_size;
 	void *packet;
 	bool packet_ref;
+	u8 packet_class;                    // pool class of the packet, 0 if malloc () was used
 
 };
 
@@ -313,6 +383,13 @@ CLIENT_PRIVATE Packet *packet_create_with_data (
 	const size_t data_size
 );
 
+// creates a packet whose data points to a slice of a receive buffer
+// a reference to the buffer is kept until the packet gets deleted
+CLIENT_PRIVATE Packet *packet_create_with_buffer (
+	struct _ReceiveBuffer *buffer,
+	char *data, const size_t data_size
+);
+
 // sets the packet destinatary to whom this packet is going to be sent
 CLIENT_EXPORT void packet_set_network_values (
 	Packet *packet,
@@ -422,6 +499,15 @@ CLIENT_PRIVATE u8 packet_send_actual (
 	struct _Client *client, struct _Connection *connection
 );
 
+// sends the packets in order using as few sendmsg () calls as possible
+// a partial write continues from the first byte that was not sent
+// stats are updated for every packet that was completely sent
+// returns the number of packets that were completely sent
+CLIENT_PRIVATE size_t packet_send_batch (
+	Packet **packets, const size_t n_packets, int flags,
+	struct _Client *client, struct _Connection *connection
+);
+
 // sends a packet using its network values
 // raw flag to send a raw packet (only the data that was set to the packet, without any header)
 // returns 0 on success, 1 on error
@@ -429,6 +515,31 @@ CLIENT_EXPORT u8 packet_send (
 	const Packet *packet, int flags, size_t *total_sent, bool raw
 );
 
+#define PACKET_SEND_RESULT_MAP(XX)					\
+	XX(0,	SENT,		Sent)						\
+	XX(1,	ERROR,		Error)						\
+	XX(2,	QUEUED,		Queued)
+
+typedef enum PacketSendResult {
+
+	#define XX(num, name, string) PACKET_SEND_RESULT_##name = num,
+	PACKET_SEND_RESULT_MAP (XX)
+	#undef XX
+
+} PacketSendResult;
+
+CLIENT_PUBLIC const char *packet_send_result_to_string (
+	const PacketSendResult result
+);
+
+// sends a packet using its network values without blocking
+// the bytes that the socket can't take are parked in the connection's
+// output buffer and will be sent when the socket becomes writable
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+CLIENT_EXPORT PacketSendResult packet_send_nonblocking (
+	const Packet *packet, int flags, size_t *total_sent
+);
+
 // works just as packet_send () but the socket's write mutex won't be locked
 // useful when you need to lock the mutex manually
 // returns 0 on success, 1 on error
@@ -494,6 +605,7 @@ CLIENT_EXPORT u8 packet_send_request (
 );
 
 // sends a ping packet (PACKET_TYPE_TEST)
+// it goes before the packets queued in the connection's send queue
 // returns 0 on success, 1 on error
 CLIENT_EXPORT u8 packet_send_ping (
 	struct _Client *client, struct _Connection *connection
@@ -515,6 +627,134 @@ CLIENT_EXPORT bool packet_check (const Packet *packet);
 
 #pragma endregion
 
+#pragma region writer
+
+// integers are written in network byte order
+// strings & blobs are prefixed with their u32 length
+
+// writes typed values at the end of a packet's data
+// the data grows geometrically as needed
+// after a failed put, every other put is ignored
+struct _PacketWriter {
+
+	Packet *packet;
+
+	size_t capacity;                    // bytes available in the packet's data
+	bool error;
+
+};
+
+typedef struct _PacketWriter PacketWriter;
+
+// prepares the writer to append values to the packet's data
+// reserves size_hint bytes to avoid growing the data while writing
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 packet_writer_init (
+	PacketWriter *writer, Packet *packet, const size_t size_hint
+);
+
+// makes sure that size bytes can be written without growing the data
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 packet_writer_reserve (
+	PacketWriter *writer, const size_t size
+);
+
+CLIENT_EXPORT u8 packet_writer_put_u8 (PacketWriter *writer, const u8 value);
+
+CLIENT_EXPORT u8 packet_writer_put_u16 (PacketWriter *writer, const u16 value);
+
+CLIENT_EXPORT u8 packet_writer_put_u32 (PacketWriter *writer, const u32 value);
+
+CLIENT_EXPORT u8 packet_writer_put_u64 (PacketWriter *writer, const u64 value);
+
+CLIENT_EXPORT u8 packet_writer_put_i8 (PacketWriter *writer, const i8 value);
+
+CLIENT_EXPORT u8 packet_writer_put_i16 (PacketWriter *writer, const i16 value);
+
+CLIENT_EXPORT u8 packet_writer_put_i32 (PacketWriter *writer, const i32 value);
+
+CLIENT_EXPORT u8 packet_writer_put_i64 (PacketWriter *writer, const i64 value);
+
+// writes the bytes as they are, without a length prefix
+CLIENT_EXPORT u8 packet_writer_put_bytes (
+	PacketWriter *writer, const void *data, const size_t size
+);
+
+// writes a length prefixed string without its NULL terminator
+// a NULL string is written as an empty one
+CLIENT_EXPORT u8 packet_writer_put_string (
+	PacketWriter *writer, const char *string
+);
+
+// writes a length prefixed blob
+CLIENT_EXPORT u8 packet_writer_put_blob (
+	PacketWriter *writer, const void *data, const u32 size
+);
+
+// generates the packet with all the values that were written
+// returns 0 on success, 1 if any put failed
+CLIENT_EXPORT u8 packet_writer_finish (PacketWriter *writer);
+
+#pragma endregion
+
+#pragma region reader
+
+// reads typed values from a packet's data_ptr up to its data_end
+// every get is bounds checked and fails without moving the data_ptr
+// after a failed get, every other get fails
+struct _PacketReader {
+
+	Packet *packet;
+
+	bool error;
+
+};
+
+typedef struct _PacketReader PacketReader;
+
+// prepares the reader to read the packet's data from its data_ptr
+CLIENT_EXPORT void packet_reader_init (
+	PacketReader *reader, Packet *packet
+);
+
+// returns how many bytes are left to be read
+CLIENT_EXPORT size_t packet_reader_remaining (const PacketReader *reader);
+
+CLIENT_EXPORT u8 packet_reader_get_u8 (PacketReader *reader, u8 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_u16 (PacketReader *reader, u16 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_u32 (PacketReader *reader, u32 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_u64 (PacketReader *reader, u64 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_i8 (PacketReader *reader, i8 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_i16 (PacketReader *reader, i16 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_i32 (PacketReader *reader, i32 *value);
+
+CLIENT_EXPORT u8 packet_reader_get_i64 (PacketReader *reader, i64 *value);
+
+// copies the next size bytes into the buffer
+CLIENT_EXPORT u8 packet_reader_get_bytes (
+	PacketReader *reader, void *buffer, const size_t size
+);
+
+// copies a length prefixed string into the buffer and NULL terminates it
+// fails if the string does not fit in the buffer
+CLIENT_EXPORT u8 packet_reader_get_string (
+	PacketReader *reader, char *buffer, const size_t buffer_size
+);
+
+// gets a reference to a length prefixed blob inside the packet's data
+// the blob is valid as long as the packet's data
+CLIENT_EXPORT u8 packet_reader_get_blob (
+	PacketReader *reader, const void **data, u32 *size
+);
+
+#pragma endregion
+
 #ifdef __cplusplus
 }
 #endif
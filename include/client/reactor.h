@@ -0,0 +1,130 @@
+#ifndef _CLIENT_REACTOR_H_
+#define _CLIENT_REACTOR_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/config.h"
+
+#define REACTOR_DEFAULT_MAX_EVENTS				128
+#define REACTOR_DEFAULT_TIMEOUT					1000
+
+#define REACTOR_DEFAULT_BUFFER_SIZE				65536
+
+#define REACTOR_DEFAULT_N_SLOTS					64
+#define REACTOR_NO_SLOT							((u32) -1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Connection;
+
+struct _Reactor;
+
+// a connection registered to a reactor thread
+// events carry the slot's index & generation instead of the connection
+// so the events of a removed connection are never dispatched
+struct _ReactorSlot {
+
+	struct _Connection *connection;
+	u32 generation;
+
+	u32 next_free;
+
+};
+
+typedef struct _ReactorSlot ReactorSlot;
+
+// an event loop thread with its own epoll instance
+// that handles the sockets of the connections assigned to it
+struct _ReactorThread {
+
+	unsigned int id;
+	pthread_t thread_id;
+
+	int epoll_fd;
+
+	unsigned int n_connections;
+
+	// the registered connections, only used with the mutex held
+	ReactorSlot *slots;
+	u32 n_slots;
+	u32 free_slot;
+
+	// read buffer shared by all the thread's connections
+	char *buffer;
+	size_t buffer_size;
+
+	// set when the connection being handled ends
+	// inside the thread while its events are processed
+	struct _Connection *current;
+	bool current_ended;
+
+	// held while handling the events of a single connection
+	// and while connections are registered & unregistered
+	pthread_mutex_t mutex;
+
+	struct _Reactor *reactor;
+
+};
+
+typedef struct _ReactorThread ReactorThread;
+
+// a set of event loop threads that own the client's connections sockets
+// replaces the dedicated update thread of each connection
+struct _Reactor {
+
+	struct _Client *client;
+
+	bool running;
+
+	unsigned int n_threads;
+	ReactorThread *threads;
+
+	unsigned int next_thread;
+	pthread_mutex_t lock;
+
+};
+
+typedef struct _Reactor Reactor;
+
+// creates a new reactor with n_threads event loop threads
+// if n_threads is 0, one thread per online cpu will be used
+CLIENT_PRIVATE Reactor *reactor_create (
+	struct _Client *client, unsigned int n_threads
+);
+
+CLIENT_PRIVATE void reactor_delete (void *reactor_ptr);
+
+// starts the reactor's event loop threads
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 reactor_start (Reactor *reactor);
+
+// stops the reactor's threads and waits for them to end
+CLIENT_PRIVATE void reactor_stop (Reactor *reactor);
+
+// assigns the connection to the next reactor thread
+// the connection's socket will be read using edge-triggered events
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 reactor_register_connection (
+	Reactor *reactor, struct _Connection *connection
+);
+
+// removes the connection from its reactor thread
+// after this method returns, the connection won't be handled anymore
+// from other threads, it waits until the reactor thread is done
+// handling the connection's current events, including inline handlers
+CLIENT_PRIVATE void reactor_unregister_connection (
+	struct _Connection *connection
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
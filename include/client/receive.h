@@ -1,8 +1,27 @@
 #ifndef _CLIENT_RECEIVE_H_
 #define _CLIENT_RECEIVE_H_
 
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
 #include "client/config.h"
 
+#define RECEIVE_BUFFER_POOL_DEFAULT_SIZE			32
+
+#define RECEIVE_ADAPTIVE_DEFAULT_MIN_SIZE			4096
+#define RECEIVE_ADAPTIVE_DEFAULT_MAX_SIZE			262144
+
+// consecutive reads that filled the buffer before growing it
+#define RECEIVE_ADAPTIVE_GROW_READS					2
+
+// consecutive reads that used less than a quarter
+// of the buffer before shrinking it
+#define RECEIVE_ADAPTIVE_SHRINK_READS				64
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +35,8 @@ struct _Admin;
 
 struct _Lobby;
 
+struct _ReceiveBufferPool;
+
 #define RECEIVE_ERROR_MAP(XX)			\
 	XX(0,	NONE,		None)			\
 	XX(1,	TIMEOUT,	Timeoout)		\
@@ -34,6 +55,78 @@ CLIENT_PUBLIC const char *receive_error_to_string (
 	const ReceiveError error
 );
 
+#pragma region buffers
+
+// a receive buffer that can be shared between many packets
+// packets that are completely inside the buffer reference a slice of it
+// instead of copying their data, and the buffer goes back to its pool
+// when the last reference to it has been released
+struct _ReceiveBuffer {
+
+	struct _ReceiveBufferPool *pool;
+
+	unsigned int refs;
+
+	char *data;
+	size_t size;
+
+	struct _ReceiveBuffer *next;
+
+};
+
+typedef struct _ReceiveBuffer ReceiveBuffer;
+
+// keeps a list of ready to use receive buffers of the same size
+// the pool will only be freed after it has been deleted
+// and all of its buffers have been released
+struct _ReceiveBufferPool {
+
+	size_t buffer_size;
+
+	unsigned int max_buffers;       // max number of idle buffers to keep
+	unsigned int n_buffers;         // current number of idle buffers
+	ReceiveBuffer *buffers;
+
+	unsigned int refs;              // the owner + every buffer in use
+	bool closed;
+
+	pthread_mutex_t mutex;
+
+};
+
+typedef struct _ReceiveBufferPool ReceiveBufferPool;
+
+// creates a new pool of buffers of buffer_size bytes
+// that will keep up to max_buffers idle buffers ready to be used
+CLIENT_PRIVATE ReceiveBufferPool *receive_buffer_pool_create (
+	const size_t buffer_size, const unsigned int max_buffers
+);
+
+// releases the owner's reference to the pool
+// buffers that are still in use will be freed when they are released
+CLIENT_PRIVATE void receive_buffer_pool_delete (
+	ReceiveBufferPool *pool
+);
+
+// gets a buffer from the pool with a single reference to it
+// a new buffer is allocated if the pool is empty
+CLIENT_PRIVATE ReceiveBuffer *receive_buffer_pool_get (
+	ReceiveBufferPool *pool
+);
+
+// adds a new reference to the buffer
+CLIENT_PRIVATE void receive_buffer_ref (
+	ReceiveBuffer *buffer
+);
+
+// releases a reference to the buffer
+// returns the buffer to its pool when no references are left
+CLIENT_PRIVATE void receive_buffer_unref (
+	ReceiveBuffer *buffer
+);
+
+#pragma endregion
+
 #define RECEIVE_TYPE_MAP(XX)			\
 	XX(0,	NONE,		None)			\
 	XX(1,	NORMAL,		Normal)			\
@@ -58,7 +151,8 @@ CLIENT_PUBLIC const char *receive_type_to_string (
 	XX(2,	SPLIT_HEADER, 	Split-Header)		\
 	XX(3,	SPLIT_PACKET, 	Split-Packet)		\
 	XX(4,	COMP_HEADER, 	Complete-Header)	\
-	XX(5,	LOST, 			Lost)
+	XX(5,	LOST, 			Lost)				\
+	XX(6,	STREAM, 		Stream)
 
 typedef enum ReceiveHandleState {
 
@@ -72,6 +166,29 @@ CLIENT_PUBLIC const char *receive_handle_state_to_string (
 	const ReceiveHandleState state
 );
 
+// a packet whose data is delivered to the connection's stream handler
+// in chunks as it arrives instead of being buffered whole
+struct _PacketStream {
+
+	struct _Client *client;
+	struct _Connection *connection;
+
+	PacketHeader header;
+	size_t data_size;               // the packet's total data size
+	size_t delivered;               // data bytes delivered including the current chunk
+
+	// the current chunk, only valid inside the stream handler
+	const char *chunk;
+	size_t chunk_size;
+
+	bool done;                      // set with the packet's last chunk
+
+	void *data;                     // the connection's stream handler data
+
+};
+
+typedef struct _PacketStream PacketStream;
+
 struct _ReceiveHandle {
 
 	ReceiveType type;
@@ -84,6 +201,10 @@ struct _ReceiveHandle {
 	size_t buffer_size;
 	size_t received_size;
 
+	// the refcounted buffer that is being handled
+	// only set when the connection uses zero-copy receives
+	ReceiveBuffer *receive_buffer;
+
 	ReceiveHandleState state;
 
 	// used to handle split headers between buffers
@@ -92,8 +213,23 @@ struct _ReceiveHandle {
 	char *header_end;
 	unsigned int remaining_header;
 
+	// the last bytes of a buffer that were not scanned while lost
+	// as they can be the start of a header split between buffers
+	char resync_tail[sizeof (PacketHeader)];
+	unsigned int resync_tail_size;
+
 	struct _Packet *spare_packet;
 
+	// the packet that is being streamed
+	PacketStream stream;
+
+	// bytes read ahead by client_connection_get_next_packet ()
+	// that have not been handled yet
+	char *read_buffer;
+	size_t read_buffer_size;
+	size_t read_start;
+	size_t read_end;
+
 };
 
 typedef struct _ReceiveHandle ReceiveHandle;
@@ -102,6 +238,48 @@ CLIENT_PRIVATE ReceiveHandle *receive_handle_new (void);
 
 CLIENT_PRIVATE void receive_handle_delete (void *receive_ptr);
 
+#pragma region adaptive
+
+// a receive buffer that grows or shrinks from the observed reads
+// and that waits for large pending packets to be completely available
+struct _ReceiveAdaptive {
+
+	char *buffer;
+	size_t buffer_size;
+
+	size_t min_size;
+	size_t max_size;
+
+	unsigned int full_reads;
+	unsigned int small_reads;
+
+	// the socket's current SO_RCVLOWAT value
+	int low_watermark;
+
+};
+
+typedef struct _ReceiveAdaptive ReceiveAdaptive;
+
+// allocates the initial buffer using the connection's sizes
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 receive_adaptive_init (
+	ReceiveAdaptive *adaptive, struct _Connection *connection
+);
+
+// frees the buffer and resets the socket's low watermark
+CLIENT_PRIVATE void receive_adaptive_end (
+	ReceiveAdaptive *adaptive, struct _Connection *connection
+);
+
+// resizes the buffer after a read of received bytes has been handled
+// and sets the socket's low watermark if a packet is still pending
+CLIENT_PRIVATE void receive_adaptive_update (
+	ReceiveAdaptive *adaptive, struct _Connection *connection,
+	const size_t received
+);
+
+#pragma endregion
+
 #ifdef __cplusplus
 }
 #endif
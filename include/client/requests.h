@@ -0,0 +1,194 @@
+#ifndef _CLIENT_REQUESTS_H_
+#define _CLIENT_REQUESTS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/config.h"
+#include "client/packets.h"
+
+// initial buckets of the pending requests table
+// must be a power of 2
+#define REQUESTS_DEFAULT_N_BUCKETS				64
+
+#define REQUEST_ID_SIZE							sizeof (u32)
+
+// set in the request type of requests & of their responses
+// only packets with it are matched to the pending requests
+#define REQUEST_TYPE_CORRELATED					0x80000000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Connection;
+
+struct _Request;
+struct _Requests;
+
+#define REQUEST_STATE_MAP(XX)																		\
+	XX(0,	NONE,		None,		The request has not been sent)									\
+	XX(1,	PENDING,	Pending,	The request is waiting for its response)						\
+	XX(2,	DONE,		Done,		The request got its response)									\
+	XX(3,	ERROR,		Error,		The request got an app error packet as its response)			\
+	XX(4,	TIMEOUT,	Timeout,	The deadline expired before getting a response)				\
+	XX(5,	CANCELLED,	Cancelled,	The request was cancelled before getting a response)			\
+	XX(6,	FAILED,		Failed,		Failed to send the request)										\
+	XX(7,	ENDED,		Ended,		The connection ended before getting a response)
+
+typedef enum RequestState {
+
+	#define XX(num, name, string, description) REQUEST_STATE_##name = num,
+	REQUEST_STATE_MAP (XX)
+	#undef XX
+
+} RequestState;
+
+CLIENT_PUBLIC const char *request_state_to_string (
+	const RequestState state
+);
+
+CLIENT_PUBLIC const char *request_state_description (
+	const RequestState state
+);
+
+// called once when the request gets completed
+// from the thread that got its response, expired or cancelled it
+typedef void (*RequestCallback) (struct _Request *request, void *args);
+
+// a request that is waiting for its response
+// requests are sent with REQUEST_TYPE_CORRELATED in their request type
+// and their data starts with the request's u32 correlation id
+// in network byte order, the cerver must echo both back in its response
+struct _Request {
+
+	u32 id;
+
+	RequestState state;
+
+	struct _Requests *requests;
+
+	// the response packet, its data_ptr points past the request's id
+	struct _Packet *response;
+
+	// monotonic time in ms, 0 for no deadline
+	u64 deadline;
+
+	RequestCallback callback;
+	void *callback_args;
+
+	// signaled when the request gets completed
+	pthread_cond_t cond;
+
+	// held by the caller that got the request & by the pending table
+	unsigned int references;
+
+	struct _Request *next;
+
+};
+
+typedef struct _Request Request;
+
+// the requests in flight on a connection
+// many requests can be pending at the same time
+// and their responses are matched by their correlation ids
+struct _Requests {
+
+	struct _Connection *connection;
+
+	u32 next_id;
+
+	Request **buckets;
+	size_t n_buckets;
+	size_t n_pending;
+
+	// the earliest deadline of the pending requests, 0 for none
+	u64 next_deadline;
+
+	// expires the requests whose deadline has passed
+	bool timer_running;
+	bool timer_stop;
+	pthread_t timer_thread_id;
+	pthread_cond_t timer_cond;
+
+	pthread_mutex_t mutex;
+
+};
+
+typedef struct _Requests Requests;
+
+CLIENT_PRIVATE Requests *requests_create (struct _Connection *connection);
+
+// stops the deadlines timer & ends every pending request
+CLIENT_PRIVATE void requests_delete (void *requests_ptr);
+
+// completes every pending request with REQUEST_STATE_ENDED
+CLIENT_PRIVATE void requests_end (Requests *requests);
+
+// completes the pending request whose id is at the packet's data_ptr
+// only if the packet's request type has REQUEST_TYPE_CORRELATED
+// returns 0 if the packet was taken as a response, 1 if it was not
+CLIENT_PRIVATE u8 requests_handle_response (
+	Requests *requests, struct _Packet *packet
+);
+
+// sends a request with the data prefixed by a new correlation id
+// and REQUEST_TYPE_CORRELATED added to its request type
+// the request is completed when its response arrives,
+// or when timeout ms pass without one, 0 for no deadline
+// returns the request that should be deleted with request_delete ()
+// returns NULL if the request was not sent
+CLIENT_EXPORT Request *client_request_send (
+	struct _Client *client, struct _Connection *connection,
+	const PacketType packet_type, const u32 request_type,
+	const void *data, const size_t data_size,
+	const u32 timeout
+);
+
+// works as client_request_send () but the callback is called when
+// the request gets completed, and the request is deleted after it returns
+// returns 0 on success, 1 if the request was not sent
+CLIENT_EXPORT u8 client_request_send_callback (
+	struct _Client *client, struct _Connection *connection,
+	const PacketType packet_type, const u32 request_type,
+	const void *data, const size_t data_size,
+	const u32 timeout,
+	RequestCallback callback, void *callback_args
+);
+
+// releases the caller's reference to the request
+// a pending request keeps waiting for its response until it is completed
+CLIENT_EXPORT void request_delete (void *request_ptr);
+
+CLIENT_EXPORT u32 request_get_id (const Request *request);
+
+CLIENT_EXPORT RequestState request_get_state (Request *request);
+
+// returns the response packet that is owned by the request
+CLIENT_EXPORT struct _Packet *request_get_response (const Request *request);
+
+// takes the response packet from the request
+// the packet should be deleted after use
+CLIENT_EXPORT struct _Packet *request_take_response (Request *request);
+
+// waits up to timeout ms for the request to be completed, 0 to wait until it is
+// returns the request's state, REQUEST_STATE_PENDING if it is still waiting
+CLIENT_EXPORT RequestState request_wait (
+	Request *request, const u32 timeout
+);
+
+// completes a pending request with REQUEST_STATE_CANCELLED
+// a response that arrives afterwards is handled as any other packet
+// returns 0 on success, 1 if the request was already completed
+CLIENT_EXPORT u8 request_cancel (Request *request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef _CLIENT_ROUTES_H_
+#define _CLIENT_ROUTES_H_
+
+#include <stdbool.h>
+
+#include "client/types/types.h"
+
+#include "client/config.h"
+#include "client/packets.h"
+
+// request types that can have a route for each packet type
+// packets with bigger request types are handled by the handlers
+#define ROUTES_MAX_REQUEST_TYPES				256
+
+// PACKET_TYPE_APP, PACKET_TYPE_APP_ERROR & PACKET_TYPE_CUSTOM
+#define ROUTES_N_PACKET_TYPES					3
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Handler;
+
+#define ROUTE_MODE_MAP(XX)																					\
+	XX(0,	INLINE,		Inline,		The callback is called by the thread that received the packet)		\
+	XX(1,	QUEUED,		Queued,		The callback is called by a worker of the route handler)
+
+typedef enum RouteMode {
+
+	#define XX(num, name, string, description) ROUTE_MODE_##name = num,
+	ROUTE_MODE_MAP (XX)
+	#undef XX
+
+} RouteMode;
+
+CLIENT_PUBLIC const char *route_mode_to_string (
+	const RouteMode mode
+);
+
+CLIENT_PUBLIC const char *route_mode_description (
+	const RouteMode mode
+);
+
+// the method that handles the packets of a packet type & request type
+// the callback gets a HandlerData like the handlers methods
+// and the packet is deleted after it returns
+struct _Route {
+
+	PacketType packet_type;
+	u32 request_type;
+
+	RouteMode mode;
+
+	Action callback;
+
+	// passed to the callback when it is called inline,
+	// queued callbacks get their worker's data
+	void *data;
+
+	// the handler whose workers call queued callbacks
+	// if NULL, the client's handler for the packet is used
+	struct _Handler *handler;
+
+	// updated by the threads that receive the packets
+	u64 n_packets;
+	u64 n_bytes;
+	u64 n_failed;
+
+};
+
+typedef struct _Route Route;
+
+// sets the data that will be passed to inline callbacks
+CLIENT_EXPORT void route_set_data (Route *route, void *data);
+
+// sets the handler whose workers will call queued callbacks
+// it must be one of the client's handlers
+CLIENT_EXPORT void route_set_handler (
+	Route *route, struct _Handler *handler
+);
+
+CLIENT_PUBLIC void route_print (const Route *route);
+
+// the client's routes indexed by packet type & request type
+struct _Routes {
+
+	unsigned int n_routes;
+
+	Route *table[ROUTES_N_PACKET_TYPES][ROUTES_MAX_REQUEST_TYPES];
+
+};
+
+typedef struct _Routes Routes;
+
+CLIENT_PRIVATE Routes *routes_create (void);
+
+CLIENT_PRIVATE void routes_delete (void *routes_ptr);
+
+// returns the route for the packet type & request type
+// returns NULL if there is none
+CLIENT_PRIVATE Route *routes_get (
+	const Routes *routes,
+	const PacketType packet_type, const u32 request_type
+);
+
+// calls or queues the callback of the packet's route
+// returns 0 if the packet was taken by a route, 1 if it was not
+CLIENT_PRIVATE u8 routes_handle_packet (
+	Routes *routes, struct _Packet *packet
+);
+
+CLIENT_PUBLIC void routes_print (const Routes *routes);
+
+// registers a callback to handle the packets with the packet type & request type
+// instead of the client's handler for their packet type
+// only PACKET_TYPE_APP, PACKET_TYPE_APP_ERROR & PACKET_TYPE_CUSTOM can have routes
+// must be called before the client starts
+// returns the new route, NULL on error
+CLIENT_EXPORT Route *client_route_register (
+	struct _Client *client,
+	const PacketType packet_type, const u32 request_type,
+	Action callback, const RouteMode mode
+);
+
+// returns the client's route for the packet type & request type
+// returns NULL if there is none
+CLIENT_EXPORT Route *client_route_get (
+	struct _Client *client,
+	const PacketType packet_type, const u32 request_type
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
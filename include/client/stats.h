@@ -0,0 +1,153 @@
+#ifndef _CLIENT_STATS_H_
+#define _CLIENT_STATS_H_
+
+#include <stddef.h>
+
+#include "client/types/types.h"
+
+#include "client/config.h"
+#include "client/packets.h"
+
+#define STATS_CACHE_LINE_SIZE				64
+
+// the client's counters are split in shards
+// that are updated by different threads
+#define STATS_N_SHARDS						8
+
+// packets sizes are counted in power of 2 buckets
+// the first bucket holds packets up to 64 bytes
+// and the last one every packet bigger than 1 MB
+#define STATS_SIZES_BUCKETS					16
+#define STATS_SIZES_MIN_SHIFT				6
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Connection;
+
+// the packets of one direction indexed by packet type
+// unknown packet types are counted as PACKET_TYPE_BAD
+struct _PacketsStats {
+
+	u64 packets[PACKETS_MAX_TYPES];
+	u64 bytes[PACKETS_MAX_TYPES];
+
+	u64 sizes[PACKETS_MAX_TYPES][STATS_SIZES_BUCKETS];
+
+};
+
+typedef struct _PacketsStats PacketsStats;
+
+// counters that are only updated with atomic operations
+// every block takes whole cache lines so readers & senders
+// don't write to the same lines
+struct _StatsShard {
+
+	u64 n_receives_done;                    // n calls to recv ()
+	u64 total_bytes_received;
+	u64 n_send_failed;                      // packets that failed to be sent
+	char pad_0[STATS_CACHE_LINE_SIZE - (3 * sizeof (u64))];
+
+	PacketsStats received;
+	PacketsStats sent;
+
+	u64 shed[PACKETS_MAX_TYPES];            // dropped by the handlers queues policies
+
+};
+
+typedef struct _StatsShard StatsShard;
+
+// allocates cache line aligned shards
+CLIENT_PRIVATE StatsShard *stats_shards_create (const unsigned int n_shards);
+
+CLIENT_PRIVATE void stats_shards_delete (void *shards_ptr);
+
+// returns the client's shard that is updated by the calling thread
+CLIENT_PRIVATE StatsShard *stats_shard_get (StatsShard *shards);
+
+// counts a call to recv () in the client & connection stats
+CLIENT_PRIVATE void stats_count_receive (
+	struct _Client *client, struct _Connection *connection,
+	const size_t received
+);
+
+// counts a received packet in the client & connection stats
+CLIENT_PRIVATE void stats_count_received (
+	struct _Client *client, struct _Connection *connection,
+	const PacketType packet_type, const size_t packet_size
+);
+
+// counts a sent packet in the client & connection stats
+CLIENT_PRIVATE void stats_count_sent (
+	struct _Client *client, struct _Connection *connection,
+	const PacketType packet_type, const size_t sent
+);
+
+// counts a packet that failed to be sent in the client & connection stats
+CLIENT_PRIVATE void stats_count_send_failed (
+	struct _Client *client, struct _Connection *connection
+);
+
+// counts a packet dropped by a handler in the client & connection stats
+CLIENT_PRIVATE void stats_count_shed (
+	struct _Client *client, struct _Connection *connection,
+	const PacketType packet_type
+);
+
+// returns the sizes bucket of a packet of size bytes
+CLIENT_PUBLIC unsigned int stats_size_bucket (const size_t size);
+
+// returns the biggest packet size that is counted in the bucket
+CLIENT_PUBLIC size_t stats_size_bucket_limit (const unsigned int bucket);
+
+// the merged values of a group of shards
+// the totals are the sums of the packets types values
+struct _StatsSnapshot {
+
+	u64 n_receives_done;
+	u64 total_bytes_received;               // bytes returned by recv ()
+
+	u64 n_packets_received;
+	u64 n_packets_sent;
+	u64 n_packets_shed;
+	u64 n_send_failed;
+
+	u64 total_bytes_sent;
+
+	PacketsStats received;
+	PacketsStats sent;
+
+	u64 shed[PACKETS_MAX_TYPES];
+
+};
+
+typedef struct _StatsSnapshot StatsSnapshot;
+
+// merges the shards values into the snapshot
+CLIENT_PRIVATE void stats_shards_snapshot (
+	const StatsShard *shards, const unsigned int n_shards,
+	StatsSnapshot *snapshot
+);
+
+// gets the sum of the stats of every client's shard
+CLIENT_EXPORT void client_stats_get (
+	const struct _Client *client, StatsSnapshot *snapshot
+);
+
+// gets the packets stats of the connection
+CLIENT_EXPORT void connection_stats_get (
+	const struct _Connection *connection, StatsSnapshot *snapshot
+);
+
+CLIENT_PUBLIC void stats_snapshot_print (const StatsSnapshot *snapshot);
+
+// prints the sizes of the packets of each type that has packets
+CLIENT_PUBLIC void packets_stats_sizes_print (const PacketsStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "client/collections/dlist.h"
 #include "client/collections/pool.h"
+#include "client/collections/ring.h"
 
 #include "client/config.h"
 
@@ -109,6 +110,10 @@ struct _JobQueue {
 
 	DoubleList *queue;
 
+	// when set, jobs are stored inline in the ring's slots
+	// instead of being allocated & linked in the queue
+	Ring *ring;
+
 	pthread_mutex_t *rwmutex;		// used for queue r/w access
 	bsem *has_jobs;
 
@@ -136,6 +141,15 @@ CLIENT_PUBLIC void job_queue_set_handler (
 	JobQueue *queue, void (*handler) (void *data)
 );
 
+// replaces the queue's list with a bounded ring of jobs
+// must be called while the queue is still empty
+// pushes fail when the ring is full & requests by id are not supported
+// returns 0 on success, 1 on error
+CLIENT_PUBLIC unsigned int job_queue_set_ring (
+	JobQueue *job_queue,
+	const RingType type, const size_t capacity
+);
+
 // adds a new job to the queue
 // returns 0 on success, 1 on error
 CLIENT_PUBLIC unsigned int job_queue_push (
@@ -165,8 +179,28 @@ CLIENT_PUBLIC unsigned int job_queue_push_handler (
 );
 
 // get the job at the start of the queue
+// a ring returns the args of the job, that are the pushed pointer
 CLIENT_PUBLIC void *job_queue_pull (JobQueue *job_queue);
 
+// copies the job at the start of the queue into job
+// works with jobs pushed using job_queue_push_job ()
+// returns 0 on success, 1 if the queue is empty
+CLIENT_PUBLIC unsigned int job_queue_pull_job (
+	JobQueue *job_queue, Job *job
+);
+
+// copies up to max jobs from the start of the queue into jobs
+// returns the number of jobs that were copied
+CLIENT_PUBLIC unsigned int job_queue_pull_jobs (
+	JobQueue *job_queue, Job *jobs, const unsigned int max
+);
+
+// gets up to max jobs from the start of the queue
+// returns the number of jobs that were placed in jobs
+CLIENT_PUBLIC unsigned int job_queue_pull_many (
+	JobQueue *job_queue, void **jobs, const unsigned int max
+);
+
 // requests to get an specific job from the queue by matching id
 // blocks and waits until the requested job is available
 CLIENT_PUBLIC void *job_queue_request (
@@ -177,6 +211,9 @@ CLIENT_PUBLIC unsigned int job_queue_start (JobQueue *job_queue);
 
 CLIENT_PUBLIC unsigned int job_queue_stop (JobQueue *job_queue);
 
+// returns how many jobs are waiting in the queue
+CLIENT_PUBLIC size_t job_queue_size (JobQueue *job_queue);
+
 // clears the job queue -> destroys all jobs
 CLIENT_PUBLIC void job_queue_clear (JobQueue *job_queue);
 
@@ -0,0 +1,224 @@
+#ifndef _CLIENT_URING_H_
+#define _CLIENT_URING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/config.h"
+
+#define URING_DEFAULT_ENTRIES				256
+
+// provided receive buffers registered for each connection
+// must be a power of 2
+#define URING_DEFAULT_N_BUFFERS				64
+
+// buffer group ids available for the connections' provided buffer rings
+#define URING_MAX_GROUPS					65536
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Connection;
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+struct _Uring;
+
+// the receive state of a connection handled by an io_uring
+// it outlives its connection until its multishot receive has ended
+struct _UringConnection {
+
+	struct _Uring *uring;
+
+	// set to NULL when the connection is removed
+	struct _Connection *connection;
+	int sock_fd;
+
+	bool multishot;
+	bool armed;
+	bool failed;
+	bool closed;
+
+	// provided buffers ring used by the kernel to place received data
+	// its group id belongs to the connection until its state is deleted
+	bool has_group;
+	u16 group;
+	struct io_uring_buf_ring *buf_ring;
+	size_t buf_ring_size;
+
+	char *buffers;
+	size_t buffer_size;
+	unsigned int n_buffers;
+
+	struct _UringConnection *next_closed;
+
+};
+
+typedef struct _UringConnection UringConnection;
+
+#define URING_REQUEST_TYPE_MAP(XX)					\
+	XX(0,	SEND,		Send)						\
+	XX(1,	ADD,		Add)						\
+	XX(2,	REMOVE,		Remove)
+
+typedef enum UringRequestType {
+
+	#define XX(num, name, string) URING_REQUEST_TYPE_##name = num,
+	URING_REQUEST_TYPE_MAP (XX)
+	#undef XX
+
+} UringRequestType;
+
+// a request from another thread to be handled by the ring's thread
+// the requesting thread waits until it has been completed
+// except for the async sends made from the ring's own thread
+struct _UringRequest {
+
+	UringRequestType type;
+
+	UringConnection *uring_connection;
+
+	// the connection of a send, set to NULL when it is removed
+	struct _Connection *connection;
+
+	int sock_fd;
+	const char *data;
+	size_t size;
+	size_t sent;
+	int flags;
+
+	// the data is a copy owned by the request
+	// that is released by the ring's thread when it is done
+	bool async;
+
+	int result;
+	bool done;
+	pthread_cond_t cond;
+
+	struct _UringRequest *next;
+
+	// the connection's next send, only used by the ring's thread
+	struct _UringRequest *next_send;
+
+};
+
+typedef struct _UringRequest UringRequest;
+
+// an io_uring instance with a dedicated thread
+// that handles the receives and sends of the client's connections
+struct _Uring {
+
+	struct _Client *client;
+
+	int ring_fd;
+	unsigned int entries;
+
+	void *ring_ptr;
+	size_t ring_size;
+
+	// submission queue
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_array;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	unsigned int to_submit;
+
+	// completion queue
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+
+	// operations that will still generate completions
+	unsigned int n_inflight;
+
+	// wakes up the ring's thread when it is waiting for completions
+	int event_fd;
+	u64 event_value;
+	bool sleeping;
+
+	bool running;
+	bool alive;
+	bool stopping;
+	pthread_t thread_id;
+
+	// the buffer group ids in use, one bit for each id
+	u64 groups[URING_MAX_GROUPS / 64];
+	u16 next_group;
+
+	UringRequest *requests;
+	UringRequest *requests_tail;
+
+	UringConnection *closed;
+
+	pthread_mutex_t lock;
+
+};
+
+typedef struct _Uring Uring;
+
+#define URING_SEND_RESULT_MAP(XX)								\
+	XX(0,	OK,				Ok)									\
+	XX(1,	ERROR,			Error)								\
+	XX(2,	UNAVAILABLE,	Unavailable)
+
+typedef enum UringSendResult {
+
+	#define XX(num, name, string) URING_SEND_RESULT_##name = num,
+	URING_SEND_RESULT_MAP (XX)
+	#undef XX
+
+} UringSendResult;
+
+// creates a new io_uring for the client
+// returns NULL if the running kernel lacks the required io_uring support
+CLIENT_PRIVATE Uring *uring_create (struct _Client *client);
+
+CLIENT_PRIVATE void uring_delete (void *uring_ptr);
+
+// starts the ring's thread
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 uring_start (Uring *uring);
+
+// cancels any pending operation and waits for the ring's thread to end
+CLIENT_PRIVATE void uring_stop (Uring *uring);
+
+// registers a provided buffers ring for the connection
+// and starts a multishot receive on its socket
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 uring_register_connection (
+	Uring *uring, struct _Connection *connection
+);
+
+// stops receiving from the connection's socket
+// after this method returns, the connection won't be handled anymore
+CLIENT_PRIVATE void uring_unregister_connection (
+	struct _Connection *connection
+);
+
+// sends right away the data that fits in the connection's socket
+// the rest is sent through its ring while the caller waits
+// the write mutex held by the caller (if any) is released while waiting,
+// and sends from the ring's own thread are copied & never wait
+// returns URING_SEND_RESULT_UNAVAILABLE if the caller must send by itself
+CLIENT_PRIVATE UringSendResult uring_send (
+	struct _Connection *connection,
+	const char *data, size_t data_size, int flags,
+	pthread_mutex_t *write_mutex, size_t *total_sent
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -185,7 +185,7 @@ static void cerver_check_info_handle_auth (
 				if (connection->auth_packet) {
 					packet_set_network_values (connection->auth_packet, NULL, connection);
 
-					if (!packet_send (connection->auth_packet, 0, NULL, false)) {
+					if (!connection_send_control_packet (connection, connection->auth_packet, false)) {
 						client_log_success (
 							"cerver_check_info () - Sent connection %s auth packet!",
 							connection->name
@@ -21,7 +21,11 @@
 #include "client/handler.h"
 #include "client/network.h"
 #include "client/packets.h"
+#include "client/reactor.h"
 #include "client/receive.h"
+#include "client/routes.h"
+#include "client/stats.h"
+#include "client/uring.h"
 
 #include "client/threads/thread.h"
 
@@ -51,6 +55,8 @@ void client_init (void) {
 // should be called only once at the very end of the program
 void client_end (void) {
 
+	packets_pool_clear ();
+
 	client_log_end ();
 
 }
@@ -85,8 +91,7 @@ static ClientStats *client_stats_new (void) {
 	ClientStats *client_stats = (ClientStats *) malloc (sizeof (ClientStats));
 	if (client_stats) {
 		(void) memset (client_stats, 0, sizeof (ClientStats));
-		client_stats->received_packets = packets_per_type_new ();
-		client_stats->sent_packets = packets_per_type_new ();
+		client_stats->shards = stats_shards_create (STATS_N_SHARDS);
 	}
 
 	return client_stats;
@@ -96,8 +101,7 @@ static ClientStats *client_stats_new (void) {
 static inline void client_stats_delete (ClientStats *client_stats) {
 
 	if (client_stats) {
-		packets_per_type_delete (client_stats->received_packets);
-		packets_per_type_delete (client_stats->sent_packets);
+		stats_shards_delete (client_stats->shards);
 
 		free (client_stats);
 	}
@@ -111,19 +115,14 @@ void client_stats_print (Client *client) {
 			client_log_msg ("\nClient's stats:\n");
 			client_log_msg ("Threshold time:            %ld", client->stats->threshold_time);
 
-			client_log_msg ("N receives done:           %ld", client->stats->n_receives_done);
-
-			client_log_msg ("Total bytes received:      %ld", client->stats->total_bytes_received);
-			client_log_msg ("Total bytes sent:          %ld", client->stats->total_bytes_sent);
-
-			client_log_msg ("N packets received:        %ld", client->stats->n_packets_received);
-			client_log_msg ("N packets sent:            %ld", client->stats->n_packets_sent);
+			StatsSnapshot snapshot = { 0 };
+			client_stats_get (client, &snapshot);
+			stats_snapshot_print (&snapshot);
 
-			client_log_msg ("\nReceived packets:");
-			packets_per_type_print (client->stats->received_packets);
-
-			client_log_msg ("\nSent packets:");
-			packets_per_type_print (client->stats->sent_packets);
+			if (client->routes) {
+				client_log_msg ("\nRoutes:");
+				routes_print (client->routes);
+			}
 		}
 
 		else {
@@ -239,9 +238,24 @@ Client *client_new (void) {
 		client->app_packet_handler = NULL;
 		client->app_error_packet_handler = NULL;
 		client->custom_packet_handler = NULL;
+		client->game_packet_handler = NULL;
+
+		client->multiple_app_handlers = false;
+		client->n_app_packet_handlers = 0;
+		for (unsigned int i = 0; i < CLIENT_MAX_APP_HANDLERS; i++)
+			client->app_packet_handlers[i] = NULL;
+
+		client->routes = NULL;
 
 		client->check_packets = false;
 
+		client->use_reactor = false;
+		client->reactor_threads = 0;
+		client->reactor = NULL;
+
+		client->use_uring = false;
+		client->uring = NULL;
+
 		client->lock = NULL;
 
 		for (unsigned int i = 0; i < CLIENT_MAX_EVENTS; i++)
@@ -291,6 +305,16 @@ void client_delete (void *ptr) {
 		handler_delete (client->app_packet_handler);
 		handler_delete (client->app_error_packet_handler);
 		handler_delete (client->custom_packet_handler);
+		handler_delete (client->game_packet_handler);
+
+		for (unsigned int i = 0; i < CLIENT_MAX_APP_HANDLERS; i++)
+			handler_delete (client->app_packet_handlers[i]);
+
+		routes_delete (client->routes);
+
+		reactor_delete (client->reactor);
+
+		uring_delete (client->uring);
 
 		if (client->lock) {
 			pthread_mutex_destroy (client->lock);
@@ -463,6 +487,95 @@ void client_set_custom_handler (
 
 }
 
+// sets a PACKET_TYPE_GAME packet type handler
+// game packets are discarded if the client does not have one
+void client_set_game_handler (
+	Client *client, Handler *game_handler
+) {
+
+	if (client) {
+		client->game_packet_handler = game_handler;
+		if (client->game_packet_handler) {
+			client->game_packet_handler->type = HANDLER_TYPE_CLIENT;
+			client->game_packet_handler->client = client;
+		}
+	}
+
+}
+
+// sets whether PACKET_TYPE_APP packets will be handled by the handler
+// registered with the same id as the packet header's handler id
+// packets without a matching handler go to the app_packet_handler
+void client_set_multiple_app_handlers (
+	Client *client, bool multiple_app_handlers
+) {
+
+	if (client) {
+		client->multiple_app_handlers = multiple_app_handlers;
+	}
+
+}
+
+// registers a handler created with handler_create_with_id ()
+// to handle the app packets with the same handler id
+// must be called before the client starts
+// returns 0 on success, 1 on error
+u8 client_app_handlers_register (Client *client, Handler *handler) {
+
+	u8 retval = 1;
+
+	if (client && handler) {
+		if ((handler->id >= 0) && (handler->id < CLIENT_MAX_APP_HANDLERS)) {
+			if (
+				!client->app_packet_handlers[handler->id]
+				&& (handler != client->app_packet_handler)
+			) {
+				handler->type = HANDLER_TYPE_CLIENT;
+				handler->client = client;
+
+				client->app_packet_handlers[handler->id] = handler;
+				client->n_app_packet_handlers += 1;
+
+				retval = 0;
+			}
+
+			else {
+				client_log_error (
+					"Client %s already has an app handler with id %d!",
+					client->name, handler->id
+				);
+			}
+		}
+
+		else {
+			client_log_error (
+				"Client %s app handler id %d is out of range!",
+				client->name, handler->id
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+// returns the handler that will handle app packets with the handler id
+// returns NULL if there is none
+Handler *client_app_handlers_get (Client *client, const u8 handler_id) {
+
+	Handler *handler = NULL;
+
+	if (client) {
+		if (client->multiple_app_handlers)
+			handler = client->app_packet_handlers[handler_id];
+
+		if (!handler) handler = client->app_packet_handler;
+	}
+
+	return handler;
+
+}
+
 // set whether to check or not incoming packets
 // check packet's header protocol id & version compatibility
 // if packets do not pass the checks, won't be handled and will be inmediately destroyed
@@ -478,6 +591,30 @@ void client_set_check_packets (
 
 }
 
+// sets whether the client's connections will be handled by a reactor
+// instead of creating an update thread for each connection (default false)
+// if n_threads is 0, one thread per online cpu will be used
+void client_set_reactor (
+	Client *client, bool use_reactor, unsigned int n_threads
+) {
+
+	if (client) {
+		client->use_reactor = use_reactor;
+		client->reactor_threads = n_threads;
+	}
+
+}
+
+// sets whether the client's connections will be handled by an io_uring (default false)
+// if the kernel lacks io_uring support, the reactor or update threads will be used
+void client_set_uring (Client *client, bool use_uring) {
+
+	if (client) {
+		client->use_uring = use_uring;
+	}
+
+}
+
 // compare clients based on their client ids
 int client_comparator_client_id (
 	const void *a, const void *b
@@ -699,6 +836,74 @@ static u8 client_custom_handler_start (Client *client) {
 
 }
 
+// the game handler is optional
+static u8 client_game_handler_start (Client *client) {
+
+	u8 retval = 0;
+
+	if (client) {
+		if (client->game_packet_handler) {
+			if (!client->game_packet_handler->direct_handle) {
+				if (!handler_start (client->game_packet_handler)) {
+					#ifdef CLIENT_DEBUG
+					client_log_success (
+						"Client %s game_packet_handler has started!",
+						client->name
+					);
+					#endif
+				}
+
+				else {
+					client_log_error (
+						"Failed to start client %s game_packet_handler!",
+						client->name
+					);
+
+					retval = 1;
+				}
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+// starts the handlers registered for each app packets handler id
+static u8 client_app_handlers_start (Client *client) {
+
+	u8 retval = 0;
+
+	if (client) {
+		Handler *handler = NULL;
+		for (unsigned int i = 0; i < CLIENT_MAX_APP_HANDLERS; i++) {
+			handler = client->app_packet_handlers[i];
+			if (handler && !handler->direct_handle) {
+				if (!handler_start (handler)) {
+					#ifdef CLIENT_DEBUG
+					client_log_success (
+						"Client %s app handler %u has started!",
+						client->name, i
+					);
+					#endif
+				}
+
+				else {
+					client_log_error (
+						"Failed to start client %s app handler %u!",
+						client->name, i
+					);
+
+					retval = 1;
+				}
+			}
+		}
+	}
+
+	return retval;
+
+}
+
 // starts all client's handlers
 static u8 client_handlers_start (Client *client) {
 
@@ -716,10 +921,14 @@ static u8 client_handlers_start (Client *client) {
 
 		errors |= client_app_handler_start (client);
 
+		errors |= client_app_handlers_start (client);
+
 		errors |= client_app_error_handler_start (client);
 
 		errors |= client_custom_handler_start (client);
 
+		errors |= client_game_handler_start (client);
+
 		if (!errors) {
 			#ifdef CLIENT_DEBUG
 			client_log_success (
@@ -733,6 +942,46 @@ static u8 client_handlers_start (Client *client) {
 
 }
 
+static u8 client_reactor_start (Client *client) {
+
+	u8 retval = 1;
+
+	client->reactor = reactor_create (client, client->reactor_threads);
+	if (client->reactor) {
+		if (!reactor_start (client->reactor)) {
+			retval = 0;
+		}
+
+		else {
+			reactor_delete (client->reactor);
+			client->reactor = NULL;
+		}
+	}
+
+	return retval;
+
+}
+
+static u8 client_uring_start (Client *client) {
+
+	u8 retval = 1;
+
+	client->uring = uring_create (client);
+	if (client->uring) {
+		if (!uring_start (client->uring)) {
+			retval = 0;
+		}
+
+		else {
+			uring_delete (client->uring);
+			client->uring = NULL;
+		}
+	}
+
+	return retval;
+
+}
+
 static u8 client_start (Client *client) {
 
 	u8 retval = 1;
@@ -744,6 +993,27 @@ static u8 client_start (Client *client) {
 			client->running = true;
 
 			if (!client_handlers_start (client)) {
+				if (client->use_uring && !client->uring) {
+					if (client_uring_start (client)) {
+						client_log_warning (
+							"client_start () - "
+							"Failed to start client %s io_uring, using fallback",
+							client->name
+						);
+					}
+				}
+
+				if (client->use_reactor && !client->reactor) {
+					if (client_reactor_start (client)) {
+						client_log_error (
+							"client_start () - "
+							"Failed to start client %s reactor, "
+							"connections will use update threads",
+							client->name
+						);
+					}
+				}
+
 				retval = 0;
 			}
 
@@ -825,30 +1095,171 @@ int client_connection_unregister (
 
 }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-parameter"
+// makes sure that at least min bytes have been read ahead
+// connections with a custom receive never read past the requested bytes
+// returns 0 on success, 1 on error
+static u8 client_connection_read_ahead (
+	Client *client, Connection *connection, const size_t min
+) {
+
+	ReceiveHandle *receive_handle = &connection->receive_handle;
+
+	ReceiveError error = RECEIVE_ERROR_NONE;
+	size_t received = 0;
+	size_t to_read = 0;
+
+	if ((receive_handle->read_end - receive_handle->read_start) < min) {
+		// move the unread bytes to the start of the buffer
+		if (receive_handle->read_start) {
+			(void) memmove (
+				receive_handle->read_buffer,
+				receive_handle->read_buffer + receive_handle->read_start,
+				receive_handle->read_end - receive_handle->read_start
+			);
+
+			receive_handle->read_end -= receive_handle->read_start;
+			receive_handle->read_start = 0;
+		}
+
+		while (receive_handle->read_end < min) {
+			to_read = connection->custom_receive ?
+				(min - receive_handle->read_end) :
+				(receive_handle->read_buffer_size - receive_handle->read_end);
+
+			error = client_receive_actual (
+				client, connection,
+				receive_handle->read_buffer + receive_handle->read_end, to_read,
+				&received
+			);
 
-static inline void client_connection_get_next_packet_handler (
-	const size_t received,
+			if (error == RECEIVE_ERROR_NONE) {
+				receive_handle->read_end += received;
+
+				stats_count_receive (client, connection, received);
+			}
+
+			// we are still waiting to get more data
+			else if (error != RECEIVE_ERROR_TIMEOUT) {
+				break;
+			}
+		}
+	}
+
+	return (receive_handle->read_end - receive_handle->read_start) < min;
+
+}
+
+// receives the packet's data in chunks of the connection's read buffer size
+// and delivers them to the connection's stream handler
+static unsigned int client_connection_get_next_packet_stream (
 	Client *client, Connection *connection,
-	Packet *packet
+	const PacketHeader *header
 ) {
 
-	// update stats
-	client->stats->n_receives_done += 1;
-	client->stats->total_bytes_received += received;
+	unsigned int retval = 1;
+
+	ReceiveHandle *receive_handle = &connection->receive_handle;
 
-	#ifdef CONNECTION_STATS
-	connection->stats->n_receives_done += 1;
-	connection->stats->total_bytes_received += received;
-	#endif
+	PacketStream stream = {
+		.client = client,
+		.connection = connection,
 
-	// handle the actual packet
-	(void) client_packet_handler (packet);
+		.header = *header,
+		.data_size = header->packet_size - sizeof (PacketHeader),
+		.delivered = 0,
+
+		.chunk = NULL,
+		.chunk_size = 0,
+
+		.done = false,
+
+		.data = connection->stream_handler_data
+	};
+
+	size_t chunk_size = 0;
+	while (stream.delivered < stream.data_size) {
+		// first deliver what has been read ahead
+		if (receive_handle->read_end == receive_handle->read_start) {
+			chunk_size = stream.data_size - stream.delivered;
+			if (chunk_size > receive_handle->read_buffer_size)
+				chunk_size = receive_handle->read_buffer_size;
+
+			if (client_connection_read_ahead (client, connection, chunk_size)) break;
+		}
+
+		chunk_size = receive_handle->read_end - receive_handle->read_start;
+		if (chunk_size > (stream.data_size - stream.delivered))
+			chunk_size = stream.data_size - stream.delivered;
+
+		stream.chunk = receive_handle->read_buffer + receive_handle->read_start;
+		stream.chunk_size = chunk_size;
+		stream.delivered += chunk_size;
+		stream.done = (stream.delivered == stream.data_size);
+
+		receive_handle->read_start += chunk_size;
+
+		connection->stream_handler (&stream);
+	}
+
+	if (stream.done) {
+		stats_count_received (
+			client, connection,
+			stream.header.packet_type, stream.header.packet_size
+		);
+
+		retval = 0;
+	}
+
+	return retval;
 
 }
 
-#pragma GCC diagnostic pop
+// reads the packet's data from the bytes that have been read ahead
+// and receives the rest directly into the packet
+// returns 0 on success, 1 on error
+static u8 client_connection_get_next_packet_data (
+	Client *client, Connection *connection,
+	Packet *packet
+) {
+
+	u8 retval = 1;
+
+	ReceiveHandle *receive_handle = &connection->receive_handle;
+
+	if (!packet_create_data (packet, packet->packet_size - sizeof (PacketHeader))) {
+		size_t available = receive_handle->read_end - receive_handle->read_start;
+		if (available > packet->data_size) available = packet->data_size;
+
+		(void) memcpy (
+			packet->data,
+			receive_handle->read_buffer + receive_handle->read_start,
+			available
+		);
+
+		receive_handle->read_start += available;
+
+		if (available < packet->data_size) {
+			if (
+				client_receive_data (
+					client, connection,
+					(char *) packet->data + available, packet->data_size - available,
+					packet->data_size - available
+				) == RECEIVE_ERROR_NONE
+			) {
+				stats_count_receive (client, connection, packet->data_size - available);
+
+				retval = 0;
+			}
+		}
+
+		else {
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
 
 static unsigned int client_connection_get_next_packet_actual (
 	Client *client, Connection *connection
@@ -856,70 +1267,77 @@ static unsigned int client_connection_get_next_packet_actual (
 
 	unsigned int retval = 1;
 
-	// TODO: use a static packet
-	Packet *packet = packet_new ();
-	packet->client = client;
-	packet->connection = connection;
+	ReceiveHandle *receive_handle = &connection->receive_handle;
 
-	// first receive the packet header
-	size_t data_size = sizeof (PacketHeader);
+	// the read ahead buffer is kept between calls
+	if (!receive_handle->read_buffer) {
+		receive_handle->read_buffer_size = (
+			connection->receive_packet_buffer_size > sizeof (PacketHeader)
+		) ? connection->receive_packet_buffer_size : CONNECTION_DEFAULT_RECEIVE_BUFFER_SIZE;
 
+		receive_handle->read_buffer = (char *) malloc (receive_handle->read_buffer_size);
+		receive_handle->read_start = 0;
+		receive_handle->read_end = 0;
+	}
+
+	// first get the packet header
 	if (
-		client_receive_data (
-			client, connection,
-			(char *) &packet->header, sizeof (PacketHeader),
-			data_size
-		) == RECEIVE_ERROR_NONE
+		receive_handle->read_buffer
+		&& !client_connection_read_ahead (client, connection, sizeof (PacketHeader))
 	) {
+		PacketHeader header = { 0 };
+		(void) memcpy (
+			&header,
+			receive_handle->read_buffer + receive_handle->read_start,
+			sizeof (PacketHeader)
+		);
+
+		receive_handle->read_start += sizeof (PacketHeader);
+
 		#ifdef CLIENT_RECEIVE_DEBUG
-		packet_header_log (&packet->header);
+		packet_header_log (&header);
 		#endif
 
-		// check if need more data to complete the packet
-		if (packet->header.packet_size > sizeof (PacketHeader)) {
-			// TODO: add ability to configure this value
-			// check that the packet is not to big
-			if (packet->header.packet_size <= MAX_UDP_PACKET_SIZE) {
-				(void) packet_create_data (
-					packet, packet->header.packet_size - sizeof (PacketHeader)
-				);
+		// check that the packet is not to big
+		// streamed packets can be bigger than the max packet size
+		if (!connection_packet_size_is_valid (connection, header.packet_size)) {
+			// we received a bad packet
+			// so we can't trust any of the bytes that were read ahead
+			receive_handle->read_start = 0;
+			receive_handle->read_end = 0;
+		}
+
+		else if (connection_packet_is_streamed (connection, header.packet_size)) {
+			retval = client_connection_get_next_packet_stream (
+				client, connection, &header
+			);
+		}
+
+		else {
+			Packet *packet = packet_new ();
+			if (packet) {
+				packet->client = client;
+				packet->connection = connection;
 
-				data_size = packet->data_size;
+				(void) memcpy (&packet->header, &header, sizeof (PacketHeader));
+				packet->packet_size = header.packet_size;
 
+				// check if need more data to complete the packet
 				if (
-					client_receive_data (
-						client, connection,
-						packet->data, packet->data_size,
-						data_size
-					) == RECEIVE_ERROR_NONE
+					(packet->packet_size == sizeof (PacketHeader))
+					|| !client_connection_get_next_packet_data (client, connection, packet)
 				) {
 					// we can safely handle the packet
-					client_connection_get_next_packet_handler (
-						packet->packet_size,
-						client, connection,
-						packet
-					);
+					(void) client_packet_handler (packet);
 
 					retval = 0;
 				}
-			}
 
-			else {
-				// we received a bad packet
-				packet_delete (packet);
+				else {
+					packet_delete (packet);
+				}
 			}
 		}
-
-		else {
-			// we can safely handle the packet
-			client_connection_get_next_packet_handler (
-				packet->packet_size,
-				client, connection,
-				packet
-			);
-
-			retval = 0;
-		}
 	}
 
 	return retval;
@@ -928,6 +1346,7 @@ static unsigned int client_connection_get_next_packet_actual (
 
 // performs a receive in the connection's socket
 // to get a complete packet & handle it
+// fails if the connection is already being updated by another thread
 // returns 0 on success, 1 on error
 unsigned int client_connection_get_next_packet (
 	Client *client, Connection *connection
@@ -935,7 +1354,8 @@ unsigned int client_connection_get_next_packet (
 
 	unsigned int retval = 1;
 
-	if (client && connection) {
+	// the update thread owns the socket & the bytes that were read ahead
+	if (client && connection && !connection->updating) {
 		retval = client_connection_get_next_packet_actual (
 			client, connection
 		);
@@ -1071,21 +1491,31 @@ static int connection_start_update (
 
 	int retval = 1;
 
-	if (!thread_create_detachable (
+	ClientConnection *cc = client_connection_aux_new (client, connection);
+	if (cc) {
+		// the socket belongs to the update thread from now on
+		// so client_connection_get_next_packet () can't read from it
+		connection->updating = true;
+
+		if (!thread_create_detachable (
 			&connection->update_thread_id,
 			connection_update,
-			client_connection_aux_new (client, connection)
+			cc
 		)) {
 			retval = 0;
 		}
 
 		else {
+			connection->updating = false;
+			client_connection_aux_delete (cc);
+
 			client_log_error (
 				"client_connection_start () - "
 				"Failed to create update thread for connection %s",
 				connection->name
 			);
 		}
+	}
 
 	return retval;
 
@@ -1097,6 +1527,9 @@ static int connection_start_send (
 
 	int retval = 1;
 
+	connection->send_queue_client = client;
+	connection->send_failed = false;
+
 	if (!thread_create_detachable (
 			&connection->send_thread_id,
 			connection_send_thread,
@@ -1132,7 +1565,18 @@ int client_connection_start (
 			if (!client_start (client)) {
 				int errors = 0;
 
-				errors |= connection_start_update (client, connection);
+				// connections with a custom receive method still use their own thread
+				if (client->uring && !connection->custom_receive) {
+					errors |= uring_register_connection (client->uring, connection);
+				}
+
+				else if (client->reactor && !connection->custom_receive) {
+					errors |= reactor_register_connection (client->reactor, connection);
+				}
+
+				else {
+					errors |= connection_start_update (client, connection);
+				}
 
 				if (connection->use_send_queue) {
 					errors |= connection_start_send (client, connection);
@@ -1555,8 +1999,9 @@ static void client_connection_terminate (
 				);
 
 				if (packet) {
+					// sent before any queued packet & before the socket is closed
 					packet_set_network_values (packet, client, connection);
-					if (packet_send (packet, 0, NULL, false)) {
+					if (connection_send_control_packet (connection, packet, true)) {
 						client_log_error ("Failed to send CLIENT_CLOSE_CONNECTION!");
 					}
 					packet_delete (packet);
@@ -1609,6 +2054,10 @@ int client_connection_end (Client *client, Connection *connection) {
 	int retval = 1;
 
 	if (client && connection) {
+		// stop receiving from the connection before closing its socket
+		reactor_unregister_connection (connection);
+		uring_unregister_connection (connection);
+
 		client_connection_close (client, connection);
 
 		dlist_remove (client->connections, connection, NULL);
@@ -1640,7 +2089,20 @@ static void client_app_handler_destroy (Client *client) {
 		if (client->app_packet_handler) {
 			if (!client->app_packet_handler->direct_handle) {
 				// stop app handler
-				bsem_post_all (client->app_packet_handler->job_queue->has_jobs);
+				handler_wake_up (client->app_packet_handler);
+			}
+		}
+	}
+
+}
+
+static void client_app_handlers_destroy (Client *client) {
+
+	if (client) {
+		for (unsigned int i = 0; i < CLIENT_MAX_APP_HANDLERS; i++) {
+			if (client->app_packet_handlers[i]) {
+				// stop app handler
+				handler_wake_up (client->app_packet_handlers[i]);
 			}
 		}
 	}
@@ -1653,7 +2115,7 @@ static void client_app_error_handler_destroy (Client *client) {
 		if (client->app_error_packet_handler) {
 			if (!client->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (client->app_error_packet_handler->job_queue->has_jobs);
+				handler_wake_up (client->app_error_packet_handler);
 			}
 		}
 	}
@@ -1666,7 +2128,20 @@ static void client_custom_handler_destroy (Client *client) {
 		if (client->custom_packet_handler) {
 			if (!client->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (client->custom_packet_handler->job_queue->has_jobs);
+				handler_wake_up (client->custom_packet_handler);
+			}
+		}
+	}
+
+}
+
+static void client_game_handler_destroy (Client *client) {
+
+	if (client) {
+		if (client->game_packet_handler) {
+			if (!client->game_packet_handler->direct_handle) {
+				// stop game handler
+				handler_wake_up (client->game_packet_handler);
 			}
 		}
 	}
@@ -1683,20 +2158,29 @@ static void client_handlers_destroy (Client *client) {
 
 		client_app_handler_destroy (client);
 
+		client_app_handlers_destroy (client);
+
 		client_app_error_handler_destroy (client);
 
 		client_custom_handler_destroy (client);
 
+		client_game_handler_destroy (client);
+
 		// poll remaining handlers
 		while (client->num_handlers_alive) {
 			if (client->app_packet_handler)
-				bsem_post_all (client->app_packet_handler->job_queue->has_jobs);
+				handler_wake_up (client->app_packet_handler);
 
 			if (client->app_error_packet_handler)
-				bsem_post_all (client->app_error_packet_handler->job_queue->has_jobs);
+				handler_wake_up (client->app_error_packet_handler);
 
 			if (client->custom_packet_handler)
-				bsem_post_all (client->custom_packet_handler->job_queue->has_jobs);
+				handler_wake_up (client->custom_packet_handler);
+
+			if (client->game_packet_handler)
+				handler_wake_up (client->game_packet_handler);
+
+			client_app_handlers_destroy (client);
 
 			sleep (1);
 		}
@@ -1709,6 +2193,10 @@ static void *client_teardown_internal (void *client_ptr) {
 	if (client_ptr) {
 		Client *client = (Client *) client_ptr;
 
+		// stop handling connections sockets
+		reactor_stop (client->reactor);
+		uring_stop (client->uring);
+
 		pthread_mutex_lock (client->lock);
 
 		// end any ongoing connection
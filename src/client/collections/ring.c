@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "client/collections/ring.h"
+
+#define RING_SEQUENCE_SIZE			sizeof (size_t)
+
+const char *ring_type_to_string (const RingType type) {
+
+	switch (type) {
+		#define XX(num, name, string) case RING_TYPE_##name: return #string;
+		RING_TYPE_MAP(XX)
+		#undef XX
+	}
+
+	return ring_type_to_string (RING_TYPE_MPMC);
+
+}
+
+#pragma region internal
+
+static inline size_t *ring_slot_sequence (
+	const Ring *ring, const size_t position
+) {
+
+	return (size_t *) (ring->slots + ((position & ring->mask) * ring->slot_size));
+
+}
+
+static inline void *ring_slot_element (
+	const Ring *ring, const size_t position
+) {
+
+	return ring->slots + ((position & ring->mask) * ring->slot_size) + RING_SEQUENCE_SIZE;
+
+}
+
+static Ring *ring_new (void) {
+
+	Ring *ring = (Ring *) malloc (sizeof (Ring));
+	if (ring) {
+		(void) memset (ring, 0, sizeof (Ring));
+
+		ring->type = RING_TYPE_MPMC;
+
+		ring->slots = NULL;
+	}
+
+	return ring;
+
+}
+
+#pragma endregion
+
+Ring *ring_create (
+	const RingType type,
+	const size_t capacity, const size_t element_size
+) {
+
+	Ring *ring = NULL;
+
+	if (capacity && element_size) {
+		ring = ring_new ();
+		if (ring) {
+			ring->type = type;
+
+			ring->capacity = 1;
+			while (ring->capacity < capacity) ring->capacity <<= 1;
+			ring->mask = ring->capacity - 1;
+
+			// slots are aligned to their sequence
+			ring->element_size = element_size;
+			ring->slot_size = (
+				(RING_SEQUENCE_SIZE + element_size + RING_SEQUENCE_SIZE - 1)
+				/ RING_SEQUENCE_SIZE
+			) * RING_SEQUENCE_SIZE;
+
+			ring->slots = (char *) malloc (ring->capacity * ring->slot_size);
+			if (ring->slots) {
+				// a slot can be pushed when its sequence matches the position
+				for (size_t i = 0; i < ring->capacity; i++) {
+					*ring_slot_sequence (ring, i) = i;
+				}
+
+				ring->tail = 0;
+				ring->head = 0;
+			}
+
+			else {
+				ring_delete (ring);
+				ring = NULL;
+			}
+		}
+	}
+
+	return ring;
+
+}
+
+void ring_delete (void *ring_ptr) {
+
+	if (ring_ptr) {
+		Ring *ring = (Ring *) ring_ptr;
+
+		free (ring->slots);
+
+		free (ring_ptr);
+	}
+
+}
+
+size_t ring_size (const Ring *ring) {
+
+	size_t size = 0;
+
+	if (ring) {
+		size_t head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+		size_t tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+
+		// the head can be read before a pop that overtakes the tail
+		size = (tail > head) ? (tail - head) : 0;
+		if (size > ring->capacity) size = ring->capacity;
+	}
+
+	return size;
+
+}
+
+bool ring_is_empty (const Ring *ring) {
+
+	return !ring_size (ring);
+
+}
+
+bool ring_is_full (const Ring *ring) {
+
+	return ring ? (ring_size (ring) == ring->capacity) : false;
+
+}
+
+#pragma region spsc
+
+static unsigned int ring_push_spsc (Ring *ring, const void *element) {
+
+	size_t tail = __atomic_load_n (&ring->tail, __ATOMIC_RELAXED);
+	size_t head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+
+	if ((tail - head) == ring->capacity) return 1;
+
+	(void) memcpy (ring_slot_element (ring, tail), element, ring->element_size);
+
+	__atomic_store_n (&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return 0;
+
+}
+
+static unsigned int ring_pop_spsc (Ring *ring, void *element) {
+
+	size_t head = __atomic_load_n (&ring->head, __ATOMIC_RELAXED);
+	size_t tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (head == tail) return 1;
+
+	(void) memcpy (element, ring_slot_element (ring, head), ring->element_size);
+
+	__atomic_store_n (&ring->head, head + 1, __ATOMIC_RELEASE);
+
+	return 0;
+
+}
+
+#pragma endregion
+
+#pragma region mpmc
+
+// a position is claimed by moving the tail or the head with a cas
+// and the slot's sequence tells if it is ready to be pushed or popped
+static unsigned int ring_push_mpmc (Ring *ring, const void *element) {
+
+	size_t position = __atomic_load_n (&ring->tail, __ATOMIC_RELAXED);
+	size_t *sequence = NULL;
+
+	for (;;) {
+		sequence = ring_slot_sequence (ring, position);
+		intptr_t diff = (intptr_t) __atomic_load_n (sequence, __ATOMIC_ACQUIRE)
+			- (intptr_t) position;
+
+		if (!diff) {
+			if (__atomic_compare_exchange_n (
+				&ring->tail, &position, position + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+			)) {
+				break;
+			}
+		}
+
+		// the slot has not been popped since the last lap
+		else if (diff < 0) {
+			return 1;
+		}
+
+		else {
+			position = __atomic_load_n (&ring->tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	(void) memcpy (sequence + 1, element, ring->element_size);
+
+	__atomic_store_n (sequence, position + 1, __ATOMIC_RELEASE);
+
+	return 0;
+
+}
+
+static unsigned int ring_pop_mpmc (Ring *ring, void *element) {
+
+	size_t position = __atomic_load_n (&ring->head, __ATOMIC_RELAXED);
+	size_t *sequence = NULL;
+
+	for (;;) {
+		sequence = ring_slot_sequence (ring, position);
+		intptr_t diff = (intptr_t) __atomic_load_n (sequence, __ATOMIC_ACQUIRE)
+			- (intptr_t) (position + 1);
+
+		if (!diff) {
+			if (__atomic_compare_exchange_n (
+				&ring->head, &position, position + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+			)) {
+				break;
+			}
+		}
+
+		// the slot has not been pushed yet
+		else if (diff < 0) {
+			return 1;
+		}
+
+		else {
+			position = __atomic_load_n (&ring->head, __ATOMIC_RELAXED);
+		}
+	}
+
+	(void) memcpy (element, sequence + 1, ring->element_size);
+
+	// the slot can be pushed again in the next lap
+	__atomic_store_n (sequence, position + ring->capacity, __ATOMIC_RELEASE);
+
+	return 0;
+
+}
+
+#pragma endregion
+
+unsigned int ring_push (Ring *ring, const void *element) {
+
+	unsigned int retval = 1;
+
+	if (ring && element) {
+		retval = (ring->type == RING_TYPE_SPSC) ?
+			ring_push_spsc (ring, element) : ring_push_mpmc (ring, element);
+	}
+
+	return retval;
+
+}
+
+unsigned int ring_pop (Ring *ring, void *element) {
+
+	unsigned int retval = 1;
+
+	if (ring && element) {
+		retval = (ring->type == RING_TYPE_SPSC) ?
+			ring_pop_spsc (ring, element) : ring_pop_mpmc (ring, element);
+	}
+
+	return retval;
+
+}
\ No newline at end of file
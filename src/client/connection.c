@@ -5,6 +5,11 @@
 
 #include <unistd.h>
 #include <time.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "client/types/types.h"
 #include "client/types/string.h"
@@ -12,14 +17,20 @@
 #include "client/collections/htab.h"
 #include "client/collections/dlist.h"
 
+#include "client/events.h"
+
 #include "client/auth.h"
 #include "client/cerver.h"
 #include "client/client.h"
 #include "client/handler.h"
 #include "client/network.h"
 #include "client/packets.h"
+#include "client/reactor.h"
 #include "client/receive.h"
+#include "client/requests.h"
 #include "client/socket.h"
+#include "client/stats.h"
+#include "client/uring.h"
 
 #include "client/threads/thread.h"
 
@@ -35,8 +46,7 @@ ConnectionStats *connection_stats_new (void) {
 	ConnectionStats *stats = (ConnectionStats *) malloc (sizeof (ConnectionStats));
 	if (stats) {
 		(void) memset (stats, 0, sizeof (ConnectionStats));
-		stats->received_packets = packets_per_type_new ();
-		stats->sent_packets = packets_per_type_new ();
+		stats->counters = stats_shards_create (1);
 	}
 
 	return stats;
@@ -46,8 +56,7 @@ ConnectionStats *connection_stats_new (void) {
 static inline void connection_stats_delete (ConnectionStats *stats) {
 
 	if (stats) {
-		packets_per_type_delete (stats->received_packets);
-		packets_per_type_delete (stats->sent_packets);
+		stats_shards_delete (stats->counters);
 
 		free (stats);
 	}
@@ -60,19 +69,19 @@ void connection_stats_print (Connection *connection) {
 		if (connection->stats) {
 			client_log_msg ("Threshold time:            %ld", connection->stats->threshold_time);
 
-			client_log_msg ("N receives done:           %lu", connection->stats->n_receives_done);
+			StatsSnapshot snapshot = { 0 };
+			connection_stats_get (connection, &snapshot);
+			stats_snapshot_print (&snapshot);
 
-			client_log_msg ("Total bytes received:      %lu", connection->stats->total_bytes_received);
-			client_log_msg ("Total bytes sent:          %lu", connection->stats->total_bytes_sent);
+			client_log_msg ("Receive buffer size:       %lu", connection->stats->receive_buffer_size);
+			client_log_msg ("Receive low watermark:     %lu", connection->stats->receive_low_watermark);
+			client_log_msg ("N receive buffer resizes:  %lu", connection->stats->n_receive_buffer_resizes);
 
-			client_log_msg ("N packets received:        %lu", connection->stats->n_packets_received);
-			client_log_msg ("N packets sent:            %lu", connection->stats->n_packets_sent);
+			client_log_msg ("N resyncs:                 %lu", connection->stats->n_resyncs);
+			client_log_msg ("Resync skipped bytes:      %lu", connection->stats->resync_skipped_bytes);
 
-			client_log_msg ("\nReceived packets:");
-			packets_per_type_print (connection->stats->received_packets);
-
-			client_log_msg ("\nSent packets:");
-			packets_per_type_print (connection->stats->sent_packets);
+			client_log_msg ("N send queue rejected:     %lu", connection->stats->n_send_queue_rejected);
+			client_log_msg ("N send queue dropped:      %lu", connection->stats->n_send_queue_dropped);
 		}
 
 		else {
@@ -96,6 +105,34 @@ void connection_stats_print (Connection *connection) {
 
 #pragma region main
 
+const char *connection_send_queue_policy_description (
+	const ConnectionSendQueuePolicy policy
+) {
+
+	switch (policy) {
+		#define XX(num, name, description) case CONNECTION_SEND_QUEUE_POLICY_##name: return #description;
+		CONNECTION_SEND_QUEUE_POLICY_MAP(XX)
+		#undef XX
+	}
+
+	return connection_send_queue_policy_description (CONNECTION_SEND_QUEUE_POLICY_BLOCK);
+
+}
+
+const char *connection_send_lane_to_string (
+	const ConnectionSendLane lane
+) {
+
+	switch (lane) {
+		#define XX(num, name, string) case CONNECTION_SEND_LANE_##name: return #string;
+		CONNECTION_SEND_LANE_MAP(XX)
+		#undef XX
+	}
+
+	return connection_send_lane_to_string (CONNECTION_SEND_LANE_BULK);
+
+}
+
 Connection *connection_new (void) {
 
 	Connection *connection = (Connection *) malloc (sizeof (Connection));
@@ -123,6 +160,20 @@ Connection *connection_new (void) {
 
 		connection->receive_packet_buffer_size = CONNECTION_DEFAULT_RECEIVE_BUFFER_SIZE;
 
+		connection->adaptive_receive = CONNECTION_DEFAULT_ADAPTIVE_RECEIVE;
+		connection->receive_min_buffer_size = RECEIVE_ADAPTIVE_DEFAULT_MIN_SIZE;
+		connection->receive_max_buffer_size = RECEIVE_ADAPTIVE_DEFAULT_MAX_SIZE;
+
+		connection->max_packet_size = CONNECTION_DEFAULT_MAX_PACKET_SIZE;
+		connection->stream_threshold = 0;
+		connection->max_stream_packet_size = CONNECTION_DEFAULT_MAX_STREAM_PACKET_SIZE;
+		connection->stream_handler = NULL;
+		connection->stream_handler_data = NULL;
+
+		connection->zero_copy_receive = CONNECTION_DEFAULT_ZERO_COPY_RECEIVE;
+		connection->receive_buffer_pool_size = RECEIVE_BUFFER_POOL_DEFAULT_SIZE;
+		connection->receive_buffer_pool = NULL;
+
 		connection->receive_handle = (ReceiveHandle) {
 			.type = RECEIVE_TYPE_NONE,
 
@@ -134,6 +185,8 @@ Connection *connection_new (void) {
 			.buffer_size = 0,
 			.received_size = 0,
 
+			.receive_buffer = NULL,
+
 			.state = RECEIVE_HANDLE_STATE_NONE,
 
 			.header = (PacketHeader) {
@@ -147,16 +200,51 @@ Connection *connection_new (void) {
 			.header_end = NULL,
 			.remaining_header = 0,
 
-			.spare_packet = NULL
+			.resync_tail = { 0 },
+			.resync_tail_size = 0,
+
+			.spare_packet = NULL,
+
+			.stream = (PacketStream) {
+				.client = NULL,
+				.connection = NULL,
+
+				.data_size = 0,
+				.delivered = 0,
+
+				.chunk = NULL,
+				.chunk_size = 0,
+
+				.done = false,
+
+				.data = NULL
+			},
+
+			.read_buffer = NULL,
+			.read_buffer_size = 0,
+			.read_start = 0,
+			.read_end = 0
 		};
 
 		connection->update_thread_id = 0;
 		connection->update_timeout = CONNECTION_DEFAULT_UPDATE_TIMEOUT;
 
+		connection->reactor_thread = NULL;
+		connection->reactor_slot = REACTOR_NO_SLOT;
+
+		connection->uring = NULL;
+		connection->uring_connection = NULL;
+
+		connection->uring_sends = NULL;
+		connection->uring_sends_tail = NULL;
+		connection->uring_pending_sends = 0;
+
 		connection->received_data = NULL;
 		connection->received_data_size = 0;
 		connection->received_data_delete = NULL;
 
+		connection->requests = NULL;
+
 		connection->receive_packets = CONNECTION_DEFAULT_RECEIVE_PACKETS;
 
 		connection->custom_receive = NULL;
@@ -166,7 +254,39 @@ Connection *connection_new (void) {
 		connection->use_send_queue = CONNECTION_DEFAULT_USE_SEND_QUEUE;
 		connection->send_flags = CONNECTION_DEFAULT_SEND_FLAGS;
 		connection->send_thread_id = 0;
-		connection->send_queue = NULL;
+
+		for (unsigned int i = 0; i < CONNECTION_SEND_LANES; i++) {
+			connection->send_queues[i] = NULL;
+			connection->send_lane_packets[i] = 0;
+		}
+
+		connection->send_lane_weights[CONNECTION_SEND_LANE_CONTROL] = CONNECTION_DEFAULT_SEND_LANE_CONTROL_WEIGHT;
+		connection->send_lane_weights[CONNECTION_SEND_LANE_INTERACTIVE] = CONNECTION_DEFAULT_SEND_LANE_INTERACTIVE_WEIGHT;
+		connection->send_lane_weights[CONNECTION_SEND_LANE_BULK] = CONNECTION_DEFAULT_SEND_LANE_BULK_WEIGHT;
+
+		connection->send_has_packets = NULL;
+
+		connection->send_queue_ring_size = CONNECTION_DEFAULT_SEND_QUEUE_RING_SIZE;
+
+		connection->send_queue_max_packets = CONNECTION_DEFAULT_SEND_QUEUE_MAX_PACKETS;
+		connection->send_queue_max_bytes = CONNECTION_DEFAULT_SEND_QUEUE_MAX_BYTES;
+		connection->send_queue_policy = CONNECTION_DEFAULT_SEND_QUEUE_POLICY;
+
+		connection->send_queue_packets = 0;
+		connection->send_queue_bytes = 0;
+		connection->send_queue_full = false;
+		connection->send_queue_client = NULL;
+		(void) pthread_mutex_init (&connection->send_queue_mutex, NULL);
+		(void) pthread_cond_init (&connection->send_queue_cond, NULL);
+		connection->send_control_sending = 0;
+		connection->send_failed = false;
+
+		connection->nonblocking_send = CONNECTION_DEFAULT_NONBLOCKING_SEND;
+		connection->max_output_size = CONNECTION_DEFAULT_MAX_OUTPUT_SIZE;
+		connection->output_buffer = NULL;
+		connection->output_buffer_size = 0;
+		connection->output_start = 0;
+		connection->output_end = 0;
 
 		connection->authenticated = false;
 		connection->auth_data = NULL;
@@ -190,10 +310,16 @@ void connection_delete (void *connection_ptr) {
 	if (connection_ptr) {
 		Connection *connection = (Connection *) connection_ptr;
 
-		socket_delete (connection->socket);
+		// stop any pending receive before its socket gets closed
+		uring_unregister_connection (connection);
 
+		// ends the connection's requests with its socket still alive
 		if (connection->active) connection_end (connection);
 
+		socket_delete (connection->socket);
+
+		requests_delete (connection->requests);
+
 		cerver_delete (connection->cerver);
 
 		if (connection->received_data && connection->received_data_delete)
@@ -205,7 +331,27 @@ void connection_delete (void *connection_ptr) {
 			}
 		}
 
-		job_queue_delete (connection->send_queue);
+		// the packets that were never sent belong to the queue
+		Job job = { 0 };
+		for (unsigned int i = 0; i < CONNECTION_SEND_LANES; i++) {
+			while (!job_queue_pull_job (connection->send_queues[i], &job)) {
+				packet_delete (job.args);
+			}
+
+			job_queue_delete (connection->send_queues[i]);
+		}
+
+		bsem_delete (connection->send_has_packets);
+
+		free (connection->output_buffer);
+
+		(void) pthread_cond_destroy (&connection->send_queue_cond);
+		(void) pthread_mutex_destroy (&connection->send_queue_mutex);
+
+		// a reactor handled connection keeps its pool until it is deleted
+		receive_buffer_pool_delete (connection->receive_buffer_pool);
+
+		free (connection->receive_handle.read_buffer);
 
 		connection_remove_auth_data (connection);
 
@@ -232,6 +378,8 @@ Connection *connection_create_empty (void) {
 		connection->socket = (Socket *) socket_create_empty ();
 
 		connection->stats = connection_stats_new ();
+
+		connection->requests = requests_create (connection);
 	}
 
 	return connection;
@@ -342,6 +490,119 @@ void connection_set_receive_buffer_size (Connection *connection, u32 size) {
 
 }
 
+// enables zero-copy receives in connection_update ()
+// packets that fit inside a receive buffer will reference it instead of copying
+// their data, and buffers are returned to the connection's pool
+// once the last packet that references them has been deleted
+void connection_set_zero_copy_receive (
+	Connection *connection, bool zero_copy, u32 pool_size
+) {
+
+	if (connection) {
+		connection->zero_copy_receive = zero_copy;
+		connection->receive_buffer_pool_size = pool_size ?
+			pool_size : RECEIVE_BUFFER_POOL_DEFAULT_SIZE;
+	}
+
+}
+
+// enables adaptive receives in connection_update ()
+// the receive buffer grows while reads keep filling it or packets are split
+// and shrinks after many small reads, always within min_size and max_size
+// zero-copy & custom receives take precedence over adaptive receives
+// the reactor & io_uring backends use their own buffers and ignore it
+void connection_set_adaptive_receive (
+	Connection *connection, bool adaptive,
+	size_t min_size, size_t max_size
+) {
+
+	if (connection) {
+		connection->adaptive_receive = adaptive;
+		connection->receive_min_buffer_size = min_size ?
+			min_size : RECEIVE_ADAPTIVE_DEFAULT_MIN_SIZE;
+		connection->receive_max_buffer_size = max_size ?
+			max_size : RECEIVE_ADAPTIVE_DEFAULT_MAX_SIZE;
+
+		if (connection->receive_max_buffer_size < connection->receive_min_buffer_size) {
+			connection->receive_max_buffer_size = connection->receive_min_buffer_size;
+		}
+	}
+
+}
+
+// sets the max size of the packets (including their header)
+// that the connection will accept, bigger packets are considered bad
+// streamed packets are checked against the max stream packet size
+void connection_set_max_packet_size (
+	Connection *connection, size_t max_packet_size
+) {
+
+	if (connection) {
+		connection->max_packet_size = max_packet_size ?
+			max_packet_size : CONNECTION_DEFAULT_MAX_PACKET_SIZE;
+	}
+
+}
+
+// packets with more than threshold bytes of data will be delivered
+// to the stream handler in chunks as their bytes arrive
+// instead of being buffered whole and sent to the packet handlers
+// they can be bigger than the connection's max packet size
+// up to its max stream packet size
+void connection_set_stream_handler (
+	Connection *connection, size_t threshold,
+	void (*stream_handler)(PacketStream *stream), void *data
+) {
+
+	if (connection) {
+		connection->stream_threshold = threshold;
+		connection->stream_handler = stream_handler;
+		connection->stream_handler_data = data;
+	}
+
+}
+
+// sets the max size of the packets (including their header)
+// that are delivered to the stream handler, bigger packets are considered bad
+void connection_set_max_stream_packet_size (
+	Connection *connection, size_t max_stream_packet_size
+) {
+
+	if (connection) {
+		connection->max_stream_packet_size = max_stream_packet_size ?
+			max_stream_packet_size : CONNECTION_DEFAULT_MAX_STREAM_PACKET_SIZE;
+	}
+
+}
+
+// checks if a packet of packet_size bytes (including its header)
+// will be delivered to the connection's stream handler
+bool connection_packet_is_streamed (
+	const Connection *connection, const size_t packet_size
+) {
+
+	return connection->stream_handler
+		&& (packet_size >= sizeof (PacketHeader))
+		&& ((packet_size - sizeof (PacketHeader)) > connection->stream_threshold);
+
+}
+
+// checks if a packet of packet_size bytes (including its header)
+// is accepted by the connection, using the max stream packet size
+// for the packets that are streamed and the max packet size for the rest
+bool connection_packet_size_is_valid (
+	const Connection *connection, const size_t packet_size
+) {
+
+	return (packet_size >= sizeof (PacketHeader))
+		&& (
+			connection_packet_is_streamed (connection, packet_size) ?
+				(packet_size <= connection->max_stream_packet_size) :
+				(packet_size <= connection->max_packet_size)
+		);
+
+}
+
 // sets the timeout (in secs) the connection's socket will have
 // this refers to the time the socket will block waiting for new data to araive
 // note that this only has effect in connection_update ()
@@ -400,7 +661,110 @@ void connection_set_send_queue (
 		connection->use_send_queue = true;
 		connection->send_flags = flags;
 
-		connection->send_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+		if (!connection->send_has_packets) {
+			for (unsigned int i = 0; i < CONNECTION_SEND_LANES; i++) {
+				connection->send_queues[i] = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+
+				if (connection->send_queue_ring_size) {
+					(void) job_queue_set_ring (
+						connection->send_queues[i],
+						RING_TYPE_SPSC, connection->send_queue_ring_size
+					);
+				}
+			}
+
+			connection->send_has_packets = bsem_new ();
+			bsem_init (connection->send_has_packets, 0);
+		}
+	}
+
+}
+
+// limits the packets waiting in the connection's send queue
+// by their count and by their total size, 0 for no limit
+// the policy decides what happens to packets sent to a full queue
+// CLIENT_EVENT_SEND_QUEUE_HIGH is triggered when the queue reaches its limits
+// and CLIENT_EVENT_SEND_QUEUE_LOW once it has been drained below half of them
+void connection_set_send_queue_limits (
+	Connection *connection,
+	u32 max_packets, size_t max_bytes,
+	ConnectionSendQueuePolicy policy
+) {
+
+	if (connection) {
+		(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+		connection->send_queue_max_packets = max_packets;
+		connection->send_queue_max_bytes = max_bytes;
+		connection->send_queue_policy = policy;
+
+		// producers waiting for the previous limits
+		(void) pthread_cond_broadcast (&connection->send_queue_cond);
+
+		(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+	}
+
+}
+
+// stores the packets of each send lane inline in a bounded ring
+// instead of a list, a full lane is handled using the queue's policy
+// must be called before the connection starts
+// returns 0 on success, 1 on error
+u8 connection_set_send_queue_ring (
+	Connection *connection, u32 ring_size
+) {
+
+	u8 retval = 1;
+
+	if (connection && ring_size) {
+		connection->send_queue_ring_size = ring_size;
+
+		// the lanes have already been created
+		unsigned int errors = 0;
+		for (unsigned int i = 0; i < CONNECTION_SEND_LANES; i++) {
+			if (connection->send_queues[i]) {
+				errors |= job_queue_set_ring (
+					connection->send_queues[i], RING_TYPE_SPSC, ring_size
+				);
+			}
+		}
+
+		retval = (u8) errors;
+	}
+
+	return retval;
+
+}
+
+// enables non-blocking sends in the connection, sends will return
+// as soon as the socket stops taking bytes, and the rest will be parked
+// in the connection's output buffer, up to max_output_size bytes (0 for the default)
+void connection_set_nonblocking_send (
+	Connection *connection, bool nonblocking, size_t max_output_size
+) {
+
+	if (connection) {
+		connection->nonblocking_send = nonblocking;
+		connection->max_output_size = max_output_size ?
+			max_output_size : CONNECTION_DEFAULT_MAX_OUTPUT_SIZE;
+	}
+
+}
+
+// sets the max packets that the send thread takes from the lane
+// in every round, lanes are visited from the highest priority to the lowest
+// so control packets preempt the others between batches
+void connection_set_send_lane_weight (
+	Connection *connection, const ConnectionSendLane lane, u32 weight
+) {
+
+	if (connection && (lane < CONNECTION_SEND_LANES)) {
+		(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+		// every lane must be able to make progress
+		connection->send_lane_weights[lane] = weight ? weight : 1;
+
+		(void) pthread_mutex_unlock (&connection->send_queue_mutex);
 	}
 
 }
@@ -572,9 +936,35 @@ void connection_end (Connection *connection) {
 
 	if (connection) {
 		if (connection->active) {
+			// the ring cancels the connection's pending sends
+			// before its socket is closed & its output is reset
+			uring_unregister_connection (connection);
+
 			close (connection->socket->sock_fd);
 			connection->socket->sock_fd = -1;
 			connection->active = false;
+
+			// bytes read ahead belong to the ended session
+			connection->receive_handle.read_start = 0;
+			connection->receive_handle.read_end = 0;
+
+			// and so do the bytes that were never sent
+			(void) pthread_mutex_lock (connection->socket->write_mutex);
+			connection->output_start = 0;
+			connection->output_end = 0;
+			(void) pthread_mutex_unlock (connection->socket->write_mutex);
+
+			// wake up the send thread & any producer waiting for room
+			if (connection->send_has_packets) {
+				(void) pthread_mutex_lock (&connection->send_queue_mutex);
+				(void) pthread_cond_broadcast (&connection->send_queue_cond);
+				(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
+				bsem_post (connection->send_has_packets);
+			}
+
+			// no response will arrive for the requests in flight
+			requests_end (connection->requests);
 		}
 	}
 
@@ -685,6 +1075,172 @@ static inline void connection_custom_receive_data_delete (
 
 #pragma GCC diagnostic pop
 
+// sends any parked output after each receive
+// keeps sending while the socket takes more bytes until there is data to read
+static void connection_update_flush (Connection *connection) {
+
+	if (connection->nonblocking_send && (connection->output_end > connection->output_start)) {
+		struct pollfd pfd = {
+			.fd = connection->socket->sock_fd,
+			.events = POLLIN | POLLOUT,
+			.revents = 0
+		};
+
+		while (
+			connection->active
+			&& (connection_output_flush (connection) == PACKET_SEND_RESULT_QUEUED)
+			&& (poll (&pfd, 1, (int) connection->update_timeout * 1000) > 0)
+			&& !(pfd.revents & ~POLLOUT)
+		);
+	}
+
+}
+
+// receives data into a single buffer that is reused by every recv ()
+// packets copy their data out of the buffer
+static void connection_update_buffer (
+	ClientConnection *cc, const size_t buffer_size
+) {
+
+	char *buffer = (char *) calloc (buffer_size, sizeof (char));
+	if (buffer) {
+		(void) sock_set_timeout (
+			cc->connection->socket->sock_fd,
+			cc->connection->update_timeout
+		);
+
+		cc->connection->updating = true;
+
+		// check if we have a custom receive method
+		if (cc->connection->custom_receive) {
+			ConnectionCustomReceiveData custom_data = {
+				.client = cc->client,
+				.connection = cc->connection,
+				.args = cc->connection->custom_receive_args
+			};
+
+			while (
+				cc->client->running
+				&& cc->connection->active
+				&& !cc->connection->custom_receive (
+					&custom_data,
+					buffer, buffer_size
+				)
+			) {
+				connection_update_flush (cc->connection);
+			}
+		}
+
+		// use the default receive method
+		// that handles cerver type packages
+		else {
+			while (
+				cc->client->running
+				&& cc->connection->active
+				&& !client_receive_internal (
+					cc->client, cc->connection,
+					buffer, buffer_size
+				)
+			) {
+				connection_update_flush (cc->connection);
+			}
+		}
+
+		free (buffer);
+	}
+
+	else {
+		client_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+			"connection_update () - "
+			"Failed to allocate buffer for client %s - connection %s!",
+			cc->client->name, cc->connection->name
+		);
+	}
+
+}
+
+// receives data into refcounted buffers taken from the connection's pool
+// a buffer stays alive until the last packet that references it is deleted
+static void connection_update_zero_copy (
+	ClientConnection *cc, const size_t buffer_size
+) {
+
+	cc->connection->receive_buffer_pool = receive_buffer_pool_create (
+		buffer_size, cc->connection->receive_buffer_pool_size
+	);
+
+	if (cc->connection->receive_buffer_pool) {
+		(void) sock_set_timeout (
+			cc->connection->socket->sock_fd,
+			cc->connection->update_timeout
+		);
+
+		cc->connection->updating = true;
+
+		while (
+			cc->client->running
+			&& cc->connection->active
+			&& !client_receive_zero_copy (
+				cc->client, cc->connection,
+				cc->connection->receive_buffer_pool
+			)
+		);
+
+		// buffers still referenced by packets will be freed when they are released
+		receive_buffer_pool_delete (cc->connection->receive_buffer_pool);
+		cc->connection->receive_buffer_pool = NULL;
+	}
+
+	else {
+		client_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+			"connection_update () - "
+			"Failed to create buffer pool for client %s - connection %s!",
+			cc->client->name, cc->connection->name
+		);
+	}
+
+}
+
+// receives data into a buffer whose size is tuned from the observed reads
+// packets copy their data out of the buffer
+static void connection_update_adaptive (ClientConnection *cc) {
+
+	ReceiveAdaptive adaptive = { 0 };
+	if (!receive_adaptive_init (&adaptive, cc->connection)) {
+		(void) sock_set_timeout (
+			cc->connection->socket->sock_fd,
+			cc->connection->update_timeout
+		);
+
+		cc->connection->updating = true;
+
+		while (
+			cc->client->running
+			&& cc->connection->active
+			&& !client_receive_adaptive (
+				cc->client, cc->connection,
+				&adaptive
+			)
+		) {
+			connection_update_flush (cc->connection);
+		}
+
+		receive_adaptive_end (&adaptive, cc->connection);
+	}
+
+	else {
+		client_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+			"connection_update () - "
+			"Failed to allocate buffer for client %s - connection %s!",
+			cc->client->name, cc->connection->name
+		);
+	}
+
+}
+
 // starts listening and receiving data in the connection sock
 void *connection_update (void *client_connection_ptr) {
 
@@ -719,57 +1275,23 @@ void *connection_update (void *client_connection_ptr) {
 
 		cc->connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
 
-		const size_t buffer_size = cc->connection->receive_packet_buffer_size;
-		char *buffer = (char *) calloc (buffer_size, sizeof (char));
-		if (buffer) {
-			(void) sock_set_timeout (
-				cc->connection->socket->sock_fd,
-				cc->connection->update_timeout
-			);
+		if (!cc->connection->custom_receive) {
+			client_receive_handle_read_ahead (cc->client, cc->connection);
+		}
 
-			cc->connection->updating = true;
-
-			// check if we have a custom receive method
-			if (cc->connection->custom_receive) {
-				ConnectionCustomReceiveData custom_data = {
-					.client = cc->client,
-					.connection = cc->connection,
-					.args = cc->connection->custom_receive_args
-				};
-
-				while (
-					cc->client->running
-					&& cc->connection->active
-					&& !cc->connection->custom_receive (
-						&custom_data,
-						buffer, buffer_size
-					)
-				);
-			}
+		const size_t buffer_size = cc->connection->receive_packet_buffer_size;
 
-			// use the default receive method
-			// that handles cerver type packages
-			else {
-				while (
-					cc->client->running
-					&& cc->connection->active
-					&& !client_receive_internal (
-						cc->client, cc->connection,
-						buffer, buffer_size
-					)
-				);
-			}
+		// packets will reference pooled buffers instead of copying their data
+		if (cc->connection->zero_copy_receive && !cc->connection->custom_receive) {
+			connection_update_zero_copy (cc, buffer_size);
+		}
 
-			free (buffer);
+		else if (cc->connection->adaptive_receive && !cc->connection->custom_receive) {
+			connection_update_adaptive (cc);
 		}
 
 		else {
-			client_log (
-				LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
-				"connection_update () - "
-				"Failed to allocate buffer for client %s - connection %s!",
-				client_name, connection_name
-			);
+			connection_update_buffer (cc, buffer_size);
 		}
 
 		// signal waiting thread
@@ -795,19 +1317,679 @@ void *connection_update (void *client_connection_ptr) {
 
 #pragma endregion
 
+#pragma region output
+
+// the parked output is sent without blocking nor raising SIGPIPE
+#define CONNECTION_OUTPUT_SEND_FLAGS			(MSG_DONTWAIT | MSG_NOSIGNAL)
+
+// makes room at the end of the output buffer for size more bytes
+static u8 connection_output_reserve (
+	Connection *connection, const size_t size
+) {
+
+	size_t pending = connection->output_end - connection->output_start;
+
+	// move the pending bytes to the start of the buffer
+	if (connection->output_start && ((connection->output_end + size) > connection->output_buffer_size)) {
+		(void) memmove (
+			connection->output_buffer,
+			connection->output_buffer + connection->output_start,
+			pending
+		);
+
+		connection->output_start = 0;
+		connection->output_end = pending;
+	}
+
+	if ((connection->output_end + size) > connection->output_buffer_size) {
+		size_t new_size = connection->output_buffer_size ?
+			connection->output_buffer_size : CONNECTION_OUTPUT_MIN_BUFFER_SIZE;
+		while (new_size < (connection->output_end + size)) new_size *= 2;
+
+		char *new_buffer = (char *) realloc (connection->output_buffer, new_size);
+		if (!new_buffer) return 1;
+
+		connection->output_buffer = new_buffer;
+		connection->output_buffer_size = new_size;
+	}
+
+	return 0;
+
+}
+
+// parks the bytes of the iovecs that come after the first skip bytes
+static u8 connection_output_append (
+	Connection *connection,
+	const struct iovec *iov, const size_t n_iov,
+	size_t skip, const size_t size
+) {
+
+	if (connection_output_reserve (connection, size - skip)) return 1;
+
+	for (size_t i = 0; i < n_iov; i++) {
+		if (skip >= iov[i].iov_len) {
+			skip -= iov[i].iov_len;
+			continue;
+		}
+
+		(void) memcpy (
+			connection->output_buffer + connection->output_end,
+			(const char *) iov[i].iov_base + skip,
+			iov[i].iov_len - skip
+		);
+
+		connection->output_end += iov[i].iov_len - skip;
+		skip = 0;
+	}
+
+	return 0;
+
+}
+
+// sends as much of the parked output as the socket takes without blocking
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+static PacketSendResult connection_output_flush_actual (
+	Connection *connection
+) {
+
+	ssize_t sent = 0;
+	while (connection->output_start < connection->output_end) {
+		sent = send (
+			connection->socket->sock_fd,
+			connection->output_buffer + connection->output_start,
+			connection->output_end - connection->output_start,
+			CONNECTION_OUTPUT_SEND_FLAGS
+		);
+
+		if (sent < 0) {
+			if (errno == EINTR) continue;
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) return PACKET_SEND_RESULT_QUEUED;
+			return PACKET_SEND_RESULT_ERROR;
+		}
+
+		connection->output_start += (size_t) sent;
+	}
+
+	connection->output_start = 0;
+	connection->output_end = 0;
+
+	return PACKET_SEND_RESULT_SENT;
+
+}
+
+// sends the buffers without blocking, parking in the output buffer
+// the bytes that the socket can't take right now
+// fails without sending anything if they would not fit
+// the socket's write mutex must be locked by the caller
+PacketSendResult connection_output_send (
+	Connection *connection,
+	const struct iovec *iov, const size_t n_iov,
+	int flags, size_t *total_sent
+) {
+
+	size_t size = 0;
+	for (size_t i = 0; i < n_iov; i++) size += iov[i].iov_len;
+
+	// every byte might end up in the output buffer
+	size_t pending = connection->output_end - connection->output_start;
+	if ((pending + size) > connection->max_output_size) return PACKET_SEND_RESULT_ERROR;
+
+	// the parked bytes must be sent first
+	if (pending) {
+		if (connection_output_flush_actual (connection) == PACKET_SEND_RESULT_ERROR) {
+			return PACKET_SEND_RESULT_ERROR;
+		}
+
+		pending = connection->output_end - connection->output_start;
+	}
+
+	size_t actual_sent = 0;
+	if (!pending) {
+		struct iovec vec[PACKETS_SEND_BATCH_MAX_IOVECS];
+		struct msghdr msg = { 0 };
+		ssize_t sent = 0;
+
+		size_t skip = 0, n_vec = 0;
+		while (actual_sent < size) {
+			// the iovecs from the first byte that was not sent
+			skip = actual_sent;
+			n_vec = 0;
+			for (size_t i = 0; (i < n_iov) && (n_vec < PACKETS_SEND_BATCH_MAX_IOVECS); i++) {
+				if (skip >= iov[i].iov_len) {
+					skip -= iov[i].iov_len;
+					continue;
+				}
+
+				vec[n_vec].iov_base = (char *) iov[i].iov_base + skip;
+				vec[n_vec].iov_len = iov[i].iov_len - skip;
+				n_vec += 1;
+				skip = 0;
+			}
+
+			msg.msg_iov = vec;
+			msg.msg_iovlen = n_vec;
+
+			sent = sendmsg (
+				connection->socket->sock_fd, &msg, flags | CONNECTION_OUTPUT_SEND_FLAGS
+			);
+			if (sent < 0) {
+				if (errno == EINTR) continue;
+				if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) break;
+
+				// the peer has only received part of the buffers
+				return PACKET_SEND_RESULT_ERROR;
+			}
+
+			actual_sent += (size_t) sent;
+		}
+	}
+
+	PacketSendResult result = PACKET_SEND_RESULT_SENT;
+	if (actual_sent < size) {
+		if (connection_output_append (connection, iov, n_iov, actual_sent, size)) {
+			return PACKET_SEND_RESULT_ERROR;
+		}
+
+		result = PACKET_SEND_RESULT_QUEUED;
+	}
+
+	if (total_sent) *total_sent = size;
+
+	return result;
+
+}
+
+// sends as much of the parked output as the socket takes without blocking
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+PacketSendResult connection_output_flush (Connection *connection) {
+
+	PacketSendResult result = PACKET_SEND_RESULT_ERROR;
+
+	if (connection) {
+		(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+		result = connection_output_flush_actual (connection);
+
+		(void) pthread_mutex_unlock (connection->socket->write_mutex);
+	}
+
+	return result;
+
+}
+
+// waits up to timeout ms at a time for the parked output to be sent
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+PacketSendResult connection_flush (Connection *connection, const int timeout) {
+
+	if (!connection) return PACKET_SEND_RESULT_ERROR;
+
+	struct pollfd pfd = { .fd = connection->socket->sock_fd, .events = POLLOUT, .revents = 0 };
+
+	PacketSendResult result = PACKET_SEND_RESULT_QUEUED;
+	while (
+		connection->active
+		&& ((result = connection_output_flush (connection)) == PACKET_SEND_RESULT_QUEUED)
+	) {
+		pfd.fd = connection->socket->sock_fd;
+
+		int ready = poll (&pfd, 1, timeout);
+		if (ready < 0) {
+			if (errno == EINTR) continue;
+
+			result = PACKET_SEND_RESULT_ERROR;
+			break;
+		}
+
+		// timed out
+		if (!ready) break;
+
+		if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+			result = PACKET_SEND_RESULT_ERROR;
+			break;
+		}
+	}
+
+	return result;
+
+}
+
+#pragma endregion
+
 #pragma region send
 
-void connection_send_packet (
+// checks if a packet of size bytes would go over the send queue limits
+// an empty queue always takes the packet
+static inline bool connection_send_queue_over (
+	const Connection *connection, const size_t size
+) {
+
+	return connection->send_queue_packets && (
+		(
+			connection->send_queue_max_packets
+			&& ((connection->send_queue_packets + 1) > connection->send_queue_max_packets)
+		)
+		|| (
+			connection->send_queue_max_bytes
+			&& ((connection->send_queue_bytes + size) > connection->send_queue_max_bytes)
+		)
+	);
+
+}
+
+// a lane stored in a ring can't take more packets than its slots
+static inline bool connection_send_lane_full (
+	const Connection *connection, const ConnectionSendLane lane
+) {
+
+	return connection->send_queues[lane]->ring
+		&& ring_is_full (connection->send_queues[lane]->ring);
+
+}
+
+// marks the queue as full when it has reached any of its limits
+// returns true if the high watermark has just been crossed
+static inline bool connection_send_queue_check_high (Connection *connection) {
+
+	if (
+		!connection->send_queue_full
+		&& (
+			(
+				connection->send_queue_max_packets
+				&& (connection->send_queue_packets >= connection->send_queue_max_packets)
+			)
+			|| (
+				connection->send_queue_max_bytes
+				&& (connection->send_queue_bytes >= connection->send_queue_max_bytes)
+			)
+		)
+	) {
+		connection->send_queue_full = true;
+		return true;
+	}
+
+	return false;
+
+}
+
+// marks the queue as not full once it is below half of its limits
+// returns true if the low watermark has just been crossed
+static inline bool connection_send_queue_check_low (Connection *connection) {
+
+	if (
+		connection->send_queue_full
+		&& (
+			!connection->send_queue_max_packets
+			|| (connection->send_queue_packets <= (connection->send_queue_max_packets / 2))
+		)
+		&& (
+			!connection->send_queue_max_bytes
+			|| (connection->send_queue_bytes <= (connection->send_queue_max_bytes / 2))
+		)
+	) {
+		connection->send_queue_full = false;
+		return true;
+	}
+
+	return false;
+
+}
+
+// removes the oldest queued packet of the lowest priority lane
+// to make room for a new one, control packets are never dropped
+// returns true if a packet was dropped
+static bool connection_send_queue_drop_oldest (Connection *connection) {
+
+	for (unsigned int lane = CONNECTION_SEND_LANES - 1; lane > CONNECTION_SEND_LANE_CONTROL; lane--) {
+		if (connection->send_lane_packets[lane]) {
+			Job job = { 0 };
+			if (!job_queue_pull_job (connection->send_queues[lane], &job)) {
+				Packet *packet = (Packet *) job.args;
+
+				connection->send_lane_packets[lane] -= 1;
+				connection->send_queue_packets -= 1;
+				connection->send_queue_bytes -= packet->packet_size;
+
+				if (connection->stats) connection->stats->n_send_queue_dropped += 1;
+
+				packet_delete (packet);
+
+				return true;
+			}
+		}
+	}
+
+	return false;
+
+}
+
+// selects the lane of a packet using its type
+static ConnectionSendLane connection_send_packet_get_lane (
+	const Packet *packet
+) {
+
+	switch (packet->packet_type) {
+		case PACKET_TYPE_CERVER:
+		case PACKET_TYPE_CLIENT:
+		case PACKET_TYPE_ERROR:
+		case PACKET_TYPE_REQUEST:
+		case PACKET_TYPE_AUTH:
+		case PACKET_TYPE_TEST:
+			return CONNECTION_SEND_LANE_CONTROL;
+
+		case PACKET_TYPE_APP:
+			return CONNECTION_SEND_LANE_BULK;
+
+		default: break;
+	}
+
+	return CONNECTION_SEND_LANE_INTERACTIVE;
+
+}
+
+// pushes a generated packet into the connection's send queue
+// the lane is selected from the packet's type, auth, requests, pings
+// & close packets go to the control lane and app packets to the bulk lane
+// the queue takes ownership of the packet only on success
+// returns 0 on success, 1 if the packet was not queued
+u8 connection_send_packet (
 	Connection *connection, Packet *packet
 ) {
 
-	if (connection) {
-		(void) job_queue_push (
-			connection->send_queue,
-			job_create (NULL, packet)
+	return packet ? connection_send_packet_lane (
+		connection, packet, connection_send_packet_get_lane (packet)
+	) : 1;
+
+}
+
+// works as connection_send_packet () but using the selected lane
+u8 connection_send_packet_lane (
+	Connection *connection, Packet *packet, const ConnectionSendLane lane
+) {
+
+	u8 retval = 1;
+
+	if (
+		connection && connection->send_has_packets && packet
+		&& (lane < CONNECTION_SEND_LANES)
+	) {
+		bool high = false;
+
+		(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+		// nobody would send the packet
+		bool rejected = connection->send_failed;
+		while (
+			!rejected
+			&& (lane != CONNECTION_SEND_LANE_CONTROL)
+			&& (
+				connection_send_queue_over (connection, packet->packet_size)
+				|| connection_send_lane_full (connection, lane)
+			)
+		) {
+			high |= connection_send_queue_check_high (connection);
+
+			switch (connection->send_queue_policy) {
+				case CONNECTION_SEND_QUEUE_POLICY_BLOCK:
+					if (connection->active && !connection->send_failed) {
+						(void) pthread_cond_wait (
+							&connection->send_queue_cond,
+							&connection->send_queue_mutex
+						);
+					}
+
+					else rejected = true;
+					break;
+
+				case CONNECTION_SEND_QUEUE_POLICY_DROP_OLDEST:
+					// only control packets are left
+					if (!connection_send_queue_drop_oldest (connection)) rejected = true;
+					break;
+
+				default:
+					rejected = true;
+					break;
+			}
+		}
+
+		if (!rejected) {
+			if (!job_queue_push_job (connection->send_queues[lane], NULL, packet)) {
+				connection->send_lane_packets[lane] += 1;
+				connection->send_queue_packets += 1;
+				connection->send_queue_bytes += packet->packet_size;
+
+				bsem_post (connection->send_has_packets);
+
+				high |= connection_send_queue_check_high (connection);
+
+				retval = 0;
+			}
+
+			// the lane's ring is full
+			else if (connection->stats) {
+				connection->stats->n_send_queue_rejected += 1;
+			}
+		}
+
+		else if (connection->stats) {
+			connection->stats->n_send_queue_rejected += 1;
+		}
+
+		(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
+		if (high) {
+			client_event_trigger (
+				CLIENT_EVENT_SEND_QUEUE_HIGH,
+				connection->send_queue_client, connection
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+// waits up to CONNECTION_OUTPUT_FLUSH_TIMEOUT ms for the packets
+// of the control lane to be sent by the send thread
+static void connection_send_control_wait (Connection *connection) {
+
+	struct timespec ts = { 0 };
+	(void) clock_gettime (CLOCK_REALTIME, &ts);
+	ts.tv_sec += CONNECTION_OUTPUT_FLUSH_TIMEOUT / 1000;
+	ts.tv_nsec += (CONNECTION_OUTPUT_FLUSH_TIMEOUT % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec += 1;
+		ts.tv_nsec -= 1000000000L;
+	}
+
+	int result = 0;
+
+	(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+	while (
+		connection->active && !connection->send_failed
+		&& (result != ETIMEDOUT)
+		&& (
+			connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL]
+			|| connection->send_control_sending
+		)
+	) {
+		result = pthread_cond_timedwait (
+			&connection->send_queue_cond, &connection->send_queue_mutex, &ts
+		);
+	}
+
+	(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
+}
+
+// sends a packet generated by the library, like auth, ping & close ones
+// a copy goes through the control lane if the connection has a send queue
+// if wait is set, waits until the control packets have been sent
+// the packet is never consumed
+// returns 0 on success, 1 on error
+u8 connection_send_control_packet (
+	Connection *connection, const Packet *packet, const bool wait
+) {
+
+	u8 retval = 1;
+
+	if (connection && packet) {
+		if (connection->send_has_packets) {
+			Packet *copy = packet_new ();
+			if (copy) {
+				copy->packet_type = packet->packet_type;
+				copy->req_type = packet->req_type;
+				packet_set_network_values (copy, packet->client, connection);
+
+				if (
+					!packet_set_packet (copy, packet->packet, packet->packet_size)
+					&& !connection_send_packet_lane (
+						connection, copy, CONNECTION_SEND_LANE_CONTROL
+					)
+				) {
+					if (wait) connection_send_control_wait (connection);
+
+					retval = 0;
+				}
+
+				else {
+					packet_delete (copy);
+				}
+			}
+		}
+
+		else {
+			size_t sent = 0;
+			if (!packet_send (packet, 0, &sent, false)) {
+				if (sent == packet->packet_size) retval = 0;
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+// takes up to max packets from the lanes using their weights
+// lanes are visited from the highest priority to the lowest
+// until the batch is full or there are no more packets
+// while control packets are waiting, the bulk bytes are capped
+// so the next batch is pulled sooner
+// wakes up any producer that was waiting for room
+static unsigned int connection_send_queue_pull (
+	Connection *connection, Job *jobs, Packet **packets, unsigned int max
+) {
+
+	unsigned int n_jobs = 0;
+	unsigned int pulled = 0;
+	unsigned int n = 0;
+	size_t bytes = 0;
+	size_t bulk_bytes = 0;
+
+	(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+	connection->send_control_sending = 0;
+
+	do {
+		pulled = 0;
+		for (
+			unsigned int lane = 0;
+			(lane < CONNECTION_SEND_LANES)
+			&& (n_jobs < max) && (bytes < PACKETS_SEND_BATCH_MAX_BYTES);
+			lane++
+		) {
+			if (!connection->send_lane_packets[lane]) continue;
+
+			if (
+				(lane == CONNECTION_SEND_LANE_BULK)
+				&& (bulk_bytes >= CONNECTION_SEND_QUEUE_CONTROL_BULK_MAX_BYTES)
+				&& (
+					connection->send_control_sending
+					|| connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL]
+				)
+			) continue;
+
+			n = job_queue_pull_jobs (
+				connection->send_queues[lane], jobs + n_jobs,
+				(connection->send_lane_weights[lane] < (max - n_jobs)) ?
+					connection->send_lane_weights[lane] : (max - n_jobs)
+			);
+
+			for (unsigned int i = n_jobs; i < (n_jobs + n); i++) {
+				packets[i] = (Packet *) jobs[i].args;
+				bytes += packets[i]->packet_size;
+				if (lane == CONNECTION_SEND_LANE_BULK) bulk_bytes += packets[i]->packet_size;
+
+				connection->send_queue_packets -= 1;
+				connection->send_queue_bytes -= packets[i]->packet_size;
+			}
+
+			if (lane == CONNECTION_SEND_LANE_CONTROL) connection->send_control_sending += n;
+
+			connection->send_lane_packets[lane] -= n;
+			n_jobs += n;
+			pulled += n;
+		}
+	} while (pulled && (n_jobs < max) && (bytes < PACKETS_SEND_BATCH_MAX_BYTES));
+
+	// there are still packets for the next round
+	if (connection->send_queue_packets) bsem_post (connection->send_has_packets);
+
+	bool low = connection_send_queue_check_low (connection);
+
+	if (n_jobs) (void) pthread_cond_broadcast (&connection->send_queue_cond);
+
+	(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
+	if (low) {
+		client_event_trigger (
+			CLIENT_EVENT_SEND_QUEUE_LOW,
+			connection->send_queue_client, connection
 		);
 	}
 
+	return n_jobs;
+
+}
+
+// checks if there are control packets waiting in the queue
+static inline bool connection_send_queue_has_control (Connection *connection) {
+
+	(void) pthread_mutex_lock (&connection->send_queue_mutex);
+	bool retval = (connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL] > 0);
+	(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
+	return retval;
+
+}
+
+// called by the send thread when it ends after failing to send
+// the queue stops taking packets & every waiting producer is woken up
+static void connection_send_set_failed (Connection *connection) {
+
+	(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+	connection->send_failed = true;
+	(void) pthread_cond_broadcast (&connection->send_queue_cond);
+
+	(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
+	bsem_post (connection->send_has_packets);
+
+}
+
+// wakes up anyone waiting for the control packets of the last batch
+static void connection_send_control_sent (Connection *connection) {
+
+	(void) pthread_mutex_lock (&connection->send_queue_mutex);
+
+	if (connection->send_control_sending) {
+		connection->send_control_sending = 0;
+		(void) pthread_cond_broadcast (&connection->send_queue_cond);
+	}
+
+	(void) pthread_mutex_unlock (&connection->send_queue_mutex);
+
 }
 
 void *connection_send_thread (void *client_connection_ptr) {
@@ -829,31 +2011,57 @@ void *connection_send_thread (void *client_connection_ptr) {
 		(void) strncpy (client_name, cc->client->name, THREAD_NAME_BUFFER_SIZE);
 		(void) strncpy (connection_name, cc->connection->name, THREAD_NAME_BUFFER_SIZE);
 
-		Job *job = NULL;
-		size_t sent = 0;
-		Packet *packet = NULL;
+		Job jobs[CONNECTION_SEND_QUEUE_BATCH_SIZE] = { 0 };
+		Packet *packets[CONNECTION_SEND_QUEUE_BATCH_SIZE] = { 0 };
+		unsigned int n_jobs = 0;
 		u8 failed = 0;
 		while (cc->connection->active && !failed) {
-			bsem_wait (cc->connection->send_queue->has_jobs);
+			bsem_wait (cc->connection->send_has_packets);
 
 			if (cc->connection->active) {
-				job = job_queue_pull (cc->connection->send_queue);
-				if (job) {
-					packet = (Packet *) job->args;
-
-					failed = packet_send_actual (
-						packet,
-						cc->connection->send_flags, &sent,
-						cc->client, cc->connection
+				// drain every queued packet and send them together
+				n_jobs = connection_send_queue_pull (
+					cc->connection,
+					jobs, packets, CONNECTION_SEND_QUEUE_BATCH_SIZE
+				);
+
+				if (n_jobs) {
+					failed = (
+						packet_send_batch (
+							packets, n_jobs,
+							cc->connection->send_flags,
+							cc->client, cc->connection
+						) < n_jobs
 					);
+				}
 
-					packet_delete (packet);
+				for (unsigned int i = 0; i < n_jobs; i++) {
+					packet_delete (packets[i]);
+				}
 
-					job_delete (job);
+				// wait for the parked bytes before taking more packets
+				// unless control packets are waiting to be sent after them
+				if (!failed && cc->connection->nonblocking_send) {
+					PacketSendResult result = PACKET_SEND_RESULT_QUEUED;
+					while (
+						cc->connection->active
+						&& (result == PACKET_SEND_RESULT_QUEUED)
+						&& !connection_send_queue_has_control (cc->connection)
+					) {
+						result = connection_flush (cc->connection, CONNECTION_OUTPUT_FLUSH_TIMEOUT);
+					}
+
+					failed = (result == PACKET_SEND_RESULT_ERROR);
 				}
+
+				connection_send_control_sent (cc->connection);
 			}
 		}
 
+		connection_send_control_sent (cc->connection);
+
+		if (failed) connection_send_set_failed (cc->connection);
+
 		client_connection_aux_delete (cc);
 
 		#ifdef CONNECTION_DEBUG
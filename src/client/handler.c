@@ -3,6 +3,13 @@
 #include <string.h>
 
 #include <errno.h>
+#include <time.h>
+
+#include <sys/uio.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "client/types/types.h"
 
@@ -16,9 +23,13 @@
 #include "client/events.h"
 #include "client/files.h"
 #include "client/handler.h"
+#include "client/mailbox.h"
 #include "client/network.h"
 #include "client/packets.h"
 #include "client/receive.h"
+#include "client/requests.h"
+#include "client/routes.h"
+#include "client/stats.h"
 
 #include "client/threads/jobs.h"
 #include "client/threads/thread.h"
@@ -28,11 +39,26 @@
 
 static int unique_handler_id = 0;
 
+const char *handler_queue_policy_description (
+	const HandlerQueuePolicy policy
+) {
+
+	switch (policy) {
+		#define XX(num, name, description) case HANDLER_QUEUE_POLICY_##name: return #description;
+		HANDLER_QUEUE_POLICY_MAP(XX)
+		#undef XX
+	}
+
+	return handler_queue_policy_description (HANDLER_QUEUE_POLICY_DROP_NEWEST);
+
+}
+
 static HandlerData *handler_data_new (void) {
 
 	HandlerData *handler_data = (HandlerData *) malloc (sizeof (HandlerData));
 	if (handler_data) {
 		handler_data->handler_id = 0;
+		handler_data->worker_id = 0;
 
 		handler_data->data = NULL;
 		handler_data->packet = NULL;
@@ -58,15 +84,40 @@ static Handler *handler_new (void) {
 		handler->id = -1;
 		handler->thread_id = 0;
 
+		handler->n_workers = HANDLER_DEFAULT_N_WORKERS;
+		handler->n_workers_alive = 0;
+		handler->workers = NULL;
+
 		handler->data = NULL;
 		handler->data_create = NULL;
 		handler->data_create_args = NULL;
 		handler->data_delete = NULL;
 
 		handler->handler = NULL;
+		handler->batch_handler = NULL;
+		handler->batch_size = HANDLER_DEFAULT_BATCH_SIZE;
 		handler->direct_handle = false;
 
 		handler->job_queue = NULL;
+		handler->key = NULL;
+
+		handler->conflate_key = NULL;
+		handler->mailbox = NULL;
+
+		handler->queue_limit = HANDLER_DEFAULT_QUEUE_LIMIT;
+		handler->queue_policy = HANDLER_DEFAULT_QUEUE_POLICY;
+		handler->priority = NULL;
+
+		// paused reads wait using the monotonic clock
+		pthread_condattr_t attr;
+		(void) pthread_condattr_init (&attr);
+		(void) pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+
+		handler->n_paused = 0;
+		(void) pthread_mutex_init (&handler->queue_mutex, NULL);
+		(void) pthread_cond_init (&handler->queue_cond, &attr);
+
+		(void) pthread_condattr_destroy (&attr);
 
 		handler->cerver = NULL;
 		handler->client = NULL;
@@ -81,8 +132,23 @@ void handler_delete (void *handler_ptr) {
 	if (handler_ptr) {
 		Handler *handler = (Handler *) handler_ptr;
 
+		if (handler->workers) {
+			for (unsigned int i = 0; i < handler->n_workers; i++) {
+				if (handler->workers[i].job_queue != handler->job_queue)
+					job_queue_delete (handler->workers[i].job_queue);
+			}
+
+			free (handler->workers);
+		}
+
 		job_queue_delete (handler->job_queue);
 
+		// the pending packets are only referenced by the mailbox
+		mailbox_delete (handler->mailbox);
+
+		(void) pthread_mutex_destroy (&handler->queue_mutex);
+		(void) pthread_cond_destroy (&handler->queue_cond);
+
 		free (handler_ptr);
 	}
 
@@ -159,14 +225,143 @@ void handler_set_direct_handle (Handler *handler, bool direct_handle) {
 
 }
 
+// sets a method that handles up to batch_size packets at once
+// with a HandlerBatchData instead of calling the handler method for each one
+// must be called before the handler gets registered
+void handler_set_batch_handler (
+	Handler *handler, Action batch_handler, unsigned int batch_size
+) {
+
+	if (handler) {
+		handler->batch_handler = batch_handler;
+		handler->batch_size = batch_size ? batch_size : HANDLER_DEFAULT_BATCH_SIZE;
+	}
+
+}
+
+// keeps only the latest packet of each key waiting to be handled
+// a new packet with the same key as a pending one replaces it in place
+// with many workers, the packets of each key are handled by the same worker
+// must be called before the handler gets registered
+// returns 0 on success, 1 on error
+u8 handler_set_conflate (Handler *handler, HandlerKey conflate_key) {
+
+	u8 retval = 1;
+
+	if (handler && conflate_key) {
+		if (!handler->mailbox) handler->mailbox = mailbox_create ();
+
+		if (handler->mailbox) {
+			handler->conflate_key = conflate_key;
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+// sets how many packets can wait in each of the handler's job queues
+// and what happens to the packets that arrive when a queue is full
+// if queue_limit is 0, packets are queued without limit (default)
+void handler_set_queue_limit (
+	Handler *handler,
+	size_t queue_limit, HandlerQueuePolicy queue_policy
+) {
+
+	if (handler) {
+		handler->queue_limit = queue_limit;
+		handler->queue_policy = queue_policy;
+	}
+
+}
+
+// sets the method to get the priority of the packets
+// used by HANDLER_QUEUE_POLICY_DROP_PRIORITY
+void handler_set_priority (Handler *handler, HandlerPriority priority) {
+
+	if (handler) handler->priority = priority;
+
+}
+
+// stores the handler's packets in a bounded lock-free ring
+// instead of a list, packets that don't fit are discarded
+// must be called before the handler gets registered
+// returns 0 on success, 1 on error
+u8 handler_set_ring (Handler *handler, const size_t capacity) {
+
+	return handler ?
+		(u8) job_queue_set_ring (handler->job_queue, RING_TYPE_MPMC, capacity) : 1;
+
+}
+
+// sets how many threads will handle the packets from the handler's job queue
+// each worker gets its own data from the handler's data_create () method
+// must be called before the handler gets registered
+void handler_set_workers (Handler *handler, unsigned int n_workers) {
+
+	if (handler) handler->n_workers = n_workers ? n_workers : 1;
+
+}
+
+// the key that selects the worker of a packet
+// conflating handlers always use their conflate key so a key that is
+// being handled can't have its next packet handled by another worker
+static inline HandlerKey handler_worker_key (const Handler *handler) {
+
+	return handler->conflate_key ? handler->conflate_key : handler->key;
+
+}
+
+// handles the packets with the same key in order by the same worker
+// must be called before the handler gets registered
+void handler_set_key (Handler *handler, HandlerKey key) {
+
+	if (handler) handler->key = key;
+
+}
+
+// uses the packet's request type as its key
+u64 handler_key_request_type (const Packet *packet) {
+
+	return (u64) packet->header.request_type;
+
+}
+
+// returns the packet of a pulled job
+// conflated jobs have the mailbox entry with the latest packet of their key
+static inline Packet *handler_job_packet (
+	const Handler *handler, const Job *job
+) {
+
+	return (handler->mailbox && !job->work) ?
+		mailbox_take (handler->mailbox, (MailboxEntry *) job->args) :
+		(Packet *) job->args;
+
+}
+
+// wakes up the readers that are paused waiting for room in a job queue
+static inline void handler_queue_signal (Handler *handler) {
+
+	if (__atomic_load_n (&handler->n_paused, __ATOMIC_SEQ_CST)) {
+		(void) pthread_mutex_lock (&handler->queue_mutex);
+		(void) pthread_cond_broadcast (&handler->queue_cond);
+		(void) pthread_mutex_unlock (&handler->queue_mutex);
+	}
+
+}
+
 // while client is running, check for new jobs and handle them
-static void handler_do_while_client (Handler *handler) {
+static void handler_do_while_client (HandlerWorker *worker) {
 
-	Job *job = NULL;
+	Handler *handler = worker->handler;
+
+	Job job = { 0 };
 	Packet *packet = NULL;
 	HandlerData *handler_data = handler_data_new ();
 	while (handler->client->running) {
-		bsem_wait (handler->job_queue->has_jobs);
+		bsem_wait (worker->job_queue->has_jobs);
 
 		if (handler->client->running) {
 			(void) pthread_mutex_lock (handler->client->handlers_lock);
@@ -174,17 +369,20 @@ static void handler_do_while_client (Handler *handler) {
 			(void) pthread_mutex_unlock (handler->client->handlers_lock);
 
 			// read job from queue
-			job = (Job *) job_queue_pull (handler->job_queue);
-			if (job) {
-				packet = (Packet *) job->args;
+			if (!job_queue_pull_job (worker->job_queue, &job)) {
+				handler_queue_signal (handler);
+
+				packet = handler_job_packet (handler, &job);
 
 				handler_data->handler_id = handler->id;
-				handler_data->data = handler->data;
+				handler_data->worker_id = worker->id;
+				handler_data->data = worker->data;
 				handler_data->packet = packet;
 
-				handler->handler (handler_data);
+				// a route's callback or the handler's method
+				if (job.work) job.work (handler_data);
+				else handler->handler (handler_data);
 
-				job_delete (job);
 				packet_delete (packet);
 			}
 
@@ -194,14 +392,119 @@ static void handler_do_while_client (Handler *handler) {
 		}
 	}
 
+	// wake up the next worker that is waiting for jobs so it can also stop
+	bsem_post (worker->job_queue->has_jobs);
+
 	handler_data_delete (handler_data);
 
 }
 
-static void *handler_do (void *handler_ptr) {
+// handles the batch's packets & deletes them
+static void handler_batch_handle (
+	Handler *handler, HandlerBatchData *batch_data
+) {
 
-	if (handler_ptr) {
-		Handler *handler = (Handler *) handler_ptr;
+	if (batch_data->n_packets) {
+		handler->batch_handler (batch_data);
+
+		for (unsigned int i = 0; i < batch_data->n_packets; i++)
+			packet_delete (batch_data->packets[i]);
+
+		batch_data->n_packets = 0;
+	}
+
+}
+
+// while client is running, pull many jobs at once and handle them in batches
+// jobs with their own work (routes) are handled one by one in between
+static void handler_do_while_client_batch (HandlerWorker *worker) {
+
+	Handler *handler = worker->handler;
+
+	Job *jobs = (Job *) calloc (handler->batch_size, sizeof (Job));
+	Packet **packets = (Packet **) calloc (handler->batch_size, sizeof (Packet *));
+	if (jobs && packets) {
+		unsigned int n_jobs = 0;
+
+		HandlerData handler_data = {
+			.handler_id = handler->id,
+			.worker_id = worker->id,
+			.data = worker->data,
+			.packet = NULL
+		};
+
+		HandlerBatchData batch_data = {
+			.handler_id = handler->id,
+			.worker_id = worker->id,
+			.data = worker->data,
+			.packets = packets,
+			.n_packets = 0
+		};
+
+		while (handler->client->running) {
+			bsem_wait (worker->job_queue->has_jobs);
+
+			if (handler->client->running) {
+				(void) pthread_mutex_lock (handler->client->handlers_lock);
+				handler->client->num_handlers_working += 1;
+				(void) pthread_mutex_unlock (handler->client->handlers_lock);
+
+				// read many jobs from the queue at once
+				n_jobs = job_queue_pull_jobs (
+					worker->job_queue, jobs, handler->batch_size
+				);
+
+				if (n_jobs) handler_queue_signal (handler);
+
+				for (unsigned int i = 0; i < n_jobs; i++) {
+					if (jobs[i].work) {
+						// keep the packets order
+						handler_batch_handle (handler, &batch_data);
+
+						handler_data.packet = (Packet *) jobs[i].args;
+						jobs[i].work (&handler_data);
+						packet_delete (handler_data.packet);
+					}
+
+					else {
+						packets[batch_data.n_packets] = handler_job_packet (handler, &jobs[i]);
+						batch_data.n_packets += 1;
+					}
+				}
+
+				handler_batch_handle (handler, &batch_data);
+
+				(void) pthread_mutex_lock (handler->client->handlers_lock);
+				handler->client->num_handlers_working -= 1;
+				(void) pthread_mutex_unlock (handler->client->handlers_lock);
+			}
+		}
+	}
+
+	else {
+		client_log_error (
+			"Failed to allocate handler %d worker %u batch!",
+			handler->unique_id, worker->id
+		);
+
+		// wait until the client stops to keep the workers accounting
+		while (handler->client->running)
+			bsem_wait (worker->job_queue->has_jobs);
+	}
+
+	// wake up the next worker that is waiting for jobs so it can also stop
+	bsem_post (worker->job_queue->has_jobs);
+
+	free (packets);
+	free (jobs);
+
+}
+
+static void *handler_do (void *worker_ptr) {
+
+	if (worker_ptr) {
+		HandlerWorker *worker = (HandlerWorker *) worker_ptr;
+		Handler *handler = worker->handler;
 
 		pthread_mutex_t *handlers_lock = NULL;
 		switch (handler->type) {
@@ -216,7 +519,15 @@ static void *handler_do (void *handler_ptr) {
 		if (handler->id >= 0) {
 			switch (handler->type) {
 				case HANDLER_TYPE_CLIENT:
-					(void) thread_set_name ("client-handler-%d", handler->unique_id);
+					if (handler->n_workers > 1) {
+						(void) thread_set_name (
+							"client-handler-%d-%u", handler->unique_id, worker->id
+						);
+					}
+
+					else {
+						(void) thread_set_name ("client-handler-%d", handler->unique_id);
+					}
 					break;
 				default: break;
 			}
@@ -224,8 +535,10 @@ static void *handler_do (void *handler_ptr) {
 
 		// TODO: register to signals to handle multiple actions
 
-		if (handler->data_create)
-			handler->data = handler->data_create (handler->data_create_args);
+		// each worker creates its own data
+		// or shares the one that was set directly in the handler
+		worker->data = handler->data_create ?
+			handler->data_create (handler->data_create_args) : handler->data;
 
 		// mark the handler as alive and ready
 		(void) pthread_mutex_lock (handlers_lock);
@@ -233,16 +546,28 @@ static void *handler_do (void *handler_ptr) {
 			case HANDLER_TYPE_CLIENT: handler->client->num_handlers_alive += 1; break;
 			default: break;
 		}
+
+		handler->n_workers_alive += 1;
+		if (handler->n_workers == 1) handler->data = worker->data;
 		(void) pthread_mutex_unlock (handlers_lock);
 
 		// while cerver / client is running, check for new jobs and handle them
 		switch (handler->type) {
-			case HANDLER_TYPE_CLIENT: handler_do_while_client (handler); break;
+			case HANDLER_TYPE_CLIENT:
+				if (handler->batch_handler) handler_do_while_client_batch (worker);
+				else handler_do_while_client (worker);
+				break;
 			default: break;
 		}
 
-		if (handler->data_delete)
-			handler->data_delete (handler->data);
+		// shared data is only deleted by the last worker
+		(void) pthread_mutex_lock (handlers_lock);
+		handler->n_workers_alive -= 1;
+		bool delete_data = handler->data_create || !handler->n_workers_alive;
+		(void) pthread_mutex_unlock (handlers_lock);
+
+		if (handler->data_delete && delete_data)
+			handler->data_delete (worker->data);
 
 		(void) pthread_mutex_lock (handlers_lock);
 		switch (handler->type) {
@@ -256,7 +581,26 @@ static void *handler_do (void *handler_ptr) {
 
 }
 
-// starts the new handler by creating a dedicated thread for it
+// creates a job queue for a keyed handler's worker
+// that uses the same backend as the handler's job queue
+static JobQueue *handler_worker_job_queue_create (Handler *handler) {
+
+	JobQueue *job_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+	if (job_queue && handler->job_queue->ring) {
+		if (job_queue_set_ring (
+			job_queue,
+			handler->job_queue->ring->type, handler->job_queue->ring->capacity
+		)) {
+			job_queue_delete (job_queue);
+			job_queue = NULL;
+		}
+	}
+
+	return job_queue;
+
+}
+
+// starts the new handler by creating its dedicated worker threads
 // called by internal cerver methods
 int handler_start (Handler *handler) {
 
@@ -264,20 +608,65 @@ int handler_start (Handler *handler) {
 
 	if (handler) {
 		if (handler->type != HANDLER_TYPE_NONE) {
-			if (!thread_create_detachable (
-				&handler->thread_id,
-				(void *(*)(void *)) handler_do,
-				(void *) handler
-			)) {
-				#ifdef HANDLER_DEBUG
-				client_log (
-					LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-					"Created handler %d thread!",
-					handler->unique_id
-				);
-				#endif
+			HandlerWorker *workers = (HandlerWorker *) calloc (
+				handler->n_workers, sizeof (HandlerWorker)
+			);
 
+			if (workers) {
 				retval = 0;
+
+				// every worker gets its job queue before packets can be pushed to it
+				HandlerWorker *worker = NULL;
+				for (unsigned int i = 0; i < handler->n_workers; i++) {
+					worker = &workers[i];
+					worker->id = i;
+					worker->handler = handler;
+
+					worker->job_queue = handler->job_queue;
+					if (handler_worker_key (handler) && (handler->n_workers > 1)) {
+						worker->job_queue = handler_worker_job_queue_create (handler);
+						if (!worker->job_queue) {
+							client_log_error (
+								"handler_start () - Failed to create handler %d worker %u job queue!",
+								handler->unique_id, worker->id
+							);
+
+							worker->job_queue = handler->job_queue;
+							retval = 1;
+						}
+					}
+				}
+
+				handler->workers = workers;
+
+				for (unsigned int i = 0; i < handler->n_workers; i++) {
+					worker = &workers[i];
+
+					if (!thread_create_detachable (
+						&worker->thread_id,
+						(void *(*)(void *)) handler_do,
+						(void *) worker
+					)) {
+						#ifdef HANDLER_DEBUG
+						client_log (
+							LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+							"Created handler %d worker %u thread!",
+							handler->unique_id, worker->id
+						);
+						#endif
+					}
+
+					else {
+						client_log_error (
+							"handler_start () - Failed to create handler %d worker %u thread!",
+							handler->unique_id, worker->id
+						);
+
+						retval = 1;
+					}
+				}
+
+				handler->thread_id = workers[0].thread_id;
 			}
 		}
 
@@ -293,6 +682,200 @@ int handler_start (Handler *handler) {
 
 }
 
+// wakes up every worker that is waiting for new packets
+void handler_wake_up (Handler *handler) {
+
+	if (handler) {
+		(void) pthread_mutex_lock (&handler->queue_mutex);
+		(void) pthread_cond_broadcast (&handler->queue_cond);
+		(void) pthread_mutex_unlock (&handler->queue_mutex);
+
+		bsem_post_all (handler->job_queue->has_jobs);
+
+		if (handler->workers) {
+			for (unsigned int i = 0; i < handler->n_workers; i++) {
+				if (handler->workers[i].job_queue != handler->job_queue)
+					bsem_post_all (handler->workers[i].job_queue->has_jobs);
+			}
+		}
+	}
+
+}
+
+// counts the packet as shed in the client & connection stats & deletes it
+static void handler_packet_shed (Packet *packet) {
+
+	stats_count_shed (packet->client, packet->connection, packet->header.packet_type);
+
+	packet_delete (packet);
+
+}
+
+// only a connection's own update thread can be paused
+// reactor & io_uring threads are shared by many connections,
+// and io_uring sends from other threads wait on the ring thread
+static inline bool handler_queue_can_pause (const Connection *connection) {
+
+	return !connection || (!connection->reactor_thread && !connection->uring);
+
+}
+
+// blocks the thread that reads from the packet's connection
+// until there is room in the job queue or the connection ends
+static void handler_queue_pause (
+	Handler *handler, JobQueue *job_queue, const Connection *connection
+) {
+
+	struct timespec ts = { 0 };
+
+	(void) pthread_mutex_lock (&handler->queue_mutex);
+	(void) __atomic_add_fetch (&handler->n_paused, 1, __ATOMIC_SEQ_CST);
+
+	while (
+		(job_queue_size (job_queue) >= handler->queue_limit)
+		&& handler->client->running
+		&& (!connection || connection->active)
+	) {
+		(void) clock_gettime (CLOCK_MONOTONIC, &ts);
+		ts.tv_sec += HANDLER_QUEUE_PAUSE_INTERVAL / 1000;
+		ts.tv_nsec += (HANDLER_QUEUE_PAUSE_INTERVAL % 1000) * 1000000L;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec += 1;
+			ts.tv_nsec -= 1000000000L;
+		}
+
+		(void) pthread_cond_timedwait (
+			&handler->queue_cond, &handler->queue_mutex, &ts
+		);
+	}
+
+	(void) __atomic_sub_fetch (&handler->n_paused, 1, __ATOMIC_SEQ_CST);
+	(void) pthread_mutex_unlock (&handler->queue_mutex);
+
+}
+
+// the priority used by the drop priority queue policy
+static inline u8 handler_packet_priority (
+	const Handler *handler, const Packet *packet
+) {
+
+	u8 priority = HANDLER_PRIORITY_LEVELS - 1;
+	if (
+		handler->queue_limit
+		&& (handler->queue_policy == HANDLER_QUEUE_POLICY_DROP_PRIORITY)
+		&& handler->priority
+	) {
+		priority = handler->priority (packet);
+		if (priority >= HANDLER_PRIORITY_LEVELS) priority = HANDLER_PRIORITY_LEVELS - 1;
+	}
+
+	return priority;
+
+}
+
+// applies the handler's queue policy before pushing a packet
+// returns true if the new packet should be shed
+static bool handler_queue_shed (
+	Handler *handler, JobQueue *job_queue,
+	const Connection *connection, const u8 priority
+) {
+
+	bool shed = false;
+
+	size_t size = job_queue_size (job_queue);
+	if (size >= handler->queue_limit) {
+		switch (handler->queue_policy) {
+			case HANDLER_QUEUE_POLICY_DROP_OLDEST: {
+				Job job = { 0 };
+				while (
+					(job_queue_size (job_queue) >= handler->queue_limit)
+					&& !job_queue_pull_job (job_queue, &job)
+				) {
+					handler_packet_shed (handler_job_packet (handler, &job));
+				}
+			} break;
+
+			case HANDLER_QUEUE_POLICY_PAUSE_READS:
+				if (handler_queue_can_pause (connection)) {
+					handler_queue_pause (handler, job_queue, connection);
+				}
+
+				// new packets are dropped like with DROP_NEWEST
+				else {
+					shed = true;
+				}
+				break;
+
+			default:
+				shed = true;
+				break;
+		}
+	}
+
+	// lower priorities get a smaller part of the queue
+	else if (handler->queue_policy == HANDLER_QUEUE_POLICY_DROP_PRIORITY) {
+		size_t limit = (handler->queue_limit * (priority + 1)) / HANDLER_PRIORITY_LEVELS;
+		shed = (size >= (limit ? limit : 1));
+	}
+
+	return shed;
+
+}
+
+// pushes the packet to the job queue of the worker that will handle it
+// the worker calls work instead of the handler's method if it is set
+// packets shed by the handler's queue policy are deleted
+// packets of conflating handlers replace the pending packet of their key
+// returns 0 on success, 1 on error
+u8 handler_push_packet (Handler *handler, Action work, Packet *packet) {
+
+	u8 retval = 0;
+
+	JobQueue *job_queue = handler->job_queue;
+	HandlerKey key = handler_worker_key (handler);
+	if (key && handler->workers && (handler->n_workers > 1)) {
+		job_queue = handler->workers[key (packet) % handler->n_workers].job_queue;
+	}
+
+	// the packet may be replaced & deleted by another thread
+	// as soon as it is placed in the mailbox
+	Connection *connection = packet->connection;
+	u8 priority = handler_packet_priority (handler, packet);
+
+	void *args = packet;
+	if (handler->mailbox && !work) {
+		Packet *replaced = NULL;
+		args = mailbox_put (
+			handler->mailbox, handler->conflate_key (packet), packet, &replaced
+		);
+
+		if (replaced) {
+			packet_delete (replaced);
+			return 0;
+		}
+
+		if (!args) return 1;
+	}
+
+	if (
+		handler->queue_limit
+		&& handler_queue_shed (handler, job_queue, connection, priority)
+	) {
+		handler_packet_shed (
+			(args == packet) ? packet : mailbox_take (handler->mailbox, args)
+		);
+	}
+
+	else if (job_queue_push_job (job_queue, work, args)) {
+		// the latest packet of the key is dropped as it can't be queued
+		if (args != packet) handler_packet_shed (mailbox_take (handler->mailbox, args));
+		else retval = 1;
+	}
+
+	return retval;
+
+}
+
 const char *client_handler_error_to_string (
 	const ClientHandlerError error
 ) {
@@ -694,24 +1277,29 @@ static void client_auth_packet_handler (Packet *packet) {
 // handles a PACKET_TYPE_APP packet type
 static void client_app_packet_handler (Packet *packet) {
 
-	if (packet->client->app_packet_handler) {
-		if (packet->client->app_packet_handler->direct_handle) {
-			// printf ("app_packet_handler - direct handle!\n");
-			packet->client->app_packet_handler->handler (packet);
+	// the handler that matches the packet's handler id
+	// or the client's app_packet_handler
+	Handler *handler = client_app_handlers_get (
+		packet->client, packet->header.handler_id
+	);
+
+	if (handler) {
+		if (handler->direct_handle) {
+			// printf ("app_packet_handler - direct handle!\n");
+			handler->handler (packet);
 			packet_delete (packet);
 		}
 
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->app_packet_handler->job_queue,
-				job_create (NULL, packet)
-			)) {
+			if (handler_push_packet (handler, NULL, packet)) {
 				client_log_error (
-					"Failed to push a new job to client's %s app_packet_handler!",
-					packet->client->name
+					"Failed to push a new job to client's %s app handler %d!",
+					packet->client->name, handler->id
 				);
+
+				packet_delete (packet);
 			}
 		}
 	}
@@ -721,6 +1309,8 @@ static void client_app_packet_handler (Packet *packet) {
 			"Client %s does not have a app_packet_handler!",
 			packet->client->name
 		);
+
+		packet_delete (packet);
 	}
 
 }
@@ -738,14 +1328,15 @@ static void client_app_error_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->client->app_error_packet_handler, NULL, packet
 			)) {
 				client_log_error (
 					"Failed to push a new job to client's %s app_error_packet_handler!",
 					packet->client->name
 				);
+
+				packet_delete (packet);
 			}
 		}
 	}
@@ -772,14 +1363,15 @@ static void client_custom_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->client->custom_packet_handler, NULL, packet
 			)) {
 				client_log_error (
 					"Failed to push a new job to client's %s custom_packet_handler!",
 					packet->client->name
 				);
+
+				packet_delete (packet);
 			}
 		}
 	}
@@ -793,6 +1385,38 @@ static void client_custom_packet_handler (Packet *packet) {
 
 }
 
+// handles a PACKET_TYPE_GAME packet type
+// the packet is discarded if the client does not have a game handler
+static void client_game_packet_handler (Packet *packet) {
+
+	if (packet->client->game_packet_handler) {
+		if (packet->client->game_packet_handler->direct_handle) {
+			packet->client->game_packet_handler->handler (packet);
+			packet_delete (packet);
+		}
+
+		else {
+			// add the packet to the handler's job queueu to be handled
+			// as soon as the handler is available
+			if (handler_push_packet (
+				packet->client->game_packet_handler, NULL, packet
+			)) {
+				client_log_error (
+					"Failed to push a new job to client's %s game_packet_handler!",
+					packet->client->name
+				);
+
+				packet_delete (packet);
+			}
+		}
+	}
+
+	else {
+		packet_delete (packet);
+	}
+
+}
+
 // the client handles a packet based on its type
 static ClientHandlerError client_packet_handler_actual (
 	Packet *packet
@@ -805,8 +1429,6 @@ static ClientHandlerError client_packet_handler_actual (
 
 		// handles cerver type packets
 		case PACKET_TYPE_CERVER:
-			packet->client->stats->received_packets->n_cerver_packets += 1;
-			packet->connection->stats->received_packets->n_cerver_packets += 1;
 			error = client_cerver_packet_handler (packet);
 			packet_delete (packet);
 			break;
@@ -818,67 +1440,60 @@ static ClientHandlerError client_packet_handler_actual (
 
 		// handles an error from the server
 		case PACKET_TYPE_ERROR:
-			packet->client->stats->received_packets->n_error_packets += 1;
-			packet->connection->stats->received_packets->n_error_packets += 1;
 			client_error_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles a request made from the server
 		case PACKET_TYPE_REQUEST:
-			packet->client->stats->received_packets->n_request_packets += 1;
-			packet->connection->stats->received_packets->n_request_packets += 1;
 			client_request_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles authentication packets
 		case PACKET_TYPE_AUTH:
-			packet->client->stats->received_packets->n_auth_packets += 1;
-			packet->connection->stats->received_packets->n_auth_packets += 1;
 			client_auth_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles a game packet sent from the server
 		case PACKET_TYPE_GAME:
-			packet->client->stats->received_packets->n_game_packets += 1;
-			packet->connection->stats->received_packets->n_game_packets += 1;
-			packet_delete (packet);
+			client_game_packet_handler (packet);
 			break;
 
 		// user set handler to handler app specific packets
 		case PACKET_TYPE_APP:
-			packet->client->stats->received_packets->n_app_packets += 1;
-			packet->connection->stats->received_packets->n_app_packets += 1;
-			client_app_packet_handler (packet);
+			if (
+				requests_handle_response (packet->connection->requests, packet)
+				&& routes_handle_packet (packet->client->routes, packet)
+			) {
+				client_app_packet_handler (packet);
+			}
 			break;
 
 		// user set handler to handle app specific errors
 		case PACKET_TYPE_APP_ERROR:
-			packet->client->stats->received_packets->n_app_error_packets += 1;
-			packet->connection->stats->received_packets->n_app_error_packets += 1;
-			client_app_error_packet_handler (packet);
+			if (
+				requests_handle_response (packet->connection->requests, packet)
+				&& routes_handle_packet (packet->client->routes, packet)
+			) {
+				client_app_error_packet_handler (packet);
+			}
 			break;
 
 		// custom packet hanlder
 		case PACKET_TYPE_CUSTOM:
-			packet->client->stats->received_packets->n_custom_packets += 1;
-			packet->connection->stats->received_packets->n_custom_packets += 1;
-			client_custom_packet_handler (packet);
+			if (routes_handle_packet (packet->client->routes, packet))
+				client_custom_packet_handler (packet);
 			break;
 
 		// handles a test packet form the cerver
 		case PACKET_TYPE_TEST:
-			packet->client->stats->received_packets->n_test_packets += 1;
-			packet->connection->stats->received_packets->n_test_packets += 1;
 			client_log (LOG_TYPE_TEST, LOG_TYPE_NONE, "Got a test packet from cerver");
 			packet_delete (packet);
 			break;
 
 		default:
-			packet->client->stats->received_packets->n_bad_packets += 1;
-			packet->connection->stats->received_packets->n_bad_packets += 1;
 			#ifdef CLIENT_DEBUG
 			client_log (
 				LOG_TYPE_WARNING, LOG_TYPE_NONE,
@@ -930,7 +1545,10 @@ u8 client_packet_handler (Packet *packet) {
 	u8 retval = 1;
 
 	// update general stats
-	packet->client->stats->n_packets_received += 1;
+	stats_count_received (
+		packet->client, packet->connection,
+		packet->header.packet_type, packet->header.packet_size
+	);
 
 	ClientHandlerError error = CLIENT_HANDLER_ERROR_NONE;
 	if (packet->client->check_packets) {
@@ -955,6 +1573,273 @@ u8 client_packet_handler (Packet *packet) {
 
 }
 
+// checks if the bytes at ptr can be the start of a valid packet
+// using the header sanity rules and the protocol id if packets are checked
+static bool client_receive_resync_check (
+	const ReceiveHandle *receive_handle,
+	const char *ptr, size_t available
+) {
+
+	bool retval = false;
+
+	PacketHeader header = { 0 };
+	(void) memcpy (&header, ptr, sizeof (PacketHeader));
+
+	if (
+		(header.packet_type > PACKET_TYPE_NONE)
+		&& (header.packet_type < PACKET_TYPE_BAD)
+		&& connection_packet_size_is_valid (receive_handle->connection, header.packet_size)
+	) {
+		if (receive_handle->client->check_packets) {
+			// the packet's data must start with its version
+			if (header.packet_size >= (sizeof (PacketHeader) + sizeof (PacketVersion))) {
+				if (available >= (sizeof (PacketHeader) + sizeof (PacketVersion))) {
+					PacketVersion version = { 0 };
+					(void) memcpy (
+						&version, ptr + sizeof (PacketHeader), sizeof (PacketVersion)
+					);
+
+					retval = (version.protocol_id == packets_get_protocol_id ());
+				}
+
+				// the version will be checked by the packet handler
+				else {
+					retval = true;
+				}
+			}
+		}
+
+		else {
+			retval = true;
+		}
+	}
+
+	return retval;
+
+}
+
+// returns the offset of the first valid header in the buffer
+// or size if none was found
+// only offsets with a complete header in the buffer are checked
+size_t client_receive_resync_scan (
+	const ReceiveHandle *receive_handle,
+	const char *buffer, size_t size
+) {
+
+	size_t offset = size;
+
+	if (size >= sizeof (PacketHeader)) {
+		// the last position where a complete header can start
+		size_t last = size - sizeof (PacketHeader);
+		size_t pos = 0;
+
+		#ifdef __SSE2__
+		// a header starts with its packet type as a little endian u32
+		// so only check positions with a byte in (NONE, BAD) followed by three zeroes
+		const __m128i zero = _mm_setzero_si128 ();
+		const __m128i one = _mm_set1_epi8 (1);
+		const __m128i max_type = _mm_set1_epi8 (PACKET_TYPE_BAD - 2);
+
+		__m128i b0, b1, b2, b3, type, high;
+		unsigned int mask = 0, bit = 0;
+		while ((offset == size) && ((pos + 16) <= (last + 1))) {
+			b0 = _mm_loadu_si128 ((const __m128i *) (buffer + pos));
+			b1 = _mm_loadu_si128 ((const __m128i *) (buffer + pos + 1));
+			b2 = _mm_loadu_si128 ((const __m128i *) (buffer + pos + 2));
+			b3 = _mm_loadu_si128 ((const __m128i *) (buffer + pos + 3));
+
+			// (b0 - 1) <= (BAD - 2) as unsigned bytes
+			type = _mm_cmpeq_epi8 (
+				_mm_subs_epu8 (_mm_sub_epi8 (b0, one), max_type), zero
+			);
+
+			high = _mm_and_si128 (
+				_mm_and_si128 (_mm_cmpeq_epi8 (b1, zero), _mm_cmpeq_epi8 (b2, zero)),
+				_mm_cmpeq_epi8 (b3, zero)
+			);
+
+			mask = (unsigned int) _mm_movemask_epi8 (_mm_and_si128 (type, high));
+			while (mask) {
+				bit = (unsigned int) __builtin_ctz (mask);
+				if (
+					client_receive_resync_check (
+						receive_handle, buffer + pos + bit, size - pos - bit
+					)
+				) {
+					offset = pos + bit;
+					break;
+				}
+
+				mask &= mask - 1;
+			}
+
+			pos += 16;
+		}
+		#endif
+
+		for (; (offset == size) && (pos <= last); pos++) {
+			if (client_receive_resync_check (receive_handle, buffer + pos, size - pos)) {
+				offset = pos;
+			}
+		}
+	}
+
+	return offset;
+
+}
+
+// discards bytes until the start of a valid header is found
+// the state is set back to normal if one was found in the buffer
+// if not, the bytes that can't hold a complete header are kept
+// to be scanned again with the start of the next buffer
+// returns how many bytes were consumed from the buffer
+static size_t client_receive_handle_resync (
+	ReceiveHandle *receive_handle,
+	const char *end, size_t remaining_buffer_size
+) {
+
+	size_t skipped = client_receive_resync_scan (
+		receive_handle, end, remaining_buffer_size
+	);
+
+	size_t tail_size = 0;
+	if (skipped < remaining_buffer_size) {
+		receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+	}
+
+	else {
+		tail_size = (remaining_buffer_size < sizeof (PacketHeader)) ?
+			remaining_buffer_size : sizeof (PacketHeader) - 1;
+
+		(void) memcpy (
+			receive_handle->resync_tail,
+			end + remaining_buffer_size - tail_size, tail_size
+		);
+
+		receive_handle->state = RECEIVE_HANDLE_STATE_LOST;
+	}
+
+	receive_handle->resync_tail_size = (unsigned int) tail_size;
+
+	receive_handle->connection->stats->resync_skipped_bytes += skipped - tail_size;
+
+	return skipped;
+
+}
+
+// looks for a header that starts in the bytes kept by the last resync
+// and ends in the current buffer, like a split header
+// returns how many bytes were consumed from the buffer
+static size_t client_receive_handle_resync_tail (
+	ReceiveHandle *receive_handle,
+	const char *end, size_t remaining_buffer_size
+) {
+
+	size_t consumed = 0;
+
+	// enough bytes to check every offset of the tail
+	char buffer[(sizeof (PacketHeader) * 2) + sizeof (PacketVersion)];
+
+	size_t tail_size = receive_handle->resync_tail_size;
+	size_t copied = (remaining_buffer_size < (sizeof (buffer) - tail_size)) ?
+		remaining_buffer_size : sizeof (buffer) - tail_size;
+
+	(void) memcpy (buffer, receive_handle->resync_tail, tail_size);
+	(void) memcpy (buffer + tail_size, end, copied);
+
+	size_t size = tail_size + copied;
+	size_t offset = client_receive_resync_scan (receive_handle, buffer, size);
+
+	receive_handle->resync_tail_size = 0;
+
+	if (offset < tail_size) {
+		// the header is completed with the current buffer's bytes
+		(void) memcpy (&receive_handle->header, buffer + offset, sizeof (PacketHeader));
+		consumed = (offset + sizeof (PacketHeader)) - tail_size;
+
+		receive_handle->state = RECEIVE_HANDLE_STATE_COMP_HEADER;
+
+		receive_handle->connection->stats->resync_skipped_bytes += offset;
+	}
+
+	else if ((offset == size) && (copied == remaining_buffer_size)) {
+		// the whole buffer was scanned, so keep looking in the next one
+		consumed = client_receive_handle_resync (receive_handle, buffer, size) - tail_size;
+	}
+
+	// the buffer will be scanned from its start
+	else {
+		receive_handle->connection->stats->resync_skipped_bytes += tail_size;
+	}
+
+	return consumed;
+
+}
+
+// starts streaming a packet whose data will be delivered in chunks
+static void client_receive_handle_stream_start (
+	ReceiveHandle *receive_handle, const PacketHeader *header
+) {
+
+	PacketStream *stream = &receive_handle->stream;
+
+	stream->client = receive_handle->client;
+	stream->connection = receive_handle->connection;
+
+	(void) memcpy (&stream->header, header, sizeof (PacketHeader));
+	stream->data_size = header->packet_size - sizeof (PacketHeader);
+	stream->delivered = 0;
+
+	stream->chunk = NULL;
+	stream->chunk_size = 0;
+
+	stream->done = false;
+
+	stream->data = receive_handle->connection->stream_handler_data;
+
+	receive_handle->state = RECEIVE_HANDLE_STATE_STREAM;
+
+}
+
+// delivers the stream's data that is available in the current buffer
+// returns how many bytes were consumed from the buffer
+static size_t client_receive_handle_stream (
+	ReceiveHandle *receive_handle,
+	const char *end, size_t remaining_buffer_size
+) {
+
+	PacketStream *stream = &receive_handle->stream;
+
+	size_t missing = stream->data_size - stream->delivered;
+	size_t chunk_size = (remaining_buffer_size < missing) ?
+		remaining_buffer_size : missing;
+
+	if (chunk_size) {
+		stream->chunk = end;
+		stream->chunk_size = chunk_size;
+		stream->delivered += chunk_size;
+
+		stream->done = (stream->delivered == stream->data_size);
+
+		receive_handle->connection->stream_handler (stream);
+
+		stream->chunk = NULL;
+		stream->chunk_size = 0;
+
+		if (stream->done) {
+			stats_count_received (
+				receive_handle->client, receive_handle->connection,
+				stream->header.packet_type, stream->header.packet_size
+			);
+
+			receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+		}
+	}
+
+	return chunk_size;
+
+}
+
 static void client_receive_handle_buffer_actual (
 	ReceiveHandle *receive_handle,
 	char *end, size_t buffer_pos,
@@ -963,9 +1848,12 @@ static void client_receive_handle_buffer_actual (
 
 	PacketHeader *header = NULL;
 	size_t packet_size = 0;
+	size_t data_size = 0;
 
 	Packet *packet = NULL;
 
+	size_t consumed = 0;
+
 	u8 stop_handler = 0;
 
 	#ifdef CLIENT_RECEIVE_DEBUG
@@ -1079,105 +1967,134 @@ static void client_receive_handle_buffer_actual (
 			(receive_handle->state == RECEIVE_HANDLE_STATE_NORMAL)
 			|| (receive_handle->state == RECEIVE_HANDLE_STATE_LOST)
 		) {
-			// TODO: make max value a variable
 			// check that we have a valid packet size
-			if ((packet_size > 0) && (packet_size < 65536)) {
-				// we can safely process the complete packet
-				packet = packet_create_with_data (
-					header->packet_size - sizeof (PacketHeader)
-				);
-
-				// set packet's values
-				(void) memcpy (&packet->header, header, sizeof (PacketHeader));
-				// packet->cerver = receive_handle->cerver;
-				packet->client = receive_handle->client;
-				packet->connection = receive_handle->connection;
-				// packet->lobby = receive_handle->lobby;
-
-				packet->packet_size = packet->header.packet_size;
-
-				if (packet->data_size == 0) {
-					#ifdef CLIENT_RECEIVE_DEBUG
-					(void) printf (
-						"Packet has no more data\n"
+			// streamed packets can be bigger than the max packet size
+			if (connection_packet_size_is_valid (receive_handle->connection, packet_size)) {
+				data_size = header->packet_size - sizeof (PacketHeader);
+				if (connection_packet_is_streamed (receive_handle->connection, packet_size)) {
+					// deliver the packet's data as it arrives
+					client_receive_handle_stream_start (receive_handle, header);
+
+					consumed = client_receive_handle_stream (
+						receive_handle, end, remaining_buffer_size
 					);
-					#endif
-
-					// we can safely handle the packet
-					stop_handler = client_packet_handler (packet);
 
-					#ifdef CLIENT_RECEIVE_DEBUG
-					(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
-					#endif
+					end += consumed;
+					buffer_pos += consumed;
+					remaining_buffer_size -= consumed;
 				}
 
-				// check how much of the packet's data is in the current buffer
-				else if (packet->data_size <= remaining_buffer_size) {
-					#ifdef CLIENT_RECEIVE_DEBUG
-					(void) printf (
-						"Complete packet in current buffer\n"
-					);
-					#endif
-
-					// the full packet's data is in the current buffer
-					// so we can safely copy the complete packet
-					(void) memcpy (packet->data, end, packet->data_size);
+				else {
+					// we can safely process the complete packet
+					if (
+						receive_handle->receive_buffer
+						&& (data_size > 0)
+						&& (data_size <= remaining_buffer_size)
+					) {
+						// reference the packet's data inside the receive buffer
+						packet = packet_create_with_buffer (
+							receive_handle->receive_buffer, end, data_size
+						);
+					}
 
-					// we can safely handle the packet
-					stop_handler = client_packet_handler (packet);
+					else {
+						packet = packet_create_with_data (data_size);
+					}
 
-					// update buffer positions & values
-					end += packet->data_size;
-					buffer_pos += packet->data_size;
-					remaining_buffer_size -= packet->data_size;
+					// set packet's values
+					(void) memcpy (&packet->header, header, sizeof (PacketHeader));
+					// packet->cerver = receive_handle->cerver;
+					packet->client = receive_handle->client;
+					packet->connection = receive_handle->connection;
+					// packet->lobby = receive_handle->lobby;
 
-					#ifdef CLIENT_RECEIVE_DEBUG
-					(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
-					#endif
-				}
+					packet->packet_size = packet->header.packet_size;
 
-				else {
-					// just some part of the packet's data is in the current buffer
-					// we should copy all the remaining buffer and wait for the next read
-					#ifdef CLIENT_RECEIVE_DEBUG
-					(void) printf ("RECEIVE_HANDLE_STATE_SPLIT_PACKET\n");
-					#endif
-					
-					if (remaining_buffer_size > 0) {
+					if (packet->data_size == 0) {
 						#ifdef CLIENT_RECEIVE_DEBUG
 						(void) printf (
-							"We can only get %lu / %lu from the current buffer\n",
-							remaining_buffer_size, packet->data_size
+							"Packet has no more data\n"
 						);
 						#endif
 
-						// TODO: handle errors
-						(void) packet_add_data (
-							packet, end, remaining_buffer_size
+						// we can safely handle the packet
+						stop_handler = client_packet_handler (packet);
+
+						#ifdef CLIENT_RECEIVE_DEBUG
+						(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
+						#endif
+					}
+
+					// check how much of the packet's data is in the current buffer
+					else if (packet->data_size <= remaining_buffer_size) {
+						#ifdef CLIENT_RECEIVE_DEBUG
+						(void) printf (
+							"Complete packet in current buffer\n"
 						);
+						#endif
+
+						// the full packet's data is in the current buffer
+						// so we can safely copy the complete packet
+						if (!packet->receive_buffer) {
+							(void) memcpy (packet->data, end, packet->data_size);
+						}
+
+						// we can safely handle the packet
+						stop_handler = client_packet_handler (packet);
 
 						// update buffer positions & values
 						end += packet->data_size;
 						buffer_pos += packet->data_size;
 						remaining_buffer_size -= packet->data_size;
-					}
 
-					else {
 						#ifdef CLIENT_RECEIVE_DEBUG
-						(void) printf (
-							"We have NO more data left in current buffer\n"
-						);
+						(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
 						#endif
 					}
 
-					// set the newly created packet as spare
-					receive_handle->spare_packet = packet;
-
-					receive_handle->state = RECEIVE_HANDLE_STATE_SPLIT_PACKET;
+					else {
+						// just some part of the packet's data is in the current buffer
+						// we should copy all the remaining buffer and wait for the next read
+						#ifdef CLIENT_RECEIVE_DEBUG
+						(void) printf ("RECEIVE_HANDLE_STATE_SPLIT_PACKET\n");
+						#endif
+					
+						if (remaining_buffer_size > 0) {
+							#ifdef CLIENT_RECEIVE_DEBUG
+							(void) printf (
+								"We can only get %lu / %lu from the current buffer\n",
+								remaining_buffer_size, packet->data_size
+							);
+							#endif
+
+							// TODO: handle errors
+							(void) packet_add_data (
+								packet, end, remaining_buffer_size
+							);
+
+							// update buffer positions & values
+							end += packet->data_size;
+							buffer_pos += packet->data_size;
+							remaining_buffer_size -= packet->data_size;
+						}
+
+						else {
+							#ifdef CLIENT_RECEIVE_DEBUG
+							(void) printf (
+								"We have NO more data left in current buffer\n"
+							);
+							#endif
+						}
+
+						// set the newly created packet as spare
+						receive_handle->spare_packet = packet;
+
+						receive_handle->state = RECEIVE_HANDLE_STATE_SPLIT_PACKET;
 
-					#ifdef CLIENT_RECEIVE_DEBUG
-					(void) printf ("while loop should end now!\n");
-					#endif
+						#ifdef CLIENT_RECEIVE_DEBUG
+						(void) printf ("while loop should end now!\n");
+						#endif
+					}
 				}
 			}
 
@@ -1196,10 +2113,30 @@ static void client_receive_handle_buffer_actual (
 				(void) printf ("\n\nWE ARE LOST!\n\n");
 				#endif
 
-				receive_handle->state = RECEIVE_HANDLE_STATE_LOST;
+				receive_handle->connection->stats->n_resyncs += 1;
 
-				// FIXME: this is just for testing!
-				break;
+				if (header == &receive_handle->header) {
+					// the bad header was split between buffers
+					receive_handle->connection->stats->resync_skipped_bytes +=
+						sizeof (PacketHeader);
+				}
+
+				else {
+					// look for the next header after the bad one's first byte
+					end -= sizeof (PacketHeader) - 1;
+					buffer_pos -= sizeof (PacketHeader) - 1;
+					remaining_buffer_size += sizeof (PacketHeader) - 1;
+
+					receive_handle->connection->stats->resync_skipped_bytes += 1;
+				}
+
+				consumed = client_receive_handle_resync (
+					receive_handle, end, remaining_buffer_size
+				);
+
+				end += consumed;
+				buffer_pos += consumed;
+				remaining_buffer_size -= consumed;
 			}
 		}
 
@@ -1282,6 +2219,39 @@ static void client_receive_handle_buffer (
 			#endif
 		} break;
 
+		// keep looking for a valid header
+		case RECEIVE_HANDLE_STATE_LOST: {
+			size_t skipped = client_receive_handle_resync_tail (
+				receive_handle, end, remaining_buffer_size
+			);
+
+			if (
+				(receive_handle->state == RECEIVE_HANDLE_STATE_LOST)
+				&& (skipped < remaining_buffer_size)
+			) {
+				skipped += client_receive_handle_resync (
+					receive_handle, end + skipped, remaining_buffer_size - skipped
+				);
+			}
+
+			// update buffer positions
+			end += skipped;
+			buffer_pos += skipped;
+			remaining_buffer_size -= skipped;
+		} break;
+
+		// continue delivering the packet that is being streamed
+		case RECEIVE_HANDLE_STATE_STREAM: {
+			size_t consumed = client_receive_handle_stream (
+				receive_handle, end, remaining_buffer_size
+			);
+
+			// update buffer positions
+			end += consumed;
+			buffer_pos += consumed;
+			remaining_buffer_size -= consumed;
+		} break;
+
 		// check if we have a spare packet
 		case RECEIVE_HANDLE_STATE_SPLIT_PACKET: {
 			// check if the current buffer is big enough
@@ -1376,7 +2346,7 @@ static void client_receive_handle_buffer (
 
 // handles a failed recive from a connection associatd with a client
 // end sthe connection to prevent seg faults or signals for bad sock fd
-static void client_receive_handle_failed (
+void client_receive_handle_failed (
 	Client *client, Connection *connection
 ) {
 
@@ -1391,23 +2361,15 @@ static void client_receive_handle_failed (
 
 }
 
-// performs the actual recv () method on the connection's sock fd
+// checks the result of a read from the connection's sock fd
 // handles if the receive method failed
-// the amount of bytes read from the socket is placed in rc
-ReceiveError client_receive_actual (
+static ReceiveError client_receive_result (
 	Client *client, Connection *connection,
-	char *buffer, const size_t buffer_size,
-	size_t *rc
+	const ssize_t received
 ) {
 
 	ReceiveError error = RECEIVE_ERROR_NONE;
 
-	ssize_t received = recv (
-		connection->socket->sock_fd,
-		buffer, buffer_size,
-		0
-	);
-
 	switch (received) {
 		case -1: {
 			if (errno == EAGAIN) {
@@ -1466,6 +2428,29 @@ ReceiveError client_receive_actual (
 		} break;
 	}
 
+	return error;
+
+}
+
+// performs the actual recv () method on the connection's sock fd
+// handles if the receive method failed
+// the amount of bytes read from the socket is placed in rc
+ReceiveError client_receive_actual (
+	Client *client, Connection *connection,
+	char *buffer, const size_t buffer_size,
+	size_t *rc
+) {
+
+	ssize_t received = recv (
+		connection->socket->sock_fd,
+		buffer, buffer_size,
+		0
+	);
+
+	ReceiveError error = client_receive_result (
+		client, connection, received
+	);
+
 	*rc = (size_t) ((received > 0) ? received : 0);
 
 	return error;
@@ -1522,44 +2507,145 @@ ReceiveError client_receive_data (
 
 }
 
+// handles the received bytes using the connection's receive handle state machine
+void client_receive_handle_data (
+	Client *client, Connection *connection,
+	char *buffer, const size_t buffer_size,
+	const size_t received
+) {
+
+	connection->receive_handle.buffer = buffer;
+	connection->receive_handle.buffer_size = buffer_size;
+	connection->receive_handle.received_size = received;
+
+	client_receive_handle_buffer (
+		&connection->receive_handle
+	);
+
+}
+
 #pragma GCC diagnostic pop
 
-// receive data from connection's socket
-// this method does not perform any checks and expects a valid buffer
-// to handle incomming data
-// returns 0 on success, 1 on error
-unsigned int client_receive_internal (
+// handles the bytes that were read ahead by client_connection_get_next_packet ()
+// before the connection's socket starts being read by the receive handle
+void client_receive_handle_read_ahead (
+	Client *client, Connection *connection
+) {
+
+	ReceiveHandle *receive_handle = &connection->receive_handle;
+
+	if (receive_handle->read_end > receive_handle->read_start) {
+		client_receive_handle_data (
+			client, connection,
+			receive_handle->read_buffer + receive_handle->read_start,
+			receive_handle->read_end - receive_handle->read_start,
+			receive_handle->read_end - receive_handle->read_start
+		);
+	}
+
+	receive_handle->read_start = 0;
+	receive_handle->read_end = 0;
+
+}
+
+// reads the remainder of the spare packet straight into its data
+// bytes that follow the packet are placed in the buffer and handled as usual
+// the amount of bytes read from the socket is placed in rc
+static ReceiveError client_receive_direct (
 	Client *client, Connection *connection,
-	char *buffer, const size_t buffer_size
+	char *buffer, const size_t buffer_size,
+	size_t *rc
+) {
+
+	ReceiveHandle *receive_handle = &connection->receive_handle;
+	Packet *packet = receive_handle->spare_packet;
+
+	struct iovec iov[2] = {
+		{ .iov_base = packet->data_end, .iov_len = packet->remaining_data },
+		{ .iov_base = buffer, .iov_len = buffer_size }
+	};
+
+	ssize_t received = readv (connection->socket->sock_fd, iov, 2);
+
+	ReceiveError error = client_receive_result (
+		client, connection, received
+	);
+
+	if (error == RECEIVE_ERROR_NONE) {
+		size_t packet_part = ((size_t) received < packet->remaining_data) ?
+			(size_t) received : packet->remaining_data;
+
+		packet->data_end += packet_part;
+		packet->remaining_data -= packet_part;
+
+		if (!packet->remaining_data) {
+			receive_handle->spare_packet = NULL;
+			receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+
+			// we can safely handle the packet
+			if (
+				!client_packet_handler (packet)
+				&& ((size_t) received > packet_part)
+			) {
+				client_receive_handle_data (
+					client, connection,
+					buffer, buffer_size,
+					(size_t) received - packet_part
+				);
+			}
+		}
+	}
+
+	*rc = (size_t) ((received > 0) ? received : 0);
+
+	return error;
+
+}
+
+// performs a single receive into the buffer and handles the data
+// the amount of bytes read from the socket is placed in rc
+static unsigned int client_receive_internal_actual (
+	Client *client, Connection *connection,
+	char *buffer, const size_t buffer_size,
+	size_t *rc
 ) {
 
 	unsigned int retval = 1;
 
 	size_t received = 0;
-	
-	ReceiveError error = client_receive_actual (
-		client, connection,
-		buffer, buffer_size,
-		&received
+
+	// large packets are read directly into their data
+	// instead of being copied from the buffer
+	bool direct = (
+		(connection->receive_handle.state == RECEIVE_HANDLE_STATE_SPLIT_PACKET)
+		&& connection->receive_handle.spare_packet
+		&& (connection->receive_handle.spare_packet->remaining_data > buffer_size)
 	);
 
-	client->stats->n_receives_done += 1;
-	client->stats->total_bytes_received += received;
+	ReceiveError error = direct ?
+		client_receive_direct (
+			client, connection,
+			buffer, buffer_size,
+			&received
+		) :
+		client_receive_actual (
+			client, connection,
+			buffer, buffer_size,
+			&received
+		);
 
-	#ifdef CONNECTION_STATS
-	connection->stats->n_receives_done += 1;
-	connection->stats->total_bytes_received += received;
-	#endif
+	*rc = received;
+
+	stats_count_receive (client, connection, received);
 
 	switch (error) {
 		case RECEIVE_ERROR_NONE: {
-			connection->receive_handle.buffer = buffer;
-			connection->receive_handle.buffer_size = buffer_size;
-			connection->receive_handle.received_size = received;
-
-			client_receive_handle_buffer (
-				&connection->receive_handle
-			);
+			if (!direct) {
+				client_receive_handle_data (
+					client, connection,
+					buffer, buffer_size, received
+				);
+			}
 
 			retval = 0;
 		} break;
@@ -1575,6 +2661,85 @@ unsigned int client_receive_internal (
 
 }
 
+// receive data from connection's socket
+// this method does not perform any checks and expects a valid buffer
+// to handle incomming data
+// returns 0 on success, 1 on error
+unsigned int client_receive_internal (
+	Client *client, Connection *connection,
+	char *buffer, const size_t buffer_size
+) {
+
+	size_t received = 0;
+
+	return client_receive_internal_actual (
+		client, connection,
+		buffer, buffer_size,
+		&received
+	);
+
+}
+
+// receives data from the connection's socket into a buffer taken from the pool
+// complete packets will reference the buffer instead of copying their data
+// returns 0 on success, 1 on error
+unsigned int client_receive_zero_copy (
+	Client *client, Connection *connection,
+	ReceiveBufferPool *pool
+) {
+
+	unsigned int retval = 1;
+
+	ReceiveBuffer *buffer = receive_buffer_pool_get (pool);
+	if (buffer) {
+		connection->receive_handle.receive_buffer = buffer;
+
+		retval = client_receive_internal (
+			client, connection,
+			buffer->data, buffer->size
+		);
+
+		connection->receive_handle.receive_buffer = NULL;
+
+		// packets that still need the buffer hold their own references
+		receive_buffer_unref (buffer);
+	}
+
+	else {
+		client_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+			"client_receive_zero_copy () - Failed to get a receive buffer!"
+		);
+	}
+
+	return retval;
+
+}
+
+// receives data from the connection's socket into the adaptive buffer
+// and tunes its size from the amount of data that was received
+// returns 0 on success, 1 on error
+unsigned int client_receive_adaptive (
+	Client *client, Connection *connection,
+	ReceiveAdaptive *adaptive
+) {
+
+	size_t received = 0;
+
+	unsigned int retval = client_receive_internal_actual (
+		client, connection,
+		adaptive->buffer, adaptive->buffer_size,
+		&received
+	);
+
+	if (!retval && received && connection->active) {
+		receive_adaptive_update (adaptive, connection, received);
+	}
+
+	return retval;
+
+}
+
 // allocates a new packet buffer to receive incoming data from the connection's socket
 // returns 0 on success handle
 // returns 1 if any error ocurred and must likely the connection was ended
@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/mailbox.h"
+#include "client/packets.h"
+
+static Mailbox *mailbox_new (void) {
+
+	Mailbox *mailbox = (Mailbox *) malloc (sizeof (Mailbox));
+	if (mailbox) {
+		mailbox->buckets = NULL;
+		mailbox->n_buckets = 0;
+		mailbox->n_pending = 0;
+
+		mailbox->free_entries = NULL;
+
+		mailbox->n_conflated = 0;
+
+		(void) pthread_mutex_init (&mailbox->mutex, NULL);
+	}
+
+	return mailbox;
+
+}
+
+Mailbox *mailbox_create (void) {
+
+	return mailbox_new ();
+
+}
+
+// deletes the mailbox with its pending packets
+void mailbox_delete (void *mailbox_ptr) {
+
+	if (mailbox_ptr) {
+		Mailbox *mailbox = (Mailbox *) mailbox_ptr;
+
+		MailboxEntry *entry = NULL;
+		for (size_t i = 0; i < mailbox->n_buckets; i++) {
+			while (mailbox->buckets[i]) {
+				entry = mailbox->buckets[i];
+				mailbox->buckets[i] = entry->next;
+
+				packet_delete (entry->packet);
+				free (entry);
+			}
+		}
+
+		while (mailbox->free_entries) {
+			entry = mailbox->free_entries;
+			mailbox->free_entries = entry->next;
+
+			free (entry);
+		}
+
+		free (mailbox->buckets);
+
+		(void) pthread_mutex_destroy (&mailbox->mutex);
+
+		free (mailbox_ptr);
+	}
+
+}
+
+// spreads sequential keys across the buckets
+static inline MailboxEntry **mailbox_bucket (
+	const Mailbox *mailbox, const u64 key
+) {
+
+	return &mailbox->buckets[
+		((key * 0x9E3779B97F4A7C15ULL) >> 32) & (mailbox->n_buckets - 1)
+	];
+
+}
+
+// doubles the buckets when there are more pending keys than buckets
+static u8 mailbox_grow (Mailbox *mailbox) {
+
+	size_t n_buckets = mailbox->n_buckets ?
+		mailbox->n_buckets * 2 : MAILBOX_DEFAULT_N_BUCKETS;
+
+	MailboxEntry **buckets = (MailboxEntry **) calloc (n_buckets, sizeof (MailboxEntry *));
+	if (!buckets) return 1;
+
+	MailboxEntry **old_buckets = mailbox->buckets;
+	size_t old_n_buckets = mailbox->n_buckets;
+
+	mailbox->buckets = buckets;
+	mailbox->n_buckets = n_buckets;
+
+	for (size_t i = 0; i < old_n_buckets; i++) {
+		MailboxEntry *entry = old_buckets[i];
+		while (entry) {
+			MailboxEntry *next = entry->next;
+
+			MailboxEntry **bucket = mailbox_bucket (mailbox, entry->key);
+			entry->next = *bucket;
+			*bucket = entry;
+
+			entry = next;
+		}
+	}
+
+	free (old_buckets);
+
+	return 0;
+
+}
+
+static MailboxEntry *mailbox_entry_get (Mailbox *mailbox) {
+
+	MailboxEntry *entry = mailbox->free_entries;
+	if (entry) mailbox->free_entries = entry->next;
+	else entry = (MailboxEntry *) malloc (sizeof (MailboxEntry));
+
+	return entry;
+
+}
+
+// stores the packet as the latest value of its key
+// returns the new entry that should be queued to be handled
+// returns NULL if the packet replaced a pending one, that is placed in replaced
+MailboxEntry *mailbox_put (
+	Mailbox *mailbox,
+	const u64 key, Packet *packet,
+	Packet **replaced
+) {
+
+	MailboxEntry *entry = NULL;
+	*replaced = NULL;
+
+	(void) pthread_mutex_lock (&mailbox->mutex);
+
+	MailboxEntry *pending = NULL;
+	if (mailbox->n_buckets) {
+		pending = *mailbox_bucket (mailbox, key);
+		while (pending && (pending->key != key)) pending = pending->next;
+	}
+
+	// the pending entry is already queued
+	if (pending) {
+		*replaced = pending->packet;
+		pending->packet = packet;
+
+		mailbox->n_conflated += 1;
+	}
+
+	else if ((mailbox->n_pending < mailbox->n_buckets) || !mailbox_grow (mailbox)) {
+		entry = mailbox_entry_get (mailbox);
+		if (entry) {
+			entry->key = key;
+			entry->packet = packet;
+
+			MailboxEntry **bucket = mailbox_bucket (mailbox, key);
+			entry->next = *bucket;
+			*bucket = entry;
+
+			mailbox->n_pending += 1;
+		}
+	}
+
+	(void) pthread_mutex_unlock (&mailbox->mutex);
+
+	return entry;
+
+}
+
+// removes the queued entry from the mailbox
+// returns the latest packet of its key
+Packet *mailbox_take (Mailbox *mailbox, MailboxEntry *entry) {
+
+	Packet *packet = NULL;
+
+	(void) pthread_mutex_lock (&mailbox->mutex);
+
+	MailboxEntry **link = mailbox_bucket (mailbox, entry->key);
+	while (*link && (*link != entry)) link = &(*link)->next;
+
+	if (*link) {
+		*link = entry->next;
+
+		packet = entry->packet;
+		entry->packet = NULL;
+
+		entry->next = mailbox->free_entries;
+		mailbox->free_entries = entry;
+
+		mailbox->n_pending -= 1;
+	}
+
+	(void) pthread_mutex_unlock (&mailbox->mutex);
+
+	return packet;
+
+}
+
+size_t mailbox_get_n_pending (Mailbox *mailbox) {
+
+	size_t n_pending = 0;
+
+	if (mailbox) {
+		(void) pthread_mutex_lock (&mailbox->mutex);
+		n_pending = mailbox->n_pending;
+		(void) pthread_mutex_unlock (&mailbox->mutex);
+	}
+
+	return n_pending;
+
+}
+
+u64 mailbox_get_n_conflated (Mailbox *mailbox) {
+
+	u64 n_conflated = 0;
+
+	if (mailbox) {
+		(void) pthread_mutex_lock (&mailbox->mutex);
+		n_conflated = mailbox->n_conflated;
+		(void) pthread_mutex_unlock (&mailbox->mutex);
+	}
+
+	return n_conflated;
+
+}
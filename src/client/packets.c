@@ -2,12 +2,13 @@
 #include <string.h>
 #include <stdio.h>
 
-#ifdef PACKETS_DEBUG
 #include <errno.h>
-#endif
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <pthread.h>
 
 #include "client/types/types.h"
 
@@ -15,6 +16,10 @@
 #include "client/client.h"
 #include "client/network.h"
 #include "client/packets.h"
+#include "client/receive.h"
+#include "client/socket.h"
+#include "client/stats.h"
+#include "client/uring.h"
 
 // #ifdef PACKETS_DEBUG
 #include "client/utils/log.h"
@@ -277,6 +282,321 @@ void packet_header_log (const PacketHeader *header) {
 
 #pragma endregion
 
+#pragma region pool
+
+// the last class holds the packets themselves
+#define PACKETS_POOL_PACKET_CLASS			PACKETS_POOL_N_CLASSES
+
+// each thread keeps its own cache to avoid contention
+// with the receive & handler threads
+typedef struct PacketsCache {
+
+	bool registered;
+
+	unsigned int n_items[PACKETS_POOL_N_CLASSES + 1];
+	void *items[PACKETS_POOL_N_CLASSES + 1][PACKETS_POOL_CACHE_SIZE];
+
+	PacketsPoolStats stats;
+
+	struct PacketsCache *prev;
+	struct PacketsCache *next;
+
+} PacketsCache;
+
+// freelists shared by all the threads
+// items are linked using their first bytes
+typedef struct PacketsPool {
+
+	pthread_mutex_t mutex;
+
+	unsigned int n_items[PACKETS_POOL_N_CLASSES + 1];
+	void *items[PACKETS_POOL_N_CLASSES + 1];
+
+	// stats from threads that have already ended
+	PacketsPoolStats stats;
+
+	PacketsCache *caches;
+
+} PacketsPool;
+
+static PacketsPool packets_pool = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static __thread PacketsCache packets_cache;
+
+static pthread_key_t packets_cache_key;
+static pthread_once_t packets_cache_once = PTHREAD_ONCE_INIT;
+
+static inline size_t packets_pool_class_size (const unsigned int pool_class) {
+
+	return (pool_class == PACKETS_POOL_PACKET_CLASS) ?
+		sizeof (Packet) : ((size_t) PACKETS_POOL_MIN_CLASS_SIZE << (2 * pool_class));
+
+}
+
+static inline unsigned int packets_pool_class_max (const unsigned int pool_class) {
+
+	return (unsigned int) (PACKETS_POOL_GLOBAL_SIZE / packets_pool_class_size (pool_class));
+
+}
+
+// moves items from the cache to the global pool
+// items that don't fit in the global pool are freed
+static void packets_cache_drain (
+	PacketsCache *cache, const unsigned int pool_class, unsigned int count
+) {
+
+	(void) pthread_mutex_lock (&packets_pool.mutex);
+
+	while (count-- && cache->n_items[pool_class]) {
+		void *item = cache->items[pool_class][--cache->n_items[pool_class]];
+
+		if (packets_pool.n_items[pool_class] < packets_pool_class_max (pool_class)) {
+			*(void **) item = packets_pool.items[pool_class];
+			packets_pool.items[pool_class] = item;
+			packets_pool.n_items[pool_class] += 1;
+		}
+
+		else {
+			free (item);
+		}
+	}
+
+	(void) pthread_mutex_unlock (&packets_pool.mutex);
+
+}
+
+// takes items from the global pool into the cache
+static void packets_cache_refill (
+	PacketsCache *cache, const unsigned int pool_class
+) {
+
+	(void) pthread_mutex_lock (&packets_pool.mutex);
+
+	while (
+		packets_pool.items[pool_class]
+		&& (cache->n_items[pool_class] < PACKETS_POOL_TRANSFER_SIZE)
+	) {
+		void *item = packets_pool.items[pool_class];
+		packets_pool.items[pool_class] = *(void **) item;
+		packets_pool.n_items[pool_class] -= 1;
+
+		cache->items[pool_class][cache->n_items[pool_class]++] = item;
+	}
+
+	(void) pthread_mutex_unlock (&packets_pool.mutex);
+
+}
+
+static void packets_pool_stats_add (
+	PacketsPoolStats *dest, const PacketsPoolStats *source
+) {
+
+	dest->packets_hits += __atomic_load_n (&source->packets_hits, __ATOMIC_RELAXED);
+	dest->packets_misses += __atomic_load_n (&source->packets_misses, __ATOMIC_RELAXED);
+	dest->data_hits += __atomic_load_n (&source->data_hits, __ATOMIC_RELAXED);
+	dest->data_misses += __atomic_load_n (&source->data_misses, __ATOMIC_RELAXED);
+	dest->data_oversized += __atomic_load_n (&source->data_oversized, __ATOMIC_RELAXED);
+
+}
+
+// called when a thread ends to return its cached items
+static void packets_cache_end (void *cache_ptr) {
+
+	PacketsCache *cache = (PacketsCache *) cache_ptr;
+
+	for (unsigned int i = 0; i <= PACKETS_POOL_N_CLASSES; i++)
+		packets_cache_drain (cache, i, PACKETS_POOL_CACHE_SIZE);
+
+	(void) pthread_mutex_lock (&packets_pool.mutex);
+
+	packets_pool_stats_add (&packets_pool.stats, &cache->stats);
+
+	if (cache->prev) cache->prev->next = cache->next;
+	else packets_pool.caches = cache->next;
+
+	if (cache->next) cache->next->prev = cache->prev;
+
+	(void) pthread_mutex_unlock (&packets_pool.mutex);
+
+	(void) memset (cache, 0, sizeof (PacketsCache));
+
+}
+
+static void packets_cache_key_create (void) {
+
+	(void) pthread_key_create (&packets_cache_key, packets_cache_end);
+
+}
+
+static inline PacketsCache *packets_cache_get (void) {
+
+	PacketsCache *cache = &packets_cache;
+
+	if (!cache->registered) {
+		(void) pthread_once (&packets_cache_once, packets_cache_key_create);
+		(void) pthread_setspecific (packets_cache_key, cache);
+
+		(void) pthread_mutex_lock (&packets_pool.mutex);
+
+		cache->prev = NULL;
+		cache->next = packets_pool.caches;
+		if (packets_pool.caches) packets_pool.caches->prev = cache;
+		packets_pool.caches = cache;
+
+		(void) pthread_mutex_unlock (&packets_pool.mutex);
+
+		cache->registered = true;
+	}
+
+	return cache;
+
+}
+
+static void *packets_pool_get (const unsigned int pool_class) {
+
+	void *item = NULL;
+
+	PacketsCache *cache = packets_cache_get ();
+
+	if (!cache->n_items[pool_class]) {
+		packets_cache_refill (cache, pool_class);
+	}
+
+	u64 *counter = NULL;
+	if (cache->n_items[pool_class]) {
+		item = cache->items[pool_class][--cache->n_items[pool_class]];
+
+		counter = (pool_class == PACKETS_POOL_PACKET_CLASS) ?
+			&cache->stats.packets_hits : &cache->stats.data_hits;
+	}
+
+	else {
+		item = malloc (packets_pool_class_size (pool_class));
+
+		counter = (pool_class == PACKETS_POOL_PACKET_CLASS) ?
+			&cache->stats.packets_misses : &cache->stats.data_misses;
+	}
+
+	(void) __atomic_add_fetch (counter, 1, __ATOMIC_RELAXED);
+
+	return item;
+
+}
+
+static void packets_pool_release (void *item, const unsigned int pool_class) {
+
+	PacketsCache *cache = packets_cache_get ();
+
+	if (cache->n_items[pool_class] == PACKETS_POOL_CACHE_SIZE) {
+		packets_cache_drain (cache, pool_class, PACKETS_POOL_TRANSFER_SIZE);
+	}
+
+	cache->items[pool_class][cache->n_items[pool_class]++] = item;
+
+}
+
+void *packets_pool_data_get (const size_t size, u8 *data_class) {
+
+	void *data = NULL;
+
+	unsigned int pool_class = 0;
+	while (
+		(pool_class < PACKETS_POOL_N_CLASSES)
+		&& (size > packets_pool_class_size (pool_class))
+	) {
+		pool_class += 1;
+	}
+
+	if (pool_class < PACKETS_POOL_N_CLASSES) {
+		data = packets_pool_get (pool_class);
+		*data_class = (data) ? (u8) (pool_class + 1) : 0;
+	}
+
+	else {
+		data = malloc (size);
+		*data_class = 0;
+
+		(void) __atomic_add_fetch (
+			&packets_cache_get ()->stats.data_oversized, 1, __ATOMIC_RELAXED
+		);
+	}
+
+	return data;
+
+}
+
+void packets_pool_data_release (void *data, const u8 data_class) {
+
+	if (data) {
+		if (data_class) packets_pool_release (data, (unsigned int) data_class - 1);
+		else free (data);
+	}
+
+}
+
+size_t packets_pool_data_capacity (const u8 data_class) {
+
+	return data_class ? packets_pool_class_size ((unsigned int) data_class - 1) : 0;
+
+}
+
+void packets_pool_get_stats (PacketsPoolStats *stats) {
+
+	if (stats) {
+		(void) memset (stats, 0, sizeof (PacketsPoolStats));
+
+		(void) pthread_mutex_lock (&packets_pool.mutex);
+
+		packets_pool_stats_add (stats, &packets_pool.stats);
+
+		for (PacketsCache *cache = packets_pool.caches; cache; cache = cache->next)
+			packets_pool_stats_add (stats, &cache->stats);
+
+		(void) pthread_mutex_unlock (&packets_pool.mutex);
+	}
+
+}
+
+void packets_pool_stats_print (void) {
+
+	PacketsPoolStats stats = { 0 };
+	packets_pool_get_stats (&stats);
+
+	client_log_msg ("\nPackets pool stats: ");
+	client_log_msg ("Packets hits:          %lu", stats.packets_hits);
+	client_log_msg ("Packets misses:        %lu", stats.packets_misses);
+	client_log_msg ("Data hits:             %lu", stats.data_hits);
+	client_log_msg ("Data misses:           %lu", stats.data_misses);
+	client_log_msg ("Data oversized:        %lu", stats.data_oversized);
+
+}
+
+void packets_pool_clear (void) {
+
+	PacketsCache *cache = packets_cache_get ();
+
+	for (unsigned int i = 0; i <= PACKETS_POOL_N_CLASSES; i++)
+		packets_cache_drain (cache, i, PACKETS_POOL_CACHE_SIZE);
+
+	(void) pthread_mutex_lock (&packets_pool.mutex);
+
+	for (unsigned int i = 0; i <= PACKETS_POOL_N_CLASSES; i++) {
+		while (packets_pool.items[i]) {
+			void *item = packets_pool.items[i];
+			packets_pool.items[i] = *(void **) item;
+
+			free (item);
+		}
+
+		packets_pool.n_items[i] = 0;
+	}
+
+	(void) pthread_mutex_unlock (&packets_pool.mutex);
+
+}
+
+#pragma endregion
+
 #pragma region packets
 
 u8 packet_append_data (
@@ -284,9 +604,59 @@ u8 packet_append_data (
 	const void *data, const size_t data_size
 );
 
+// the room reserved in front of the data for the packet's header
+#define PACKET_HEADROOM			sizeof (PacketHeader)
+
+// gets a data buffer with room for the packet's header in front of it
+static void *packet_data_get (
+	const size_t data_size, u8 *data_class, bool *headroom
+) {
+
+	char *buffer = (char *) packets_pool_data_get (
+		PACKET_HEADROOM + data_size, data_class
+	);
+
+	*headroom = (buffer != NULL);
+
+	return buffer ? buffer + PACKET_HEADROOM : NULL;
+
+}
+
+// releases the packet's own data buffer
+// and the generated packet if it was written in the data's headroom
+static void packet_data_release (Packet *packet) {
+
+	if (packet->data && !packet->data_ref) {
+		char *buffer = (char *) packet->data;
+		if (packet->data_headroom) {
+			buffer -= PACKET_HEADROOM;
+
+			if (packet->packet == buffer) {
+				packet->packet = NULL;
+				packet->packet_size = 0;
+			}
+		}
+
+		packets_pool_data_release (buffer, packet->data_class);
+	}
+
+	packet->data_headroom = false;
+
+}
+
+// how many data bytes fit in the packet's data buffer
+static inline size_t packet_data_capacity (const Packet *packet) {
+
+	size_t capacity = packets_pool_data_capacity (packet->data_class);
+
+	return packet->data_headroom ?
+		((capacity > PACKET_HEADROOM) ? capacity - PACKET_HEADROOM : 0) : capacity;
+
+}
+
 Packet *packet_new (void) {
 
-	Packet *packet = (Packet *) malloc (sizeof (Packet));
+	Packet *packet = (Packet *) packets_pool_get (PACKETS_POOL_PACKET_CLASS);
 	if (packet) {
 		packet->client = NULL;
 		packet->connection = NULL;
@@ -299,6 +669,10 @@ Packet *packet_new (void) {
 		packet->data_ptr = NULL;
 		packet->data_end = NULL;
 		packet->data_ref = false;
+		packet->data_class = 0;
+		packet->data_headroom = false;
+
+		packet->receive_buffer = NULL;
 
 		packet->remaining_data = 0;
 
@@ -321,6 +695,7 @@ Packet *packet_new (void) {
 		packet->packet_size = 0;
 		packet->packet = NULL;
 		packet->packet_ref = false;
+		packet->packet_class = 0;
 	}
 
 	return packet;
@@ -334,15 +709,15 @@ void packet_delete (void *packet_ptr) {
 		packet->client = NULL;
 		packet->connection = NULL;
 
-		if (!packet->data_ref) {
-			if (packet->data) free (packet->data);
-		}
+		packet_data_release (packet);
+
+		receive_buffer_unref (packet->receive_buffer);
 
 		if (!packet->packet_ref) {
-			if (packet->packet) free (packet->packet);
+			packets_pool_data_release (packet->packet, packet->packet_class);
 		}
 
-		free (packet);
+		packets_pool_release (packet, PACKETS_POOL_PACKET_CLASS);
 	}
 
 }
@@ -376,7 +751,10 @@ Packet *packet_create_with_data (
 	Packet *packet = packet_new ();
 	if (packet) {
 		if (data_size > 0) {
-			packet->data = malloc (data_size);
+			packet->data = packet_data_get (
+				data_size, &packet->data_class, &packet->data_headroom
+			);
+
 			if (packet->data) {
 				packet->data_size = data_size;
 				packet->data_end = packet->data;
@@ -394,6 +772,31 @@ Packet *packet_create_with_data (
 
 }
 
+// creates a packet whose data points to a slice of a receive buffer
+// a reference to the buffer is kept until the packet gets deleted
+Packet *packet_create_with_buffer (
+	ReceiveBuffer *buffer,
+	char *data, const size_t data_size
+) {
+
+	Packet *packet = packet_new ();
+	if (packet) {
+		if (data_size > 0) {
+			receive_buffer_ref (buffer);
+			packet->receive_buffer = buffer;
+
+			packet->data = data;
+			packet->data_size = data_size;
+			packet->data_ptr = data;
+			packet->data_end = data + data_size;
+			packet->data_ref = true;
+		}
+	}
+
+	return packet;
+
+}
+
 // sets the pakcet destinatary
 void packet_set_network_values (
 	Packet *packet,
@@ -449,7 +852,10 @@ unsigned int packet_create_data (
 	unsigned int retval = 1;
 
 	if (packet && (data_size > 0)) {
-		packet->data = malloc (data_size);
+		packet->data = packet_data_get (
+			data_size, &packet->data_class, &packet->data_headroom
+		);
+
 		if (packet->data) {
 			packet->data_size = data_size;
 			packet->data_end = packet->data;
@@ -475,12 +881,14 @@ u8 packet_set_data (
 
 	if (packet && data) {
 		// check if there was data in the packet before
-		if (!packet->data_ref) {
-			if (packet->data) free (packet->data);
-		}
+		packet_data_release (packet);
 
 		packet->data_size = data_size;
-		packet->data = malloc (packet->data_size);
+		packet->data = packet_data_get (
+			packet->data_size, &packet->data_class, &packet->data_headroom
+		);
+
+		packet->data_ref = false;
 		if (packet->data) {
 			(void) memcpy (packet->data, data, data_size);
 			packet->data_end = (char *) packet->data;
@@ -538,7 +946,22 @@ u8 packet_append_data (
 		// append the data to the end if the packet already has data
 		if (packet->data) {
 			size_t new_size = packet->data_size + data_size;
-			void *new_data = realloc (packet->data, new_size);
+
+			// the data can grow inside its class buffer
+			void *new_data = packet->data;
+			u8 new_class = packet->data_class;
+			bool new_headroom = packet->data_headroom;
+			if (packet->data_ref || (new_size > packet_data_capacity (packet))) {
+				new_data = packet_data_get (new_size, &new_class, &new_headroom);
+				if (new_data) {
+					(void) memcpy (new_data, packet->data, packet->data_size);
+
+					packet_data_release (packet);
+
+					packet->data_ref = false;
+				}
+			}
+
 			if (new_data) {
 				packet->data_end = (char *) new_data;
 				packet->data_end += packet->data_size;
@@ -549,6 +972,8 @@ u8 packet_append_data (
 
 				packet->data = new_data;
 				packet->data_size = new_size;
+				packet->data_class = new_class;
+				packet->data_headroom = new_headroom;
 
 				// point to the start of the data
 				packet->data_ptr = (char *) packet->data;
@@ -563,15 +988,16 @@ u8 packet_append_data (
 					"Failed to realloc packet data!"
 				);
 				#endif
-				packet->data = NULL;
-				packet->data_size = 0;
 			}
 		}
 
 		// if the packet is empty, create a new buffer
 		else {
 			packet->data_size = data_size;
-			packet->data = malloc (packet->data_size);
+			packet->data = packet_data_get (
+				packet->data_size, &packet->data_class, &packet->data_headroom
+			);
+
 			if (packet->data) {
 				// copy the data to the packet data buffer
 				(void) memcpy (packet->data, data, data_size);
@@ -612,11 +1038,10 @@ u8 packet_set_data_ref (
 	u8 retval = 1;
 
 	if (packet && data) {
-		if (!packet->data_ref) {
-			if (packet->data) free (packet->data);
-		}
+		packet_data_release (packet);
 
 		packet->data = data;
+		packet->data_class = 0;
 		packet->data_size = data_size;
 		packet->data_ref = true;
 
@@ -638,11 +1063,12 @@ u8 packet_set_packet (
 
 	if (packet && data) {
 		if (!packet->packet_ref) {
-			if (packet->packet) free (packet->packet);
+			packets_pool_data_release (packet->packet, packet->packet_class);
 		}
 
 		packet->packet_size = data_size;
-		packet->packet = malloc (packet->packet_size);
+		packet->packet = packets_pool_data_get (packet->packet_size, &packet->packet_class);
+		packet->packet_ref = false;
 		if (packet->packet) {
 			(void) memcpy (packet->packet, data, data_size);
 
@@ -665,10 +1091,11 @@ u8 packet_set_packet_ref (
 
 	if (packet && data) {
 		if (!packet->packet_ref) {
-			if (packet->packet) free (packet->packet);
+			packets_pool_data_release (packet->packet, packet->packet_class);
 		}
 
 		packet->packet = data;
+		packet->packet_class = 0;
 		packet->packet_size = packet_size;
 		packet->packet_ref = true;
 
@@ -687,7 +1114,10 @@ u8 packet_generate (Packet *packet) {
 
 	if (packet) {
 		if (packet->packet) {
-			free (packet->packet);
+			if (!packet->packet_ref) {
+				packets_pool_data_release (packet->packet, packet->packet_class);
+			}
+
 			packet->packet = NULL;
 			packet->packet_size = 0;
 		}
@@ -698,9 +1128,25 @@ u8 packet_generate (Packet *packet) {
 		packet->header.packet_size = packet->packet_size;
 		packet->header.request_type = packet->req_type;
 
+		// write the header in front of the data
+		if (packet->data_headroom && !packet->data_ref) {
+			packet->packet = (char *) packet->data - PACKET_HEADROOM;
+			packet->packet_ref = true;
+			packet->packet_class = 0;
+
+			(void) memcpy (packet->packet, &packet->header, sizeof (PacketHeader));
+		}
+
+		// the header is the complete packet
+		else if (!packet->data_size) {
+			packet->packet = &packet->header;
+			packet->packet_ref = true;
+			packet->packet_class = 0;
+		}
+
 		// create the packet buffer to be sent
-		packet->packet = malloc (packet->packet_size);
-		if (packet->packet) {
+		else if ((packet->packet = packets_pool_data_get (packet->packet_size, &packet->packet_class))) {
+			packet->packet_ref = false;
 			char *end = (char *) packet->packet;
 			(void) memcpy (end, &packet->header, sizeof (PacketHeader));
 
@@ -724,7 +1170,7 @@ Packet *packet_create_request (
 	const u32 request_type
 ) {
 
-	Packet *packet = (Packet *) malloc (sizeof (Packet));
+	Packet *packet = (Packet *) packets_pool_get (PACKETS_POOL_PACKET_CLASS);
 	if (packet) {
 		*packet = (Packet) {
 			.client = NULL,
@@ -738,6 +1184,10 @@ Packet *packet_create_request (
 			.data_ptr = NULL,
 			.data_end = NULL,
 			.data_ref = false,
+			.data_class = 0,
+			.data_headroom = false,
+
+			.receive_buffer = NULL,
 
 			.header = (PacketHeader) {
 				.packet_type = packet_type,
@@ -752,7 +1202,8 @@ Packet *packet_create_request (
 
 			.packet_size = sizeof (PacketHeader),
 			.packet = (void *) &packet->header,
-			.packet_ref = true
+			.packet_ref = true,
+			.packet_class = 0
 		};
 	}
 
@@ -800,16 +1251,35 @@ Packet *packet_generate_request (
 
 }
 
+// the write mutex is the one held by the caller, if any
 static inline u8 packet_send_tcp_actual (
 	const Packet *packet,
 	Connection *connection,
-	int flags, size_t *total_sent, bool raw
+	int flags, size_t *total_sent, bool raw,
+	pthread_mutex_t *write_mutex
 ) {
 
 	ssize_t sent = 0;
 	char *p = raw ? (char *) packet->data : (char *) packet->packet;
 	size_t packet_size = raw ? packet->data_size : packet->packet_size;
 
+	// sends from multiple connections are batched by the client's io_uring
+	// the ring is checked again by uring_send () as it can be unregistered
+	if (__atomic_load_n (&connection->uring, __ATOMIC_RELAXED)) {
+		UringSendResult result = uring_send (
+			connection, p, packet_size, flags, write_mutex, total_sent
+		);
+
+		if (result != URING_SEND_RESULT_UNAVAILABLE) return (u8) result;
+	}
+
+	// the bytes that don't fit in the socket are parked
+	if (connection->nonblocking_send) {
+		struct iovec iov = { .iov_base = p, .iov_len = packet_size };
+
+		return (u8) connection_output_send (connection, &iov, 1, flags, total_sent);
+	}
+
 	while (packet_size > 0) {
 		sent = send (connection->socket->sock_fd, p, packet_size, flags);
 		if (sent < 0) {
@@ -839,7 +1309,8 @@ static u8 packet_send_tcp (
 	(void) pthread_mutex_lock (connection->socket->write_mutex);
 
 	retval = packet_send_tcp_actual (
-		packet, connection, flags, total_sent, raw
+		packet, connection, flags, total_sent, raw,
+		connection->socket->write_mutex
 	);
 
 	(void) pthread_mutex_unlock (connection->socket->write_mutex);
@@ -848,63 +1319,115 @@ static u8 packet_send_tcp (
 
 }
 
-// sends a packet to the socket in two parts, first the header & then the data
+// sends all the buffers described by the iovecs using sendmsg ()
+// a partial write continues from the first byte that was not sent
 // returns 0 on success, 1 on error
-static u8 packet_send_split_tcp (
-	const Packet *packet,
-	Connection *connection,
-	int flags, size_t *total_sent
+static u8 packet_send_iovecs (
+	int sock_fd, struct iovec *iov, size_t n_iov,
+	int flags, size_t *actual_sent
 ) {
 
-	u8 retval = 1;
-
-	if (packet && connection) {
-		(void) pthread_mutex_lock (connection->socket->write_mutex);
-
-		size_t actual_sent = 0;
+	struct msghdr msg = { 0 };
+	ssize_t sent = 0;
+	size_t left = 0;
 
-		// first send the header
-		bool fail = false;
-		ssize_t sent = 0;
-		char *p = (char *) &packet->header;
-		size_t packet_size = sizeof (PacketHeader);
+	// skip any empty buffer
+	while (n_iov && !iov->iov_len) { iov++; n_iov--; }
 
-		while (packet_size > 0) {
-			sent = send (connection->socket->sock_fd, p, packet_size, flags);
-			if (sent < 0) {
-				fail = true;
-				break;
-			}
+	while (n_iov) {
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n_iov;
 
-			p += sent;
-			actual_sent += (size_t) sent;
-			packet_size -= (size_t) sent;
-			fail = false;
+		sent = sendmsg (sock_fd, &msg, flags);
+		if (sent < 0) {
+			if (errno == EINTR) continue;
+			return 1;
 		}
 
-		// now send the data
-		if (!fail) {
-			sent = 0;
-			p = (char *) packet->data;
-			packet_size = packet->data_size;
-
-			while (packet_size > 0) {
-				sent = send (connection->socket->sock_fd, p, packet_size, flags);
-				if (sent < 0) break;
-				p += sent;
-				actual_sent += (size_t) sent;
-				packet_size -= (size_t) sent;
-			}
-
-			if (total_sent) *total_sent = actual_sent;
+		*actual_sent += (size_t) sent;
 
-			retval = 0;
+		// advance past the bytes that were sent
+		left = (size_t) sent;
+		while (n_iov && (left >= iov->iov_len)) {
+			left -= iov->iov_len;
+			iov++;
+			n_iov--;
 		}
 
-		(void) pthread_mutex_unlock (connection->socket->write_mutex);
+		if (n_iov) {
+			iov->iov_base = (char *) iov->iov_base + left;
+			iov->iov_len -= left;
+		}
 	}
 
-	return retval;
+	return 0;
+
+}
+
+// sends the iovecs to the connection's socket
+// the bytes that don't fit in the socket are parked if it is non-blocking
+// returns 0 on success, 1 on error
+static u8 packet_send_connection_iovecs (
+	Connection *connection, struct iovec *iov, size_t n_iov,
+	int flags, size_t *actual_sent
+) {
+
+	if (connection->nonblocking_send) {
+		size_t sent = 0;
+		PacketSendResult result = connection_output_send (
+			connection, iov, n_iov, flags, &sent
+		);
+
+		*actual_sent += sent;
+
+		return (result == PACKET_SEND_RESULT_ERROR);
+	}
+
+	return packet_send_iovecs (
+		connection->socket->sock_fd, iov, n_iov, flags, actual_sent
+	);
+
+}
+
+// sends a packet to the socket in two parts, first the header & then the data
+// both parts are written with a single sendmsg ()
+// returns 0 on success, 1 on error
+static u8 packet_send_split_tcp (
+	const Packet *packet,
+	Connection *connection,
+	int flags, size_t *total_sent
+) {
+
+	u8 retval = 1;
+
+	if (packet && connection) {
+		(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+		size_t actual_sent = 0;
+
+		struct iovec iov[2] = {
+			{ .iov_base = (void *) &packet->header, .iov_len = sizeof (PacketHeader) },
+			{ .iov_base = packet->data, .iov_len = packet->data ? packet->data_size : 0 }
+		};
+
+		if (connection->nonblocking_send) {
+			retval = (u8) connection_output_send (
+				connection, iov, 2, flags, &actual_sent
+			);
+		}
+
+		else if (!packet_send_iovecs (
+			connection->socket->sock_fd, iov, 2, flags, &actual_sent
+		)) {
+			retval = 0;
+		}
+
+		if (total_sent) *total_sent = actual_sent;
+
+		(void) pthread_mutex_unlock (connection->socket->write_mutex);
+	}
+
+	return retval;
 
 }
 
@@ -919,100 +1442,196 @@ static u8 packet_send_split_tcp (
 // }
 // #pragma GCC diagnostic pop
 
-static void packet_send_update_stats (
+static inline void packet_send_update_stats (
 	PacketType packet_type, size_t sent,
 	Client *client, Connection *connection
 ) {
 
-	if (client) {
-		client->stats->n_packets_sent += 1;
-		client->stats->total_bytes_sent += sent;
+	stats_count_sent (client, connection, packet_type, sent);
+
+}
+
+u8 packet_send_actual (
+	const Packet *packet,
+	int flags, size_t *total_sent,
+	Client *client, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (packet_send_tcp_actual (
+		packet, connection, flags, total_sent, false, NULL
+	) != PACKET_SEND_RESULT_ERROR) {
+		packet_send_update_stats (
+			packet->packet_type, *total_sent,
+			client, connection
+		);
+
+		retval = 0;
 	}
 
-	connection->stats->n_packets_sent += 1;
-	connection->stats->total_bytes_sent += sent;
+	return retval;
 
-	switch (packet_type) {
-		case PACKET_TYPE_NONE: break;
+}
 
-		case PACKET_TYPE_CERVER:
-			if (client) client->stats->sent_packets->n_cerver_packets += 1;
-			connection->stats->sent_packets->n_cerver_packets += 1;
-			break;
+static size_t packet_send_batch_actual (
+	Packet **packets, const size_t n_packets, int flags,
+	Client *client, Connection *connection
+) {
 
-		case PACKET_TYPE_CLIENT:
-			if (client) client->stats->sent_packets->n_client_packets += 1;
-			connection->stats->sent_packets->n_client_packets += 1;
-			break;
+	struct iovec iov[PACKETS_SEND_BATCH_MAX_IOVECS];
+	struct msghdr msg = { 0 };
 
-		case PACKET_TYPE_ERROR:
-			if (client) client->stats->sent_packets->n_error_packets += 1;
-			connection->stats->sent_packets->n_error_packets += 1;
-			break;
+	size_t n_sent = 0;          // packets that have been completely sent
+	size_t offset = 0;          // bytes of the next packet that have been sent
 
-		case PACKET_TYPE_REQUEST:
-			if (client) client->stats->sent_packets->n_request_packets += 1;
-			connection->stats->sent_packets->n_request_packets += 1;
-			break;
+	size_t n_iov = 0, bytes = 0, idx = 0, left = 0, remaining = 0;
+	ssize_t sent = 0;
 
-		case PACKET_TYPE_AUTH:
-			if (client) client->stats->sent_packets->n_auth_packets += 1;
-			connection->stats->sent_packets->n_auth_packets += 1;
-			break;
+	while (n_sent < n_packets) {
+		// fill the iovecs up to the batch budget
+		n_iov = 0;
+		bytes = 0;
+		for (
+			idx = n_sent;
+			(idx < n_packets) && (n_iov < PACKETS_SEND_BATCH_MAX_IOVECS);
+			idx++
+		) {
+			remaining = packets[idx]->packet_size - ((idx == n_sent) ? offset : 0);
+			if (n_iov && ((bytes + remaining) > PACKETS_SEND_BATCH_MAX_BYTES)) break;
+
+			iov[n_iov].iov_base = (char *) packets[idx]->packet
+				+ ((idx == n_sent) ? offset : 0);
+			iov[n_iov].iov_len = remaining;
+
+			n_iov += 1;
+			bytes += remaining;
+		}
 
-		case PACKET_TYPE_GAME:
-			if (client) client->stats->sent_packets->n_game_packets += 1;
-			connection->stats->sent_packets->n_game_packets += 1;
-			break;
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n_iov;
 
-		case PACKET_TYPE_APP:
-			if (client) client->stats->sent_packets->n_app_packets += 1;
-			connection->stats->sent_packets->n_app_packets += 1;
+		sent = sendmsg (connection->socket->sock_fd, &msg, flags);
+		if (sent < 0) {
+			if (errno == EINTR) continue;
 			break;
+		}
 
-		case PACKET_TYPE_APP_ERROR:
-			if (client) client->stats->sent_packets->n_app_error_packets += 1;
-			connection->stats->sent_packets->n_app_error_packets += 1;
-			break;
+		// advance past the packets that were completely sent
+		left = (size_t) sent;
+		while (left && (n_sent < n_packets)) {
+			remaining = packets[n_sent]->packet_size - offset;
+			if (left >= remaining) {
+				left -= remaining;
 
-		case PACKET_TYPE_CUSTOM:
-			if (client) client->stats->sent_packets->n_custom_packets += 1;
-			connection->stats->sent_packets->n_custom_packets += 1;
-			break;
+				packet_send_update_stats (
+					packets[n_sent]->packet_type, packets[n_sent]->packet_size,
+					client, connection
+				);
 
-		case PACKET_TYPE_TEST:
-			if (client) client->stats->sent_packets->n_test_packets += 1;
-			connection->stats->sent_packets->n_test_packets += 1;
-			break;
+				n_sent += 1;
+				offset = 0;
+			}
 
-		default:
-			if (client) client->stats->sent_packets->n_unknown_packets += 1;
-			connection->stats->sent_packets->n_unknown_packets += 1;
-			break;
+			else {
+				offset += left;
+				left = 0;
+			}
+		}
 	}
 
+	return n_sent;
+
 }
 
-u8 packet_send_actual (
-	const Packet *packet,
-	int flags, size_t *total_sent,
+// sends the packets without blocking in groups of iovecs
+// stats are updated for every packet that was sent or parked
+static size_t packet_send_batch_nonblocking (
+	Packet **packets, const size_t n_packets, int flags,
 	Client *client, Connection *connection
 ) {
 
-	u8 retval = 1;
+	struct iovec iov[PACKETS_SEND_BATCH_MAX_IOVECS];
+
+	size_t n_sent = 0, n_iov = 0, sent = 0;
+	while (n_sent < n_packets) {
+		for (n_iov = 0; ((n_sent + n_iov) < n_packets) && (n_iov < PACKETS_SEND_BATCH_MAX_IOVECS); n_iov++) {
+			iov[n_iov].iov_base = packets[n_sent + n_iov]->packet;
+			iov[n_iov].iov_len = packets[n_sent + n_iov]->packet_size;
+		}
+
+		if (connection_output_send (
+			connection, iov, n_iov, flags, &sent
+		) == PACKET_SEND_RESULT_ERROR) break;
 
-	if (!packet_send_tcp_actual (
-		packet, connection, flags, total_sent, false
-	)) {
+		for (size_t i = 0; i < n_iov; i++, n_sent++) {
+			packet_send_update_stats (
+				packets[n_sent]->packet_type, packets[n_sent]->packet_size,
+				client, connection
+			);
+		}
+	}
+
+	return n_sent;
+
+}
+
+// sends the packets one by one through the connection's io_uring
+// the write mutex is released while waiting for the ring
+static size_t packet_send_batch_uring (
+	Packet **packets, const size_t n_packets, int flags,
+	Client *client, Connection *connection
+) {
+
+	size_t n_sent = 0, sent = 0;
+	while (
+		(n_sent < n_packets)
+		&& (packet_send_tcp_actual (
+			packets[n_sent], connection, flags, &sent, false,
+			connection->socket->write_mutex
+		) != PACKET_SEND_RESULT_ERROR)
+	) {
 		packet_send_update_stats (
-			packet->packet_type, *total_sent,
+			packets[n_sent]->packet_type, sent,
 			client, connection
 		);
 
-		retval = 0;
+		n_sent += 1;
 	}
 
-	return retval;
+	return n_sent;
+
+}
+
+// sends the packets in order using as few sendmsg () calls as possible
+// a partial write continues from the first byte that was not sent
+// stats are updated for every packet that was completely sent
+// returns the number of packets that were completely sent
+size_t packet_send_batch (
+	Packet **packets, const size_t n_packets, int flags,
+	Client *client, Connection *connection
+) {
+
+	size_t n_sent = 0;
+
+	if (packets && connection) {
+		(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+		// sends through the client's io_uring are already batched
+		if (__atomic_load_n (&connection->uring, __ATOMIC_RELAXED)) {
+			n_sent = packet_send_batch_uring (packets, n_packets, flags, client, connection);
+		}
+
+		else {
+			n_sent = connection->nonblocking_send ?
+				packet_send_batch_nonblocking (packets, n_packets, flags, client, connection)
+				: packet_send_batch_actual (packets, n_packets, flags, client, connection);
+		}
+
+		(void) pthread_mutex_unlock (connection->socket->write_mutex);
+	}
+
+	return n_sent;
 
 }
 
@@ -1030,9 +1649,11 @@ static inline u8 packet_send_internal (
 			case PROTOCOL_TCP: {
 				size_t sent = 0;
 
-				if (!(split ? packet_send_split_tcp (packet, connection, flags, &sent)
-					: unsafe ? packet_send_tcp_actual (packet, connection, flags, &sent, raw) 
+				// queued bytes will be sent when the socket becomes writable
+				if ((split ? packet_send_split_tcp (packet, connection, flags, &sent)
+					: unsafe ? packet_send_tcp_actual (packet, connection, flags, &sent, raw, NULL) 
 						: packet_send_tcp (packet, connection, flags, &sent, raw))
+					!= PACKET_SEND_RESULT_ERROR
 				) {
 					if (total_sent) *total_sent = sent;
 
@@ -1051,8 +1672,7 @@ static inline u8 packet_send_internal (
 					printf ("\n");
 					#endif
 
-					if (client) client->stats->sent_packets->n_bad_packets += 1;
-					if (connection) connection->stats->sent_packets->n_bad_packets += 1;
+					stats_count_send_failed (client, connection);
 
 					if (total_sent) *total_sent = 0;
 				}
@@ -1084,6 +1704,56 @@ u8 packet_send (
 
 }
 
+const char *packet_send_result_to_string (
+	const PacketSendResult result
+) {
+
+	switch (result) {
+		#define XX(num, name, string) case PACKET_SEND_RESULT_##name: return #string;
+		PACKET_SEND_RESULT_MAP(XX)
+		#undef XX
+	}
+
+	return packet_send_result_to_string (PACKET_SEND_RESULT_ERROR);
+
+}
+
+// sends a packet using its network values without blocking
+// the bytes that the socket can't take are parked in the connection's
+// output buffer and will be sent when the socket becomes writable
+// returns PACKET_SEND_RESULT_QUEUED if some bytes are still pending
+PacketSendResult packet_send_nonblocking (
+	const Packet *packet, int flags, size_t *total_sent
+) {
+
+	PacketSendResult result = PACKET_SEND_RESULT_ERROR;
+
+	if (packet && packet->connection && packet->packet) {
+		Connection *connection = packet->connection;
+
+		struct iovec iov = { .iov_base = packet->packet, .iov_len = packet->packet_size };
+		size_t sent = 0;
+
+		(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+		result = connection_output_send (connection, &iov, 1, flags, &sent);
+
+		(void) pthread_mutex_unlock (connection->socket->write_mutex);
+
+		if (result != PACKET_SEND_RESULT_ERROR) {
+			packet_send_update_stats (
+				packet->packet_type, sent,
+				packet->client, connection
+			);
+		}
+
+		if (total_sent) *total_sent = sent;
+	}
+
+	return result;
+
+}
+
 // works just as packet_send () but the socket's write mutex won't be locked
 // useful when you need to lock the mutex manually
 // returns 0 on success, 1 on error
@@ -1153,33 +1823,6 @@ u8 packet_send_to_split (
 
 }
 
-static u8 packet_send_pieces_actual (
-	Socket *socket,
-	char *data, size_t data_size,
-	int flags,
-	size_t *actual_sent
-) {
-
-	u8 retval = 0;
-
-	ssize_t sent = 0;
-	char *p = data;
-	while (data_size > 0) {
-		sent = send (socket->sock_fd, p, data_size, flags);
-		if (sent < 0) {
-			retval = 1;
-			break;
-		}
-
-		p += sent;
-		*actual_sent += (size_t) sent;
-		data_size -= (size_t) sent;
-	}
-
-	return retval;
-
-}
-
 // sends a packet in pieces, taking the header from the packet's field
 // sends each buffer as they are with they respective sizes
 // socket mutex will be locked for the entire operation
@@ -1198,24 +1841,38 @@ u8 packet_send_pieces (
 
 		size_t actual_sent = 0;
 
-		// first send the header
-		if (!packet_send_pieces_actual (
-			packet->connection->socket,
-			(char *) &packet->header, sizeof (PacketHeader),
-			flags,
-			&actual_sent
-		)) {
-			// send the pieces of data
-			for (u32 i = 0; i < n_pieces; i++) {
-				(void) packet_send_pieces_actual (
-					packet->connection->socket,
-					(char *) pieces[i], sizes[i],
-					flags,
-					&actual_sent
-				);
+		// the header and the pieces are sent using as few sendmsg () as possible
+		struct iovec iov[PACKETS_SEND_BATCH_MAX_IOVECS];
+		size_t n_iov = 0;
+
+		iov[n_iov].iov_base = (void *) &packet->header;
+		iov[n_iov].iov_len = sizeof (PacketHeader);
+		n_iov += 1;
+
+		retval = 0;
+		for (u32 i = 0; i < n_pieces; i++) {
+			iov[n_iov].iov_base = pieces[i];
+			iov[n_iov].iov_len = sizes[i];
+			n_iov += 1;
+
+			if (n_iov == PACKETS_SEND_BATCH_MAX_IOVECS) {
+				if (packet_send_connection_iovecs (
+					packet->connection,
+					iov, n_iov, flags, &actual_sent
+				)) {
+					retval = 1;
+					break;
+				}
+
+				n_iov = 0;
 			}
+		}
 
-			retval = 0;
+		if (!retval && n_iov) {
+			retval = packet_send_connection_iovecs (
+				packet->connection,
+				iov, n_iov, flags, &actual_sent
+			);
 		}
 
 		packet_send_update_stats (
@@ -1269,12 +1926,12 @@ u8 packet_send_to_socket (
 
 }
 
-// sends a packet of selected types without any data
-// returns 0 on success, 1 on error
-u8 packet_send_request (
+// control requests are sent using the connection's control lane
+static u8 packet_send_request_internal (
 	const PacketType packet_type,
 	const u32 request_type,
-	Client *client, Connection *connection
+	Client *client, Connection *connection,
+	const bool control
 ) {
 
 	u8 retval = 1;
@@ -1291,6 +1948,10 @@ u8 packet_send_request (
 		.data_ptr = NULL,
 		.data_end = NULL,
 		.data_ref = false,
+		.data_class = 0,
+		.data_headroom = false,
+
+		.receive_buffer = NULL,
 
 		.header = (PacketHeader) {
 			.packet_type = packet_type,
@@ -1313,11 +1974,16 @@ u8 packet_send_request (
 
 		.packet_size = sizeof (PacketHeader),
 		.packet = (void *) &request.header,
-		.packet_ref = true
+		.packet_ref = true,
+		.packet_class = 0
 	};
 
 	size_t sent = 0;
-	if (!packet_send (&request, 0, &sent, false)) {
+	if (control) {
+		retval = connection_send_control_packet (connection, &request, false);
+	}
+
+	else if (!packet_send (&request, 0, &sent, false)) {
 		if (sent == sizeof (PacketHeader)) {
 			retval = 0;
 		}
@@ -1327,15 +1993,33 @@ u8 packet_send_request (
 
 }
 
+// sends a packet of selected types without any data
+// returns 0 on success, 1 on error
+u8 packet_send_request (
+	const PacketType packet_type,
+	const u32 request_type,
+	Client *client, Connection *connection
+) {
+
+	return packet_send_request_internal (
+		packet_type, request_type,
+		client, connection,
+		false
+	);
+
+}
+
 // sends a ping packet (PACKET_TYPE_TEST)
+// it goes before the packets queued in the connection's send queue
 // returns 0 on success, 1 on error
 u8 packet_send_ping (
 	Client *client, Connection *connection
 ) {
 
-	return packet_send_request (
+	return packet_send_request_internal (
 		PACKET_TYPE_TEST, 0,
-		client, connection
+		client, connection,
+		true
 	);
 
 }
@@ -1379,4 +2063,410 @@ bool packet_check (const Packet *packet) {
 
 }
 
+#pragma endregion
+
+#pragma region writer
+
+// grows the packet's own data to hold at least capacity bytes
+static u8 packet_writer_grow (PacketWriter *writer, size_t capacity) {
+
+	Packet *packet = writer->packet;
+
+	u8 new_class = 0;
+	bool new_headroom = false;
+	char *new_data = (char *) packet_data_get (capacity, &new_class, &new_headroom);
+	if (!new_data) return 1;
+
+	size_t read_offset = packet->data_ptr ?
+		(size_t) (packet->data_ptr - (char *) packet->data) : 0;
+
+	if (packet->data_size) {
+		(void) memcpy (new_data, packet->data, packet->data_size);
+	}
+
+	packet_data_release (packet);
+
+	packet->data = new_data;
+	packet->data_ref = false;
+	packet->data_class = new_class;
+	packet->data_headroom = new_headroom;
+	packet->data_ptr = new_data + read_offset;
+	packet->data_end = new_data + packet->data_size;
+
+	writer->capacity = new_class ? packet_data_capacity (packet) : capacity;
+
+	return 0;
+
+}
+
+u8 packet_writer_init (
+	PacketWriter *writer, Packet *packet, const size_t size_hint
+) {
+
+	u8 retval = 1;
+
+	if (writer && packet) {
+		writer->packet = packet;
+		writer->error = false;
+
+		// referenced data is copied the first time it has to grow
+		if (packet->data && !packet->data_ref) {
+			writer->capacity = packet->data_class ?
+				packet_data_capacity (packet) : packet->data_size;
+		}
+
+		else {
+			writer->capacity = 0;
+		}
+
+		if (packet->data) {
+			if (!packet->data_ptr) packet->data_ptr = (char *) packet->data;
+			packet->data_end = (char *) packet->data + packet->data_size;
+		}
+
+		retval = packet_writer_reserve (writer, size_hint);
+	}
+
+	return retval;
+
+}
+
+u8 packet_writer_reserve (
+	PacketWriter *writer, const size_t size
+) {
+
+	if (!writer || writer->error) return 1;
+
+	Packet *packet = writer->packet;
+
+	size_t needed = packet->data_size + size;
+	if (
+		(needed > writer->capacity)
+		|| (packet->data_ref && size)
+	) {
+		size_t capacity = writer->capacity * 2;
+		if (capacity < needed) capacity = needed;
+		if (capacity < PACKETS_POOL_MIN_CLASS_SIZE) capacity = PACKETS_POOL_MIN_CLASS_SIZE;
+
+		if (packet_writer_grow (writer, capacity)) {
+			writer->error = true;
+			return 1;
+		}
+	}
+
+	return 0;
+
+}
+
+// writes the value's lower size bytes in network byte order
+static inline u8 packet_writer_put_uint (
+	PacketWriter *writer, const u64 value, const unsigned int size
+) {
+
+	if (packet_writer_reserve (writer, size)) return 1;
+
+	Packet *packet = writer->packet;
+	u8 *end = (u8 *) packet->data_end;
+	for (unsigned int i = 0; i < size; i++) {
+		end[i] = (u8) (value >> (8 * (size - 1 - i)));
+	}
+
+	packet->data_end += size;
+	packet->data_size += size;
+
+	return 0;
+
+}
+
+u8 packet_writer_put_u8 (PacketWriter *writer, const u8 value) {
+
+	return packet_writer_put_uint (writer, value, sizeof (u8));
+
+}
+
+u8 packet_writer_put_u16 (PacketWriter *writer, const u16 value) {
+
+	return packet_writer_put_uint (writer, value, sizeof (u16));
+
+}
+
+u8 packet_writer_put_u32 (PacketWriter *writer, const u32 value) {
+
+	return packet_writer_put_uint (writer, value, sizeof (u32));
+
+}
+
+u8 packet_writer_put_u64 (PacketWriter *writer, const u64 value) {
+
+	return packet_writer_put_uint (writer, value, sizeof (u64));
+
+}
+
+u8 packet_writer_put_i8 (PacketWriter *writer, const i8 value) {
+
+	return packet_writer_put_uint (writer, (u8) value, sizeof (i8));
+
+}
+
+u8 packet_writer_put_i16 (PacketWriter *writer, const i16 value) {
+
+	return packet_writer_put_uint (writer, (u16) value, sizeof (i16));
+
+}
+
+u8 packet_writer_put_i32 (PacketWriter *writer, const i32 value) {
+
+	return packet_writer_put_uint (writer, (u32) value, sizeof (i32));
+
+}
+
+u8 packet_writer_put_i64 (PacketWriter *writer, const i64 value) {
+
+	return packet_writer_put_uint (writer, (u64) value, sizeof (i64));
+
+}
+
+u8 packet_writer_put_bytes (
+	PacketWriter *writer, const void *data, const size_t size
+) {
+
+	if (!size) return (writer && !writer->error) ? 0 : 1;
+	if (!data || packet_writer_reserve (writer, size)) return 1;
+
+	Packet *packet = writer->packet;
+	(void) memcpy (packet->data_end, data, size);
+
+	packet->data_end += size;
+	packet->data_size += size;
+
+	return 0;
+
+}
+
+u8 packet_writer_put_string (
+	PacketWriter *writer, const char *string
+) {
+
+	return packet_writer_put_blob (
+		writer, string, string ? (u32) strlen (string) : 0
+	);
+
+}
+
+u8 packet_writer_put_blob (
+	PacketWriter *writer, const void *data, const u32 size
+) {
+
+	// a single reserve for the prefix and the data
+	if (packet_writer_reserve (writer, sizeof (u32) + size)) return 1;
+
+	if (packet_writer_put_u32 (writer, size)) return 1;
+
+	return packet_writer_put_bytes (writer, data, size);
+
+}
+
+u8 packet_writer_finish (PacketWriter *writer) {
+
+	u8 retval = 1;
+
+	if (writer && !writer->error) {
+		Packet *packet = writer->packet;
+		if (packet->data && !packet->data_ptr) {
+			packet->data_ptr = (char *) packet->data;
+		}
+
+		retval = packet_generate (packet);
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region reader
+
+void packet_reader_init (
+	PacketReader *reader, Packet *packet
+) {
+
+	if (reader && packet) {
+		reader->packet = packet;
+		reader->error = false;
+
+		if (!packet->data_ptr) packet->data_ptr = (char *) packet->data;
+		if (!packet->data_end) packet->data_end = packet->data_ptr;
+	}
+
+}
+
+size_t packet_reader_remaining (const PacketReader *reader) {
+
+	return (reader && !reader->error) ?
+		(size_t) (reader->packet->data_end - reader->packet->data_ptr) : 0;
+
+}
+
+// checks that size bytes can be read
+static inline u8 packet_reader_check (
+	PacketReader *reader, const size_t size
+) {
+
+	if (!reader || reader->error) return 1;
+
+	if (size > (size_t) (reader->packet->data_end - reader->packet->data_ptr)) {
+		reader->error = true;
+		return 1;
+	}
+
+	return 0;
+
+}
+
+// reads size bytes in network byte order
+static inline u8 packet_reader_get_uint (
+	PacketReader *reader, u64 *value, const unsigned int size
+) {
+
+	if (packet_reader_check (reader, size)) return 1;
+
+	const u8 *ptr = (const u8 *) reader->packet->data_ptr;
+	u64 result = 0;
+	for (unsigned int i = 0; i < size; i++) {
+		result = (result << 8) | ptr[i];
+	}
+
+	reader->packet->data_ptr += size;
+	*value = result;
+
+	return 0;
+
+}
+
+u8 packet_reader_get_u8 (PacketReader *reader, u8 *value) {
+
+	u64 result = 0;
+	if (!value || packet_reader_get_uint (reader, &result, sizeof (u8))) return 1;
+	*value = (u8) result;
+
+	return 0;
+
+}
+
+u8 packet_reader_get_u16 (PacketReader *reader, u16 *value) {
+
+	u64 result = 0;
+	if (!value || packet_reader_get_uint (reader, &result, sizeof (u16))) return 1;
+	*value = (u16) result;
+
+	return 0;
+
+}
+
+u8 packet_reader_get_u32 (PacketReader *reader, u32 *value) {
+
+	u64 result = 0;
+	if (!value || packet_reader_get_uint (reader, &result, sizeof (u32))) return 1;
+	*value = (u32) result;
+
+	return 0;
+
+}
+
+u8 packet_reader_get_u64 (PacketReader *reader, u64 *value) {
+
+	if (!value) return 1;
+
+	return packet_reader_get_uint (reader, value, sizeof (u64));
+
+}
+
+u8 packet_reader_get_i8 (PacketReader *reader, i8 *value) {
+
+	return packet_reader_get_u8 (reader, (u8 *) value);
+
+}
+
+u8 packet_reader_get_i16 (PacketReader *reader, i16 *value) {
+
+	return packet_reader_get_u16 (reader, (u16 *) value);
+
+}
+
+u8 packet_reader_get_i32 (PacketReader *reader, i32 *value) {
+
+	return packet_reader_get_u32 (reader, (u32 *) value);
+
+}
+
+u8 packet_reader_get_i64 (PacketReader *reader, i64 *value) {
+
+	return packet_reader_get_u64 (reader, (u64 *) value);
+
+}
+
+u8 packet_reader_get_bytes (
+	PacketReader *reader, void *buffer, const size_t size
+) {
+
+	if (!buffer || packet_reader_check (reader, size)) return 1;
+
+	(void) memcpy (buffer, reader->packet->data_ptr, size);
+	reader->packet->data_ptr += size;
+
+	return 0;
+
+}
+
+u8 packet_reader_get_string (
+	PacketReader *reader, char *buffer, const size_t buffer_size
+) {
+
+	const void *data = NULL;
+	u32 size = 0;
+
+	if (!buffer || !buffer_size) return 1;
+
+	// check the size before moving the data_ptr
+	char *data_ptr = reader ? reader->packet->data_ptr : NULL;
+	if (packet_reader_get_blob (reader, &data, &size)) return 1;
+
+	if (size >= buffer_size) {
+		reader->packet->data_ptr = data_ptr;
+		reader->error = true;
+		return 1;
+	}
+
+	(void) memcpy (buffer, data, size);
+	buffer[size] = '\0';
+
+	return 0;
+
+}
+
+u8 packet_reader_get_blob (
+	PacketReader *reader, const void **data, u32 *size
+) {
+
+	u32 blob_size = 0;
+
+	if (!data || !size) return 1;
+
+	char *data_ptr = reader ? reader->packet->data_ptr : NULL;
+	if (packet_reader_get_u32 (reader, &blob_size)) return 1;
+
+	if (packet_reader_check (reader, blob_size)) {
+		reader->packet->data_ptr = data_ptr;
+		return 1;
+	}
+
+	*data = reader->packet->data_ptr;
+	*size = blob_size;
+	reader->packet->data_ptr += blob_size;
+
+	return 0;
+
+}
+
 #pragma endregion
\ No newline at end of file
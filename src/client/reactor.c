@@ -0,0 +1,680 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/client.h"
+#include "client/connection.h"
+#include "client/handler.h"
+#include "client/reactor.h"
+#include "client/receive.h"
+#include "client/socket.h"
+#include "client/stats.h"
+
+#include "client/threads/thread.h"
+
+#include "client/utils/log.h"
+
+#pragma region thread
+
+static u8 reactor_thread_init (
+	Reactor *reactor, ReactorThread *thread, unsigned int id
+) {
+
+	u8 retval = 1;
+
+	thread->id = id;
+	thread->thread_id = 0;
+
+	thread->n_connections = 0;
+
+	thread->slots = NULL;
+	thread->n_slots = 0;
+	thread->free_slot = REACTOR_NO_SLOT;
+
+	thread->current = NULL;
+	thread->current_ended = false;
+
+	thread->reactor = reactor;
+
+	thread->buffer_size = REACTOR_DEFAULT_BUFFER_SIZE;
+	thread->buffer = (char *) calloc (thread->buffer_size, sizeof (char));
+
+	thread->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+
+	if (thread->buffer && (thread->epoll_fd >= 0)) {
+		(void) pthread_mutex_init (&thread->mutex, NULL);
+
+		retval = 0;
+	}
+
+	else {
+		free (thread->buffer);
+		thread->buffer = NULL;
+
+		if (thread->epoll_fd >= 0) {
+			(void) close (thread->epoll_fd);
+			thread->epoll_fd = -1;
+		}
+	}
+
+	return retval;
+
+}
+
+static void reactor_thread_end (ReactorThread *thread) {
+
+	if (thread->epoll_fd >= 0) {
+		(void) close (thread->epoll_fd);
+		thread->epoll_fd = -1;
+
+		(void) pthread_mutex_destroy (&thread->mutex);
+	}
+
+	free (thread->buffer);
+	thread->buffer = NULL;
+
+	free (thread->slots);
+	thread->slots = NULL;
+	thread->n_slots = 0;
+
+}
+
+#pragma endregion
+
+#pragma region slots
+
+static inline u64 reactor_slot_event_data (
+	const ReactorThread *thread, const u32 slot
+) {
+
+	return ((u64) thread->slots[slot].generation << 32) | slot;
+
+}
+
+// doubles the thread's slots & links the new ones as free
+static u8 reactor_thread_slots_grow (ReactorThread *thread) {
+
+	u32 n_slots = thread->n_slots ? thread->n_slots * 2 : REACTOR_DEFAULT_N_SLOTS;
+
+	ReactorSlot *slots = (ReactorSlot *) realloc (
+		thread->slots, n_slots * sizeof (ReactorSlot)
+	);
+
+	if (!slots) return 1;
+
+	for (u32 i = thread->n_slots; i < n_slots; i++) {
+		slots[i].connection = NULL;
+		slots[i].generation = 0;
+		slots[i].next_free = ((i + 1) < n_slots) ? i + 1 : thread->free_slot;
+	}
+
+	thread->free_slot = thread->n_slots;
+
+	thread->slots = slots;
+	thread->n_slots = n_slots;
+
+	return 0;
+
+}
+
+// returns the slot that references the connection
+// or REACTOR_NO_SLOT if there are no more slots
+// the caller holds the thread's mutex
+static u32 reactor_thread_slot_add (
+	ReactorThread *thread, Connection *connection
+) {
+
+	u32 slot = REACTOR_NO_SLOT;
+
+	if ((thread->free_slot != REACTOR_NO_SLOT) || !reactor_thread_slots_grow (thread)) {
+		slot = thread->free_slot;
+		thread->free_slot = thread->slots[slot].next_free;
+
+		thread->slots[slot].connection = connection;
+		thread->slots[slot].next_free = REACTOR_NO_SLOT;
+	}
+
+	return slot;
+
+}
+
+// frees the slot & invalidates the events that still carry it
+// the caller holds the thread's mutex
+static void reactor_thread_slot_remove (ReactorThread *thread, const u32 slot) {
+
+	thread->slots[slot].connection = NULL;
+	thread->slots[slot].generation += 1;
+
+	thread->slots[slot].next_free = thread->free_slot;
+	thread->free_slot = slot;
+
+}
+
+// returns the connection of the event
+// or NULL if it was unregistered after the event was returned
+// the caller holds the thread's mutex
+static Connection *reactor_thread_slot_get (
+	const ReactorThread *thread, const u64 data
+) {
+
+	Connection *connection = NULL;
+
+	u32 slot = (u32) data;
+	if (
+		(slot < thread->n_slots)
+		&& (thread->slots[slot].generation == (u32) (data >> 32))
+	) {
+		connection = thread->slots[slot].connection;
+	}
+
+	return connection;
+
+}
+
+#pragma endregion
+
+#pragma region events
+
+// reads from the socket into the buffer without blocking
+// so that sends using the same socket keep their blocking behaviour
+static ReceiveError reactor_thread_receive (
+	ReactorThread *thread, Connection *connection,
+	char *buffer, const size_t buffer_size
+) {
+
+	ReceiveError error = RECEIVE_ERROR_NONE;
+	Client *client = thread->reactor->client;
+
+	ssize_t received = recv (
+		connection->socket->sock_fd,
+		buffer, buffer_size,
+		MSG_DONTWAIT
+	);
+
+	if (received > 0) {
+		stats_count_receive (client, connection, (size_t) received);
+
+		client_receive_handle_data (
+			client, connection,
+			buffer, buffer_size, (size_t) received
+		);
+	}
+
+	else if ((received < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+		error = RECEIVE_ERROR_TIMEOUT;
+	}
+
+	else if ((received < 0) && (errno == EINTR)) {
+		// try again
+	}
+
+	else {
+		#ifdef CONNECTION_DEBUG
+		client_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+			"reactor_thread_receive () - connection %s sock fd: %d has been closed",
+			connection->name, connection->socket->sock_fd
+		);
+		#endif
+
+		error = (received == 0) ? RECEIVE_ERROR_EMPTY : RECEIVE_ERROR_FAILED;
+
+		client_receive_handle_failed (client, connection);
+	}
+
+	return error;
+
+}
+
+static ReceiveError reactor_thread_receive_zero_copy (
+	ReactorThread *thread, Connection *connection
+) {
+
+	ReceiveError error = RECEIVE_ERROR_FAILED;
+
+	ReceiveBuffer *buffer = receive_buffer_pool_get (
+		connection->receive_buffer_pool
+	);
+
+	if (buffer) {
+		connection->receive_handle.receive_buffer = buffer;
+
+		error = reactor_thread_receive (
+			thread, connection,
+			buffer->data, buffer->size
+		);
+
+		// the connection might have been deleted while handling its packets
+		if (!thread->current_ended) {
+			connection->receive_handle.receive_buffer = NULL;
+		}
+
+		// packets that still need the buffer hold their own references
+		receive_buffer_unref (buffer);
+	}
+
+	else {
+		client_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+			"reactor_thread_receive_zero_copy () - Failed to get a receive buffer!"
+		);
+	}
+
+	return error;
+
+}
+
+// as sockets are edge-triggered,
+// reads until there is no more data available in the socket
+static void reactor_thread_handle_connection (
+	ReactorThread *thread, Connection *connection
+) {
+
+	ReceiveError error = RECEIVE_ERROR_NONE;
+
+	thread->current = connection;
+	thread->current_ended = false;
+
+	do {
+		if (connection->receive_buffer_pool) {
+			error = reactor_thread_receive_zero_copy (thread, connection);
+		}
+
+		else {
+			error = reactor_thread_receive (
+				thread, connection,
+				thread->buffer, thread->buffer_size
+			);
+		}
+	} while (
+		(error == RECEIVE_ERROR_NONE)
+		&& !thread->current_ended
+		&& connection->active
+	);
+
+	thread->current = NULL;
+	thread->current_ended = false;
+
+}
+
+static void *reactor_thread_loop (void *thread_ptr) {
+
+	ReactorThread *thread = (ReactorThread *) thread_ptr;
+	Reactor *reactor = thread->reactor;
+
+	struct epoll_event events[REACTOR_DEFAULT_MAX_EVENTS];
+
+	char thread_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
+	(void) snprintf (
+		thread_name, THREAD_NAME_BUFFER_SIZE,
+		"reactor-%u", thread->id
+	);
+
+	(void) thread_set_name (thread_name);
+
+	#ifdef CLIENT_DEBUG
+	client_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+		"Client %s - reactor thread %u has started",
+		reactor->client->name, thread->id
+	);
+	#endif
+
+	while (__atomic_load_n (&reactor->running, __ATOMIC_ACQUIRE)) {
+		int n_events = epoll_wait (
+			thread->epoll_fd,
+			events, REACTOR_DEFAULT_MAX_EVENTS,
+			REACTOR_DEFAULT_TIMEOUT
+		);
+
+		for (int i = 0; i < n_events; i++) {
+			// the lock is only held while a single connection is handled
+			// so unregisters from other threads don't wait for the whole batch
+			(void) pthread_mutex_lock (&thread->mutex);
+
+			// the connection might have been unregistered
+			// by another thread or by a previous event's handlers
+			Connection *connection = reactor_thread_slot_get (
+				thread, events[i].data.u64
+			);
+
+			if (connection) {
+				// the socket can take the bytes parked by non-blocking sends
+				if (events[i].events & EPOLLOUT) {
+					(void) connection_output_flush (connection);
+				}
+
+				// a failed flush might have ended the connection
+				if (
+					(events[i].events & ~EPOLLOUT)
+					&& reactor_thread_slot_get (thread, events[i].data.u64)
+				) {
+					reactor_thread_handle_connection (thread, connection);
+				}
+			}
+
+			(void) pthread_mutex_unlock (&thread->mutex);
+		}
+
+		if ((n_events < 0) && (errno != EINTR)) {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+				"reactor_thread_loop () - epoll_wait () failed in thread %u!",
+				thread->id
+			);
+
+			break;
+		}
+	}
+
+	#ifdef CLIENT_DEBUG
+	client_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+		"Client %s - reactor thread %u has ended",
+		reactor->client->name, thread->id
+	);
+	#endif
+
+	return NULL;
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+static Reactor *reactor_new (void) {
+
+	Reactor *reactor = (Reactor *) malloc (sizeof (Reactor));
+	if (reactor) {
+		reactor->client = NULL;
+
+		reactor->running = false;
+
+		reactor->n_threads = 0;
+		reactor->threads = NULL;
+
+		reactor->next_thread = 0;
+	}
+
+	return reactor;
+
+}
+
+void reactor_delete (void *reactor_ptr) {
+
+	if (reactor_ptr) {
+		Reactor *reactor = (Reactor *) reactor_ptr;
+
+		reactor_stop (reactor);
+
+		for (unsigned int i = 0; i < reactor->n_threads; i++)
+			reactor_thread_end (&reactor->threads[i]);
+
+		free (reactor->threads);
+
+		(void) pthread_mutex_destroy (&reactor->lock);
+
+		free (reactor_ptr);
+	}
+
+}
+
+Reactor *reactor_create (Client *client, unsigned int n_threads) {
+
+	Reactor *reactor = reactor_new ();
+	if (reactor) {
+		reactor->client = client;
+
+		if (!n_threads) {
+			long n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+			n_threads = (n_cpus > 0) ? (unsigned int) n_cpus : 1;
+		}
+
+		(void) pthread_mutex_init (&reactor->lock, NULL);
+
+		reactor->threads = (ReactorThread *) calloc (
+			n_threads, sizeof (ReactorThread)
+		);
+
+		if (reactor->threads) {
+			for (unsigned int i = 0; i < n_threads; i++) {
+				if (reactor_thread_init (reactor, &reactor->threads[i], i)) break;
+				reactor->n_threads += 1;
+			}
+		}
+
+		if (reactor->n_threads != n_threads) {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+				"reactor_create () - Failed to create %u reactor threads!",
+				n_threads
+			);
+
+			reactor_delete (reactor);
+			reactor = NULL;
+		}
+	}
+
+	return reactor;
+
+}
+
+u8 reactor_start (Reactor *reactor) {
+
+	u8 retval = 1;
+
+	if (reactor && !reactor->running) {
+		reactor->running = true;
+
+		unsigned int started = 0;
+		for (; started < reactor->n_threads; started++) {
+			if (pthread_create (
+				&reactor->threads[started].thread_id,
+				NULL,
+				reactor_thread_loop,
+				&reactor->threads[started]
+			)) {
+				break;
+			}
+		}
+
+		if (started == reactor->n_threads) {
+			retval = 0;
+		}
+
+		else {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+				"reactor_start () - Failed to start reactor thread %u!",
+				started
+			);
+
+			__atomic_store_n (&reactor->running, false, __ATOMIC_RELEASE);
+
+			for (unsigned int i = 0; i < started; i++) {
+				(void) pthread_join (reactor->threads[i].thread_id, NULL);
+				reactor->threads[i].thread_id = 0;
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+void reactor_stop (Reactor *reactor) {
+
+	if (reactor && reactor->running) {
+		__atomic_store_n (&reactor->running, false, __ATOMIC_RELEASE);
+
+		for (unsigned int i = 0; i < reactor->n_threads; i++) {
+			if (reactor->threads[i].thread_id) {
+				(void) pthread_join (reactor->threads[i].thread_id, NULL);
+				reactor->threads[i].thread_id = 0;
+			}
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region connections
+
+static ReactorThread *reactor_get_next_thread (Reactor *reactor) {
+
+	(void) pthread_mutex_lock (&reactor->lock);
+
+	ReactorThread *thread = &reactor->threads[reactor->next_thread];
+	reactor->next_thread = (reactor->next_thread + 1) % reactor->n_threads;
+
+	(void) pthread_mutex_unlock (&reactor->lock);
+
+	return thread;
+
+}
+
+u8 reactor_register_connection (
+	Reactor *reactor, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (reactor && connection && !connection->reactor_thread) {
+		ReactorThread *thread = reactor_get_next_thread (reactor);
+
+		connection->receive_handle.client = reactor->client;
+		connection->receive_handle.connection = connection;
+
+		connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
+
+		// handle any bytes read ahead by client_connection_get_next_packet ()
+		client_receive_handle_read_ahead (reactor->client, connection);
+
+		// packets will reference pooled buffers instead of copying their data
+		if (connection->zero_copy_receive) {
+			connection->receive_buffer_pool = receive_buffer_pool_create (
+				connection->receive_packet_buffer_size,
+				connection->receive_buffer_pool_size
+			);
+		}
+
+		if (!connection->zero_copy_receive || connection->receive_buffer_pool) {
+			// the thread already holds its lock while handling a connection
+			bool own_thread = pthread_equal (pthread_self (), thread->thread_id);
+
+			if (!own_thread) (void) pthread_mutex_lock (&thread->mutex);
+
+			connection->reactor_thread = thread;
+			connection->updating = true;
+
+			bool added = false;
+			connection->reactor_slot = reactor_thread_slot_add (thread, connection);
+			if (connection->reactor_slot != REACTOR_NO_SLOT) {
+				struct epoll_event event = { 0 };
+				event.events = EPOLLIN | EPOLLET | EPOLLRDHUP;
+				if (connection->nonblocking_send) event.events |= EPOLLOUT;
+				event.data.u64 = reactor_slot_event_data (thread, connection->reactor_slot);
+
+				added = !epoll_ctl (
+					thread->epoll_fd, EPOLL_CTL_ADD,
+					connection->socket->sock_fd, &event
+				);
+			}
+
+			if (added) {
+				(void) __atomic_add_fetch (&thread->n_connections, 1, __ATOMIC_RELAXED);
+
+				retval = 0;
+			}
+
+			else {
+				client_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+					"reactor_register_connection () - "
+					"Failed to add connection %s to reactor thread %u!",
+					connection->name, thread->id
+				);
+
+				if (connection->reactor_slot != REACTOR_NO_SLOT) {
+					reactor_thread_slot_remove (thread, connection->reactor_slot);
+					connection->reactor_slot = REACTOR_NO_SLOT;
+				}
+
+				connection->reactor_thread = NULL;
+				connection->updating = false;
+
+				receive_buffer_pool_delete (connection->receive_buffer_pool);
+				connection->receive_buffer_pool = NULL;
+			}
+
+			if (!own_thread) (void) pthread_mutex_unlock (&thread->mutex);
+		}
+
+		else {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+				"reactor_register_connection () - "
+				"Failed to create buffer pool for connection %s!",
+				connection->name
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+void reactor_unregister_connection (Connection *connection) {
+
+	if (connection && connection->reactor_thread) {
+		ReactorThread *thread = connection->reactor_thread;
+
+		// the thread already holds its lock while handling the connection
+		bool own_thread = pthread_equal (pthread_self (), thread->thread_id);
+
+		if (!own_thread) (void) pthread_mutex_lock (&thread->mutex);
+
+		if (thread->current == connection) {
+			thread->current_ended = true;
+		}
+
+		// the socket might have already been closed
+		(void) epoll_ctl (
+			thread->epoll_fd, EPOLL_CTL_DEL,
+			connection->socket->sock_fd, NULL
+		);
+
+		(void) __atomic_sub_fetch (&thread->n_connections, 1, __ATOMIC_RELAXED);
+
+		// events already returned for the connection will be skipped
+		reactor_thread_slot_remove (thread, connection->reactor_slot);
+		connection->reactor_slot = REACTOR_NO_SLOT;
+
+		connection->reactor_thread = NULL;
+
+		// buffers still referenced by packets will be freed when they are released
+		receive_buffer_pool_delete (connection->receive_buffer_pool);
+		connection->receive_buffer_pool = NULL;
+		connection->receive_handle.receive_buffer = NULL;
+
+		connection->updating = false;
+
+		if (!own_thread) (void) pthread_mutex_unlock (&thread->mutex);
+	}
+
+}
+
+#pragma endregion
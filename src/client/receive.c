@@ -1,8 +1,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <sys/socket.h>
+
+#include "client/connection.h"
 #include "client/packets.h"
 #include "client/receive.h"
+#include "client/socket.h"
 
 const char *receive_error_to_string (
 	const ReceiveError error
@@ -18,6 +22,176 @@ const char *receive_error_to_string (
 
 }
 
+#pragma region buffers
+
+static ReceiveBuffer *receive_buffer_new (
+	ReceiveBufferPool *pool, const size_t size
+) {
+
+	ReceiveBuffer *buffer = (ReceiveBuffer *) malloc (sizeof (ReceiveBuffer));
+	if (buffer) {
+		buffer->pool = pool;
+
+		buffer->refs = 0;
+
+		buffer->data = (char *) malloc (size);
+		buffer->size = size;
+
+		buffer->next = NULL;
+
+		if (!buffer->data) {
+			free (buffer);
+			buffer = NULL;
+		}
+	}
+
+	return buffer;
+
+}
+
+static void receive_buffer_delete (ReceiveBuffer *buffer) {
+
+	if (buffer) {
+		free (buffer->data);
+		free (buffer);
+	}
+
+}
+
+static void receive_buffer_pool_free (ReceiveBufferPool *pool) {
+
+	ReceiveBuffer *next = NULL;
+	for (ReceiveBuffer *buffer = pool->buffers; buffer; buffer = next) {
+		next = buffer->next;
+		receive_buffer_delete (buffer);
+	}
+
+	(void) pthread_mutex_destroy (&pool->mutex);
+
+	free (pool);
+
+}
+
+// creates a new pool of buffers of buffer_size bytes
+// that will keep up to max_buffers idle buffers ready to be used
+ReceiveBufferPool *receive_buffer_pool_create (
+	const size_t buffer_size, const unsigned int max_buffers
+) {
+
+	ReceiveBufferPool *pool = NULL;
+
+	if (buffer_size > 0) {
+		pool = (ReceiveBufferPool *) malloc (sizeof (ReceiveBufferPool));
+		if (pool) {
+			pool->buffer_size = buffer_size;
+
+			pool->max_buffers = max_buffers;
+			pool->n_buffers = 0;
+			pool->buffers = NULL;
+
+			pool->refs = 1;
+			pool->closed = false;
+
+			(void) pthread_mutex_init (&pool->mutex, NULL);
+		}
+	}
+
+	return pool;
+
+}
+
+// releases the owner's reference to the pool
+// buffers that are still in use will be freed when they are released
+void receive_buffer_pool_delete (ReceiveBufferPool *pool) {
+
+	if (pool) {
+		(void) pthread_mutex_lock (&pool->mutex);
+
+		pool->closed = true;
+		pool->refs -= 1;
+		bool last = (pool->refs == 0);
+
+		(void) pthread_mutex_unlock (&pool->mutex);
+
+		if (last) receive_buffer_pool_free (pool);
+	}
+
+}
+
+// gets a buffer from the pool with a single reference to it
+// a new buffer is allocated if the pool is empty
+ReceiveBuffer *receive_buffer_pool_get (ReceiveBufferPool *pool) {
+
+	ReceiveBuffer *buffer = NULL;
+
+	if (pool) {
+		(void) pthread_mutex_lock (&pool->mutex);
+
+		if (pool->buffers) {
+			buffer = pool->buffers;
+			pool->buffers = buffer->next;
+			pool->n_buffers -= 1;
+		}
+
+		(void) pthread_mutex_unlock (&pool->mutex);
+
+		if (!buffer) buffer = receive_buffer_new (pool, pool->buffer_size);
+
+		if (buffer) {
+			buffer->refs = 1;
+			buffer->next = NULL;
+
+			(void) pthread_mutex_lock (&pool->mutex);
+			pool->refs += 1;
+			(void) pthread_mutex_unlock (&pool->mutex);
+		}
+	}
+
+	return buffer;
+
+}
+
+// adds a new reference to the buffer
+void receive_buffer_ref (ReceiveBuffer *buffer) {
+
+	if (buffer) {
+		(void) __atomic_add_fetch (&buffer->refs, 1, __ATOMIC_RELAXED);
+	}
+
+}
+
+// releases a reference to the buffer
+// returns the buffer to its pool when no references are left
+void receive_buffer_unref (ReceiveBuffer *buffer) {
+
+	if (buffer) {
+		if (!__atomic_sub_fetch (&buffer->refs, 1, __ATOMIC_ACQ_REL)) {
+			ReceiveBufferPool *pool = buffer->pool;
+
+			(void) pthread_mutex_lock (&pool->mutex);
+
+			if (!pool->closed && (pool->n_buffers < pool->max_buffers)) {
+				buffer->next = pool->buffers;
+				pool->buffers = buffer;
+				pool->n_buffers += 1;
+				buffer = NULL;
+			}
+
+			pool->refs -= 1;
+			bool last = (pool->refs == 0);
+
+			(void) pthread_mutex_unlock (&pool->mutex);
+
+			receive_buffer_delete (buffer);
+
+			if (last) receive_buffer_pool_free (pool);
+		}
+	}
+
+}
+
+#pragma endregion
+
 const char *receive_type_to_string (
 	const ReceiveType type
 ) {
@@ -60,6 +234,9 @@ ReceiveHandle *receive_handle_new (void) {
 
 		receive_handle->buffer = NULL;
 		receive_handle->buffer_size = 0;
+		receive_handle->received_size = 0;
+
+		receive_handle->receive_buffer = NULL;
 
 		receive_handle->state = RECEIVE_HANDLE_STATE_NONE;
 
@@ -67,7 +244,16 @@ ReceiveHandle *receive_handle_new (void) {
 		receive_handle->header_end = NULL;
 		receive_handle->remaining_header = 0;
 
+		receive_handle->resync_tail_size = 0;
+
 		receive_handle->spare_packet = NULL;
+
+		(void) memset (&receive_handle->stream, 0, sizeof (PacketStream));
+
+		receive_handle->read_buffer = NULL;
+		receive_handle->read_buffer_size = 0;
+		receive_handle->read_start = 0;
+		receive_handle->read_end = 0;
 	}
 
 	return receive_handle;
@@ -76,6 +262,162 @@ ReceiveHandle *receive_handle_new (void) {
 
 void receive_handle_delete (void *receive_ptr) {
 	
-	if (receive_ptr) free (receive_ptr);
+	if (receive_ptr) {
+		free (((ReceiveHandle *) receive_ptr)->read_buffer);
+
+		free (receive_ptr);
+	}
 	
-}
\ No newline at end of file
+}
+
+#pragma region adaptive
+
+static void receive_adaptive_set_low_watermark (
+	ReceiveAdaptive *adaptive, Connection *connection, int low_watermark
+) {
+
+	if (adaptive->low_watermark != low_watermark) {
+		if (!setsockopt (
+			connection->socket->sock_fd, SOL_SOCKET, SO_RCVLOWAT,
+			&low_watermark, sizeof (int)
+		)) {
+			adaptive->low_watermark = low_watermark;
+		}
+
+		connection->stats->receive_low_watermark = (u64) adaptive->low_watermark;
+	}
+
+}
+
+u8 receive_adaptive_init (
+	ReceiveAdaptive *adaptive, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	adaptive->min_size = connection->receive_min_buffer_size;
+	adaptive->max_size = connection->receive_max_buffer_size;
+
+	adaptive->buffer_size = connection->receive_packet_buffer_size;
+	if (adaptive->buffer_size < adaptive->min_size)
+		adaptive->buffer_size = adaptive->min_size;
+	else if (adaptive->buffer_size > adaptive->max_size)
+		adaptive->buffer_size = adaptive->max_size;
+
+	adaptive->full_reads = 0;
+	adaptive->small_reads = 0;
+
+	adaptive->low_watermark = 1;
+
+	adaptive->buffer = (char *) malloc (adaptive->buffer_size);
+	if (adaptive->buffer) {
+		connection->stats->receive_buffer_size = adaptive->buffer_size;
+		connection->stats->receive_low_watermark = (u64) adaptive->low_watermark;
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+void receive_adaptive_end (
+	ReceiveAdaptive *adaptive, Connection *connection
+) {
+
+	if (connection->active) {
+		receive_adaptive_set_low_watermark (adaptive, connection, 1);
+	}
+
+	free (adaptive->buffer);
+	adaptive->buffer = NULL;
+	adaptive->buffer_size = 0;
+
+}
+
+static void receive_adaptive_resize (
+	ReceiveAdaptive *adaptive, Connection *connection, size_t size
+) {
+
+	if (size < adaptive->min_size) size = adaptive->min_size;
+	else if (size > adaptive->max_size) size = adaptive->max_size;
+
+	if (size != adaptive->buffer_size) {
+		// any incomplete data has already been copied out of the buffer
+		char *buffer = (char *) realloc (adaptive->buffer, size);
+		if (buffer) {
+			adaptive->buffer = buffer;
+			adaptive->buffer_size = size;
+
+			connection->stats->receive_buffer_size = size;
+			connection->stats->n_receive_buffer_resizes += 1;
+		}
+	}
+
+	adaptive->full_reads = 0;
+	adaptive->small_reads = 0;
+
+}
+
+void receive_adaptive_update (
+	ReceiveAdaptive *adaptive, Connection *connection,
+	const size_t received
+) {
+
+	const ReceiveHandle *receive_handle = &connection->receive_handle;
+
+	size_t pending = 0;
+
+	if (received == adaptive->buffer_size) {
+		// we are in the middle of a burst
+		adaptive->full_reads += 1;
+		adaptive->small_reads = 0;
+
+		if (adaptive->full_reads >= RECEIVE_ADAPTIVE_GROW_READS) {
+			receive_adaptive_resize (
+				adaptive, connection, adaptive->buffer_size * 2
+			);
+		}
+	}
+
+	else if (received <= (adaptive->buffer_size / 4)) {
+		adaptive->small_reads += 1;
+		adaptive->full_reads = 0;
+
+		if (adaptive->small_reads >= RECEIVE_ADAPTIVE_SHRINK_READS) {
+			receive_adaptive_resize (
+				adaptive, connection, adaptive->buffer_size / 2
+			);
+		}
+	}
+
+	else {
+		adaptive->full_reads = 0;
+		adaptive->small_reads = 0;
+	}
+
+	if (
+		(receive_handle->state == RECEIVE_HANDLE_STATE_SPLIT_PACKET)
+		&& receive_handle->spare_packet
+	) {
+		// make room for the complete packet to avoid more split packets
+		if (receive_handle->spare_packet->packet_size > adaptive->buffer_size) {
+			size_t size = adaptive->buffer_size;
+			while (size < receive_handle->spare_packet->packet_size) size *= 2;
+
+			receive_adaptive_resize (adaptive, connection, size);
+		}
+
+		pending = receive_handle->spare_packet->remaining_data;
+	}
+
+	// wait until the pending packet's data is completely available
+	// so it can be handled with a single read
+	if (pending > adaptive->buffer_size) pending = adaptive->buffer_size;
+	receive_adaptive_set_low_watermark (
+		adaptive, connection, (pending > 1) ? (int) pending : 1
+	);
+
+}
+
+#pragma endregion
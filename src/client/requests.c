@@ -0,0 +1,808 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <time.h>
+
+#include <arpa/inet.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/client.h"
+#include "client/connection.h"
+#include "client/packets.h"
+#include "client/requests.h"
+
+#include "client/threads/thread.h"
+
+#include "client/utils/log.h"
+
+const char *request_state_to_string (const RequestState state) {
+
+	switch (state) {
+		#define XX(num, name, string, description) case REQUEST_STATE_##name: return #string;
+		REQUEST_STATE_MAP(XX)
+		#undef XX
+	}
+
+	return request_state_to_string (REQUEST_STATE_NONE);
+
+}
+
+const char *request_state_description (const RequestState state) {
+
+	switch (state) {
+		#define XX(num, name, string, description) case REQUEST_STATE_##name: return #description;
+		REQUEST_STATE_MAP(XX)
+		#undef XX
+	}
+
+	return request_state_description (REQUEST_STATE_NONE);
+
+}
+
+#pragma region time
+
+static u64 requests_now (void) {
+
+	struct timespec now = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &now);
+
+	return ((u64) now.tv_sec * 1000) + ((u64) now.tv_nsec / 1000000);
+
+}
+
+static void requests_deadline_to_timespec (
+	const u64 deadline, struct timespec *ts
+) {
+
+	ts->tv_sec = (time_t) (deadline / 1000);
+	ts->tv_nsec = (long) ((deadline % 1000) * 1000000);
+
+}
+
+// conds are waited using the monotonic clock
+// so deadlines are not affected by changes to the system time
+static void requests_cond_init (pthread_cond_t *cond) {
+
+	pthread_condattr_t attr;
+	(void) pthread_condattr_init (&attr);
+	(void) pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+	(void) pthread_cond_init (cond, &attr);
+	(void) pthread_condattr_destroy (&attr);
+
+}
+
+#pragma endregion
+
+#pragma region request
+
+static Request *request_new (void) {
+
+	Request *request = (Request *) malloc (sizeof (Request));
+	if (request) {
+		request->id = 0;
+
+		request->state = REQUEST_STATE_NONE;
+
+		request->requests = NULL;
+
+		request->response = NULL;
+
+		request->deadline = 0;
+
+		request->callback = NULL;
+		request->callback_args = NULL;
+
+		requests_cond_init (&request->cond);
+
+		request->references = 1;
+
+		request->next = NULL;
+	}
+
+	return request;
+
+}
+
+// releases a reference to the request
+// the request gets deleted when its last reference is released
+static void request_release (Request *request) {
+
+	if (!__atomic_sub_fetch (&request->references, 1, __ATOMIC_ACQ_REL)) {
+		packet_delete (request->response);
+
+		(void) pthread_cond_destroy (&request->cond);
+
+		free (request);
+	}
+
+}
+
+void request_delete (void *request_ptr) {
+
+	if (request_ptr) request_release ((Request *) request_ptr);
+
+}
+
+u32 request_get_id (const Request *request) {
+
+	return request ? request->id : 0;
+
+}
+
+RequestState request_get_state (Request *request) {
+
+	return request ?
+		__atomic_load_n (&request->state, __ATOMIC_ACQUIRE) : REQUEST_STATE_NONE;
+
+}
+
+Packet *request_get_response (const Request *request) {
+
+	return request ? request->response : NULL;
+
+}
+
+Packet *request_take_response (Request *request) {
+
+	Packet *response = NULL;
+
+	if (request && (request_get_state (request) != REQUEST_STATE_PENDING)) {
+		response = request->response;
+		request->response = NULL;
+	}
+
+	return response;
+
+}
+
+// called outside the requests lock after the request has been completed
+static void request_completed (Request *request) {
+
+	if (request->callback) {
+		request->callback (request, request->callback_args);
+	}
+
+	// the pending table reference
+	request_release (request);
+
+}
+
+#pragma endregion
+
+#pragma region table
+
+static Requests *requests_new (void) {
+
+	Requests *requests = (Requests *) malloc (sizeof (Requests));
+	if (requests) {
+		requests->connection = NULL;
+
+		requests->next_id = 0;
+
+		requests->buckets = NULL;
+		requests->n_buckets = 0;
+		requests->n_pending = 0;
+
+		requests->next_deadline = 0;
+
+		requests->timer_running = false;
+		requests->timer_stop = false;
+		requests->timer_thread_id = 0;
+		requests_cond_init (&requests->timer_cond);
+
+		(void) pthread_mutex_init (&requests->mutex, NULL);
+	}
+
+	return requests;
+
+}
+
+Requests *requests_create (Connection *connection) {
+
+	Requests *requests = requests_new ();
+	if (requests) {
+		requests->connection = connection;
+	}
+
+	return requests;
+
+}
+
+static inline Request **requests_bucket (
+	const Requests *requests, const u32 id
+) {
+
+	return &requests->buckets[id & (requests->n_buckets - 1)];
+
+}
+
+static Request *requests_get (const Requests *requests, const u32 id) {
+
+	Request *request = NULL;
+
+	if (requests->n_buckets) {
+		request = *requests_bucket (requests, id);
+		while (request && (request->id != id)) request = request->next;
+	}
+
+	return request;
+
+}
+
+// doubles the buckets when there are more pending requests than buckets
+static u8 requests_grow (Requests *requests) {
+
+	size_t n_buckets = requests->n_buckets ?
+		requests->n_buckets * 2 : REQUESTS_DEFAULT_N_BUCKETS;
+
+	Request **buckets = (Request **) calloc (n_buckets, sizeof (Request *));
+	if (!buckets) return 1;
+
+	for (size_t i = 0; i < requests->n_buckets; i++) {
+		Request *request = requests->buckets[i];
+		while (request) {
+			Request *next = request->next;
+
+			Request **bucket = &buckets[request->id & (n_buckets - 1)];
+			request->next = *bucket;
+			*bucket = request;
+
+			request = next;
+		}
+	}
+
+	free (requests->buckets);
+	requests->buckets = buckets;
+	requests->n_buckets = n_buckets;
+
+	return 0;
+
+}
+
+// unlinks the request with the id from the pending table
+static Request *requests_remove (Requests *requests, const u32 id) {
+
+	Request *request = NULL;
+
+	if (requests->n_buckets) {
+		Request **link = requests_bucket (requests, id);
+		while (*link && ((*link)->id != id)) link = &(*link)->next;
+
+		if (*link) {
+			request = *link;
+			*link = request->next;
+			request->next = NULL;
+
+			__atomic_store_n (
+				&requests->n_pending, requests->n_pending - 1, __ATOMIC_RELAXED
+			);
+		}
+	}
+
+	return request;
+
+}
+
+static void *requests_timer_thread (void *requests_ptr);
+
+// assigns a new correlation id to the request
+// and adds it to the pending table
+// returns 0 on success, 1 on error
+static u8 requests_add (Requests *requests, Request *request) {
+
+	u8 retval = 1;
+
+	(void) pthread_mutex_lock (&requests->mutex);
+
+	if ((requests->n_pending < requests->n_buckets) || !requests_grow (requests)) {
+		// ids are never 0 & skip the ones of long pending requests
+		do {
+			requests->next_id += 1;
+		} while (!requests->next_id || requests_get (requests, requests->next_id));
+
+		request->id = requests->next_id;
+		request->requests = requests;
+		__atomic_store_n (&request->state, REQUEST_STATE_PENDING, __ATOMIC_RELEASE);
+
+		// the pending table reference
+		__atomic_add_fetch (&request->references, 1, __ATOMIC_RELAXED);
+
+		Request **bucket = requests_bucket (requests, request->id);
+		request->next = *bucket;
+		*bucket = request;
+
+		__atomic_store_n (
+			&requests->n_pending, requests->n_pending + 1, __ATOMIC_RELAXED
+		);
+
+		if (request->deadline) {
+			if (!requests->next_deadline || (request->deadline < requests->next_deadline)) {
+				requests->next_deadline = request->deadline;
+				(void) pthread_cond_signal (&requests->timer_cond);
+			}
+
+			// deadlines are handled by a single thread for all the requests
+			if (!requests->timer_running) {
+				if (!pthread_create (
+					&requests->timer_thread_id, NULL,
+					requests_timer_thread, requests
+				)) {
+					requests->timer_running = true;
+				}
+
+				else {
+					client_log_error (
+						"requests_add () - "
+						"Failed to create requests timer thread!"
+					);
+				}
+			}
+		}
+
+		retval = 0;
+	}
+
+	(void) pthread_mutex_unlock (&requests->mutex);
+
+	return retval;
+
+}
+
+// sets the request's final state & wakes up its waiters
+// the caller holds the requests lock & has removed it from the table
+static void requests_complete (
+	Request *request, const RequestState state, Packet *response
+) {
+
+	request->response = response;
+	__atomic_store_n (&request->state, state, __ATOMIC_RELEASE);
+
+	(void) pthread_cond_broadcast (&request->cond);
+
+}
+
+// completes the requests whose deadline has passed
+// the caller holds the requests lock, that is released while their callbacks run
+static void requests_expire (Requests *requests, const u64 now) {
+
+	Request *expired = NULL;
+	u64 next_deadline = 0;
+
+	for (size_t i = 0; i < requests->n_buckets; i++) {
+		Request **link = &requests->buckets[i];
+		while (*link) {
+			Request *request = *link;
+
+			if (request->deadline && (request->deadline <= now)) {
+				*link = request->next;
+
+				__atomic_store_n (
+					&requests->n_pending, requests->n_pending - 1, __ATOMIC_RELAXED
+				);
+
+				requests_complete (request, REQUEST_STATE_TIMEOUT, NULL);
+
+				request->next = expired;
+				expired = request;
+			}
+
+			else {
+				if (request->deadline && (!next_deadline || (request->deadline < next_deadline)))
+					next_deadline = request->deadline;
+
+				link = &request->next;
+			}
+		}
+	}
+
+	requests->next_deadline = next_deadline;
+
+	if (expired) {
+		(void) pthread_mutex_unlock (&requests->mutex);
+
+		while (expired) {
+			Request *next = expired->next;
+			expired->next = NULL;
+
+			request_completed (expired);
+
+			expired = next;
+		}
+
+		(void) pthread_mutex_lock (&requests->mutex);
+	}
+
+}
+
+static void *requests_timer_thread (void *requests_ptr) {
+
+	Requests *requests = (Requests *) requests_ptr;
+
+	(void) thread_set_name ("requests-timer");
+
+	(void) pthread_mutex_lock (&requests->mutex);
+
+	while (!requests->timer_stop) {
+		if (requests->next_deadline) {
+			if (requests_now () >= requests->next_deadline) {
+				requests_expire (requests, requests_now ());
+			}
+
+			else {
+				struct timespec ts = { 0 };
+				requests_deadline_to_timespec (requests->next_deadline, &ts);
+
+				(void) pthread_cond_timedwait (
+					&requests->timer_cond, &requests->mutex, &ts
+				);
+			}
+		}
+
+		else {
+			(void) pthread_cond_wait (&requests->timer_cond, &requests->mutex);
+		}
+	}
+
+	(void) pthread_mutex_unlock (&requests->mutex);
+
+	return NULL;
+
+}
+
+void requests_end (Requests *requests) {
+
+	if (requests) {
+		Request *ended = NULL;
+
+		(void) pthread_mutex_lock (&requests->mutex);
+
+		for (size_t i = 0; i < requests->n_buckets; i++) {
+			while (requests->buckets[i]) {
+				Request *request = requests->buckets[i];
+				requests->buckets[i] = request->next;
+
+				requests_complete (request, REQUEST_STATE_ENDED, NULL);
+
+				request->next = ended;
+				ended = request;
+			}
+		}
+
+		__atomic_store_n (&requests->n_pending, 0, __ATOMIC_RELAXED);
+		requests->next_deadline = 0;
+
+		(void) pthread_mutex_unlock (&requests->mutex);
+
+		while (ended) {
+			Request *next = ended->next;
+			ended->next = NULL;
+
+			request_completed (ended);
+
+			ended = next;
+		}
+	}
+
+}
+
+void requests_delete (void *requests_ptr) {
+
+	if (requests_ptr) {
+		Requests *requests = (Requests *) requests_ptr;
+
+		(void) pthread_mutex_lock (&requests->mutex);
+		requests->timer_stop = true;
+		(void) pthread_cond_signal (&requests->timer_cond);
+		(void) pthread_mutex_unlock (&requests->mutex);
+
+		if (requests->timer_running) {
+			(void) pthread_join (requests->timer_thread_id, NULL);
+		}
+
+		requests_end (requests);
+
+		free (requests->buckets);
+
+		(void) pthread_cond_destroy (&requests->timer_cond);
+		(void) pthread_mutex_destroy (&requests->mutex);
+
+		free (requests_ptr);
+	}
+
+}
+
+u8 requests_handle_response (Requests *requests, Packet *packet) {
+
+	u8 retval = 1;
+
+	// the data_ptr is past the packet's version when packets are checked
+	// and it is not set yet in packets that have not been read
+	char *data_ptr = packet->data_ptr ? packet->data_ptr : (char *) packet->data;
+	char *data_end = (char *) packet->data + packet->data_size;
+
+	if (
+		requests
+		&& (packet->header.request_type & REQUEST_TYPE_CORRELATED)
+		&& __atomic_load_n (&requests->n_pending, __ATOMIC_RELAXED)
+		&& packet->data
+		&& (data_ptr >= (char *) packet->data)
+		&& ((size_t) (data_end - data_ptr) >= REQUEST_ID_SIZE)
+	) {
+		u32 id = 0;
+		(void) memcpy (&id, data_ptr, REQUEST_ID_SIZE);
+		id = ntohl (id);
+
+		(void) pthread_mutex_lock (&requests->mutex);
+
+		Request *request = requests_remove (requests, id);
+		if (request) {
+			// the response's data is read after the request's id
+			packet->data_ptr = data_ptr + REQUEST_ID_SIZE;
+			packet->data_end = data_end;
+
+			requests_complete (
+				request,
+				(packet->header.packet_type == PACKET_TYPE_APP_ERROR) ?
+					REQUEST_STATE_ERROR : REQUEST_STATE_DONE,
+				packet
+			);
+		}
+
+		(void) pthread_mutex_unlock (&requests->mutex);
+
+		if (request) {
+			request_completed (request);
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region send
+
+// generates a packet with the request's id in front of the data
+static Packet *requests_packet_create (
+	const u32 id,
+	const PacketType packet_type, const u32 request_type,
+	const void *data, const size_t data_size
+) {
+
+	Packet *packet = packet_create (packet_type, request_type, NULL, 0);
+	if (packet) {
+		PacketWriter writer = { 0 };
+		(void) packet_writer_init (&writer, packet, REQUEST_ID_SIZE + data_size);
+		(void) packet_writer_put_u32 (&writer, id);
+		if (data && data_size) (void) packet_writer_put_bytes (&writer, data, data_size);
+
+		if (packet_writer_finish (&writer)) {
+			packet_delete (packet);
+			packet = NULL;
+		}
+	}
+
+	return packet;
+
+}
+
+// uses the connection's send queue when it has one
+// the packet is always consumed
+static u8 requests_packet_send (
+	Client *client, Connection *connection, Packet *packet
+) {
+
+	u8 retval = 1;
+
+	packet_set_network_values (packet, client, connection);
+
+	if (connection->send_has_packets) {
+		retval = connection_send_packet (connection, packet);
+		if (retval) packet_delete (packet);
+	}
+
+	else {
+		retval = packet_send (packet, 0, NULL, false);
+		packet_delete (packet);
+	}
+
+	return retval;
+
+}
+
+static Request *client_request_send_internal (
+	Client *client, Connection *connection,
+	const PacketType packet_type, const u32 request_type,
+	const void *data, const size_t data_size,
+	const u32 timeout,
+	RequestCallback callback, void *callback_args
+) {
+
+	Request *request = request_new ();
+	if (request) {
+		request->deadline = timeout ? requests_now () + timeout : 0;
+		request->callback = callback;
+		request->callback_args = callback_args;
+
+		// the request is pending before it is sent
+		// so its response can't arrive before it can be matched
+		if (!requests_add (connection->requests, request)) {
+			Packet *packet = requests_packet_create (
+				request->id,
+				packet_type, request_type | REQUEST_TYPE_CORRELATED,
+				data, data_size
+			);
+
+			if (!packet || requests_packet_send (client, connection, packet)) {
+				#ifdef CLIENT_DEBUG
+				client_log_error (
+					"client_request_send () - "
+					"failed to send request %u!",
+					request->id
+				);
+				#endif
+
+				(void) pthread_mutex_lock (&connection->requests->mutex);
+				// unless it has already expired
+				bool removed = (requests_get (connection->requests, request->id) == request);
+				if (removed) {
+					(void) requests_remove (connection->requests, request->id);
+					requests_complete (request, REQUEST_STATE_FAILED, NULL);
+				}
+				(void) pthread_mutex_unlock (&connection->requests->mutex);
+
+				// a failed request is not completed by its callback
+				if (removed) request_release (request);
+
+				request_release (request);
+				request = NULL;
+			}
+		}
+
+		else {
+			request_release (request);
+			request = NULL;
+		}
+	}
+
+	return request;
+
+}
+
+Request *client_request_send (
+	Client *client, Connection *connection,
+	const PacketType packet_type, const u32 request_type,
+	const void *data, const size_t data_size,
+	const u32 timeout
+) {
+
+	Request *request = NULL;
+
+	if (client && connection && connection->requests && connection->active) {
+		request = client_request_send_internal (
+			client, connection,
+			packet_type, request_type,
+			data, data_size,
+			timeout,
+			NULL, NULL
+		);
+	}
+
+	return request;
+
+}
+
+u8 client_request_send_callback (
+	Client *client, Connection *connection,
+	const PacketType packet_type, const u32 request_type,
+	const void *data, const size_t data_size,
+	const u32 timeout,
+	RequestCallback callback, void *callback_args
+) {
+
+	u8 retval = 1;
+
+	if (client && connection && connection->requests && connection->active && callback) {
+		Request *request = client_request_send_internal (
+			client, connection,
+			packet_type, request_type,
+			data, data_size,
+			timeout,
+			callback, callback_args
+		);
+
+		if (request) {
+			// only the pending table keeps a reference
+			request_release (request);
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region wait
+
+RequestState request_wait (Request *request, const u32 timeout) {
+
+	RequestState state = REQUEST_STATE_NONE;
+
+	if (request) {
+		state = request_get_state (request);
+
+		if (state == REQUEST_STATE_PENDING) {
+			Requests *requests = request->requests;
+
+			(void) pthread_mutex_lock (&requests->mutex);
+
+			if (timeout) {
+				struct timespec ts = { 0 };
+				requests_deadline_to_timespec (requests_now () + timeout, &ts);
+
+				int result = 0;
+				while (
+					(request->state == REQUEST_STATE_PENDING)
+					&& (result != ETIMEDOUT)
+				) {
+					result = pthread_cond_timedwait (
+						&request->cond, &requests->mutex, &ts
+					);
+				}
+			}
+
+			else {
+				while (request->state == REQUEST_STATE_PENDING) {
+					(void) pthread_cond_wait (&request->cond, &requests->mutex);
+				}
+			}
+
+			state = request->state;
+
+			(void) pthread_mutex_unlock (&requests->mutex);
+		}
+	}
+
+	return state;
+
+}
+
+u8 request_cancel (Request *request) {
+
+	u8 retval = 1;
+
+	if (request && (request_get_state (request) == REQUEST_STATE_PENDING)) {
+		Requests *requests = request->requests;
+
+		(void) pthread_mutex_lock (&requests->mutex);
+
+		// its id may already belong to a newer request
+		bool removed = (requests_get (requests, request->id) == request);
+		if (removed) {
+			(void) requests_remove (requests, request->id);
+			requests_complete (request, REQUEST_STATE_CANCELLED, NULL);
+		}
+
+		(void) pthread_mutex_unlock (&requests->mutex);
+
+		if (removed) {
+			request_completed (request);
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
@@ -0,0 +1,326 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "client/types/types.h"
+
+#include "client/client.h"
+#include "client/handler.h"
+#include "client/packets.h"
+#include "client/routes.h"
+
+#include "client/utils/log.h"
+
+const char *route_mode_to_string (const RouteMode mode) {
+
+	switch (mode) {
+		#define XX(num, name, string, description) case ROUTE_MODE_##name: return #string;
+		ROUTE_MODE_MAP(XX)
+		#undef XX
+	}
+
+	return route_mode_to_string (ROUTE_MODE_INLINE);
+
+}
+
+const char *route_mode_description (const RouteMode mode) {
+
+	switch (mode) {
+		#define XX(num, name, string, description) case ROUTE_MODE_##name: return #description;
+		ROUTE_MODE_MAP(XX)
+		#undef XX
+	}
+
+	return route_mode_description (ROUTE_MODE_INLINE);
+
+}
+
+#pragma region route
+
+static Route *route_new (void) {
+
+	Route *route = (Route *) malloc (sizeof (Route));
+	if (route) {
+		(void) memset (route, 0, sizeof (Route));
+
+		route->packet_type = PACKET_TYPE_NONE;
+		route->mode = ROUTE_MODE_INLINE;
+
+		route->callback = NULL;
+		route->data = NULL;
+		route->handler = NULL;
+	}
+
+	return route;
+
+}
+
+static void route_delete (void *route_ptr) {
+
+	if (route_ptr) free (route_ptr);
+
+}
+
+// sets the data that will be passed to inline callbacks
+void route_set_data (Route *route, void *data) {
+
+	if (route) route->data = data;
+
+}
+
+// sets the handler whose workers will call queued callbacks
+// it must be one of the client's handlers
+void route_set_handler (Route *route, Handler *handler) {
+
+	if (route) route->handler = handler;
+
+}
+
+void route_print (const Route *route) {
+
+	if (route) {
+		client_log_msg (
+			"\tType %u - Request %u (%s): %lu packets, %lu bytes, %lu failed",
+			route->packet_type, route->request_type,
+			route_mode_to_string (route->mode),
+			__atomic_load_n (&route->n_packets, __ATOMIC_RELAXED),
+			__atomic_load_n (&route->n_bytes, __ATOMIC_RELAXED),
+			__atomic_load_n (&route->n_failed, __ATOMIC_RELAXED)
+		);
+	}
+
+}
+
+#pragma endregion
+
+#pragma region routes
+
+// the routes table row of a packet type, -1 if it can't have routes
+static inline int routes_packet_type_index (const PacketType packet_type) {
+
+	int index = -1;
+
+	switch (packet_type) {
+		case PACKET_TYPE_APP: index = 0; break;
+		case PACKET_TYPE_APP_ERROR: index = 1; break;
+		case PACKET_TYPE_CUSTOM: index = 2; break;
+
+		default: break;
+	}
+
+	return index;
+
+}
+
+Routes *routes_create (void) {
+
+	Routes *routes = (Routes *) malloc (sizeof (Routes));
+	if (routes) {
+		(void) memset (routes, 0, sizeof (Routes));
+	}
+
+	return routes;
+
+}
+
+void routes_delete (void *routes_ptr) {
+
+	if (routes_ptr) {
+		Routes *routes = (Routes *) routes_ptr;
+
+		for (unsigned int i = 0; i < ROUTES_N_PACKET_TYPES; i++) {
+			for (unsigned int j = 0; j < ROUTES_MAX_REQUEST_TYPES; j++)
+				route_delete (routes->table[i][j]);
+		}
+
+		free (routes_ptr);
+	}
+
+}
+
+// returns the route for the packet type & request type
+// returns NULL if there is none
+Route *routes_get (
+	const Routes *routes,
+	const PacketType packet_type, const u32 request_type
+) {
+
+	Route *route = NULL;
+
+	if (routes && (request_type < ROUTES_MAX_REQUEST_TYPES)) {
+		int index = routes_packet_type_index (packet_type);
+		if (index >= 0) route = routes->table[index][request_type];
+	}
+
+	return route;
+
+}
+
+// the handler that will call a queued route's callback
+static Handler *routes_packet_handler_get (
+	const Route *route, const Packet *packet
+) {
+
+	Handler *handler = route->handler;
+	if (!handler) {
+		switch (packet->header.packet_type) {
+			case PACKET_TYPE_APP:
+				handler = client_app_handlers_get (
+					packet->client, packet->header.handler_id
+				);
+				break;
+
+			case PACKET_TYPE_APP_ERROR:
+				handler = packet->client->app_error_packet_handler;
+				break;
+
+			case PACKET_TYPE_CUSTOM:
+				handler = packet->client->custom_packet_handler;
+				break;
+
+			default: break;
+		}
+	}
+
+	// the handler is not running any worker
+	if (handler && (handler->direct_handle || !handler->workers)) handler = NULL;
+
+	return handler;
+
+}
+
+static void routes_handle_packet_inline (Route *route, Packet *packet) {
+
+	HandlerData handler_data = {
+		.handler_id = packet->header.handler_id,
+		.worker_id = 0,
+		.data = route->data,
+		.packet = packet
+	};
+
+	route->callback (&handler_data);
+
+	packet_delete (packet);
+
+}
+
+// calls or queues the callback of the packet's route
+// returns 0 if the packet was taken by a route, 1 if it was not
+u8 routes_handle_packet (Routes *routes, Packet *packet) {
+
+	u8 retval = 1;
+
+	Route *route = routes_get (
+		routes, packet->header.packet_type, packet->header.request_type
+	);
+
+	if (route) {
+		(void) __atomic_add_fetch (&route->n_packets, 1, __ATOMIC_RELAXED);
+		(void) __atomic_add_fetch (&route->n_bytes, packet->packet_size, __ATOMIC_RELAXED);
+
+		Handler *handler = NULL;
+		switch (route->mode) {
+			case ROUTE_MODE_QUEUED:
+				handler = routes_packet_handler_get (route, packet);
+				break;
+
+			default: break;
+		}
+
+		if (handler) {
+			if (handler_push_packet (handler, route->callback, packet)) {
+				(void) __atomic_add_fetch (&route->n_failed, 1, __ATOMIC_RELAXED);
+
+				packet_delete (packet);
+			}
+		}
+
+		else {
+			routes_handle_packet_inline (route, packet);
+		}
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+void routes_print (const Routes *routes) {
+
+	if (routes) {
+		for (unsigned int i = 0; i < ROUTES_N_PACKET_TYPES; i++) {
+			for (unsigned int j = 0; j < ROUTES_MAX_REQUEST_TYPES; j++)
+				route_print (routes->table[i][j]);
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region public
+
+// registers a callback to handle the packets with the packet type & request type
+// instead of the client's handler for their packet type
+// must be called before the client starts
+// returns the new route, NULL on error
+Route *client_route_register (
+	Client *client,
+	const PacketType packet_type, const u32 request_type,
+	Action callback, const RouteMode mode
+) {
+
+	Route *route = NULL;
+
+	if (client && callback) {
+		int index = routes_packet_type_index (packet_type);
+		if ((index >= 0) && (request_type < ROUTES_MAX_REQUEST_TYPES)) {
+			if (!client->routes) client->routes = routes_create ();
+
+			if (client->routes && !client->routes->table[index][request_type]) {
+				route = route_new ();
+				if (route) {
+					route->packet_type = packet_type;
+					route->request_type = request_type;
+					route->mode = mode;
+					route->callback = callback;
+
+					client->routes->table[index][request_type] = route;
+					client->routes->n_routes += 1;
+				}
+			}
+
+			else {
+				client_log_error (
+					"Client %s already has a route for type %u - request %u!",
+					client->name, packet_type, request_type
+				);
+			}
+		}
+
+		else {
+			client_log_error (
+				"Client %s can't have a route for type %u - request %u!",
+				client->name, packet_type, request_type
+			);
+		}
+	}
+
+	return route;
+
+}
+
+// returns the client's route for the packet type & request type
+// returns NULL if there is none
+Route *client_route_get (
+	Client *client,
+	const PacketType packet_type, const u32 request_type
+) {
+
+	return client ? routes_get (client->routes, packet_type, request_type) : NULL;
+
+}
+
+#pragma endregion
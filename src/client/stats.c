@@ -0,0 +1,371 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "client/types/types.h"
+
+#include "client/client.h"
+#include "client/connection.h"
+#include "client/packets.h"
+#include "client/stats.h"
+
+#include "client/utils/log.h"
+
+static const char *stats_packet_type_names[PACKETS_MAX_TYPES] = {
+	[PACKET_TYPE_NONE] = "None",
+	[PACKET_TYPE_CERVER] = "Cerver",
+	[PACKET_TYPE_CLIENT] = "Client",
+	[PACKET_TYPE_ERROR] = "Error",
+	[PACKET_TYPE_REQUEST] = "Request",
+	[PACKET_TYPE_AUTH] = "Auth",
+	[PACKET_TYPE_GAME] = "Game",
+	[PACKET_TYPE_APP] = "App",
+	[PACKET_TYPE_APP_ERROR] = "App Error",
+	[PACKET_TYPE_CUSTOM] = "Custom",
+	[PACKET_TYPE_TEST] = "Test",
+	[PACKET_TYPE_BAD] = "Bad"
+};
+
+// the shard of the calling thread, assigned on its first update
+static unsigned int stats_next_shard = 0;
+static __thread unsigned int stats_thread_shard = STATS_N_SHARDS;
+
+#pragma region shards
+
+// allocates cache line aligned shards
+StatsShard *stats_shards_create (const unsigned int n_shards) {
+
+	StatsShard *shards = NULL;
+
+	if (n_shards) {
+		shards = (StatsShard *) aligned_alloc (
+			STATS_CACHE_LINE_SIZE, n_shards * sizeof (StatsShard)
+		);
+
+		if (shards) {
+			(void) memset (shards, 0, n_shards * sizeof (StatsShard));
+		}
+	}
+
+	return shards;
+
+}
+
+void stats_shards_delete (void *shards_ptr) {
+
+	if (shards_ptr) free (shards_ptr);
+
+}
+
+// returns the client's shard that is updated by the calling thread
+StatsShard *stats_shard_get (StatsShard *shards) {
+
+	if (stats_thread_shard == STATS_N_SHARDS) {
+		stats_thread_shard = __atomic_fetch_add (
+			&stats_next_shard, 1, __ATOMIC_RELAXED
+		) % STATS_N_SHARDS;
+	}
+
+	return &shards[stats_thread_shard];
+
+}
+
+#pragma endregion
+
+#pragma region count
+
+static inline unsigned int stats_packet_type_index (const PacketType packet_type) {
+
+	return ((unsigned int) packet_type < PACKETS_MAX_TYPES) ?
+		(unsigned int) packet_type : PACKET_TYPE_BAD;
+
+}
+
+// returns the sizes bucket of a packet of size bytes
+unsigned int stats_size_bucket (const size_t size) {
+
+	unsigned int bucket = 0;
+
+	if (size > ((size_t) 1 << STATS_SIZES_MIN_SHIFT)) {
+		bucket = (unsigned int) (
+			(64 - __builtin_clzll ((unsigned long long) (size - 1)))
+			- STATS_SIZES_MIN_SHIFT
+		);
+
+		if (bucket >= STATS_SIZES_BUCKETS) bucket = STATS_SIZES_BUCKETS - 1;
+	}
+
+	return bucket;
+
+}
+
+// returns the biggest packet size that is counted in the bucket
+size_t stats_size_bucket_limit (const unsigned int bucket) {
+
+	return (bucket < (STATS_SIZES_BUCKETS - 1)) ?
+		((size_t) 1 << (STATS_SIZES_MIN_SHIFT + bucket)) : (size_t) -1;
+
+}
+
+static inline void stats_add (u64 *counter, const u64 value) {
+
+	(void) __atomic_add_fetch (counter, value, __ATOMIC_RELAXED);
+
+}
+
+static inline void stats_count_packet (
+	PacketsStats *stats,
+	const unsigned int index, const unsigned int bucket, const size_t size
+) {
+
+	stats_add (&stats->packets[index], 1);
+	stats_add (&stats->bytes[index], size);
+	stats_add (&stats->sizes[index][bucket], 1);
+
+}
+
+// counts a call to recv () in the client & connection stats
+void stats_count_receive (
+	Client *client, Connection *connection,
+	const size_t received
+) {
+
+	if (client) {
+		StatsShard *shard = stats_shard_get (client->stats->shards);
+		stats_add (&shard->n_receives_done, 1);
+		stats_add (&shard->total_bytes_received, received);
+	}
+
+	#ifdef CONNECTION_STATS
+	if (connection) {
+		stats_add (&connection->stats->counters->n_receives_done, 1);
+		stats_add (&connection->stats->counters->total_bytes_received, received);
+	}
+	#else
+	(void) connection;
+	#endif
+
+}
+
+// counts a received packet in the client & connection stats
+void stats_count_received (
+	Client *client, Connection *connection,
+	const PacketType packet_type, const size_t packet_size
+) {
+
+	unsigned int index = stats_packet_type_index (packet_type);
+	unsigned int bucket = stats_size_bucket (packet_size);
+
+	if (client) {
+		stats_count_packet (
+			&stats_shard_get (client->stats->shards)->received,
+			index, bucket, packet_size
+		);
+	}
+
+	if (connection) {
+		stats_count_packet (
+			&connection->stats->counters->received,
+			index, bucket, packet_size
+		);
+	}
+
+}
+
+// counts a sent packet in the client & connection stats
+void stats_count_sent (
+	Client *client, Connection *connection,
+	const PacketType packet_type, const size_t sent
+) {
+
+	unsigned int index = stats_packet_type_index (packet_type);
+	unsigned int bucket = stats_size_bucket (sent);
+
+	if (client) {
+		stats_count_packet (
+			&stats_shard_get (client->stats->shards)->sent,
+			index, bucket, sent
+		);
+	}
+
+	if (connection) {
+		stats_count_packet (
+			&connection->stats->counters->sent,
+			index, bucket, sent
+		);
+	}
+
+}
+
+// counts a packet that failed to be sent in the client & connection stats
+void stats_count_send_failed (Client *client, Connection *connection) {
+
+	if (client) stats_add (&stats_shard_get (client->stats->shards)->n_send_failed, 1);
+
+	if (connection) stats_add (&connection->stats->counters->n_send_failed, 1);
+
+}
+
+// counts a packet dropped by a handler in the client & connection stats
+void stats_count_shed (
+	Client *client, Connection *connection,
+	const PacketType packet_type
+) {
+
+	unsigned int index = stats_packet_type_index (packet_type);
+
+	if (client) stats_add (&stats_shard_get (client->stats->shards)->shed[index], 1);
+
+	if (connection) stats_add (&connection->stats->counters->shed[index], 1);
+
+}
+
+#pragma endregion
+
+#pragma region snapshot
+
+static inline u64 stats_load (const u64 *counter) {
+
+	return __atomic_load_n (counter, __ATOMIC_RELAXED);
+
+}
+
+static void stats_packets_merge (
+	PacketsStats *dest, const PacketsStats *source
+) {
+
+	for (unsigned int type = 0; type < PACKETS_MAX_TYPES; type++) {
+		dest->packets[type] += stats_load (&source->packets[type]);
+		dest->bytes[type] += stats_load (&source->bytes[type]);
+
+		for (unsigned int bucket = 0; bucket < STATS_SIZES_BUCKETS; bucket++)
+			dest->sizes[type][bucket] += stats_load (&source->sizes[type][bucket]);
+	}
+
+}
+
+// merges the shards values into the snapshot
+void stats_shards_snapshot (
+	const StatsShard *shards, const unsigned int n_shards,
+	StatsSnapshot *snapshot
+) {
+
+	(void) memset (snapshot, 0, sizeof (StatsSnapshot));
+
+	for (unsigned int i = 0; i < n_shards; i++) {
+		snapshot->n_receives_done += stats_load (&shards[i].n_receives_done);
+		snapshot->total_bytes_received += stats_load (&shards[i].total_bytes_received);
+		snapshot->n_send_failed += stats_load (&shards[i].n_send_failed);
+
+		stats_packets_merge (&snapshot->received, &shards[i].received);
+		stats_packets_merge (&snapshot->sent, &shards[i].sent);
+
+		for (unsigned int type = 0; type < PACKETS_MAX_TYPES; type++)
+			snapshot->shed[type] += stats_load (&shards[i].shed[type]);
+	}
+
+	// the totals are taken from the copied values
+	// so they always match the values of each type
+	for (unsigned int type = 0; type < PACKETS_MAX_TYPES; type++) {
+		snapshot->n_packets_received += snapshot->received.packets[type];
+		snapshot->n_packets_sent += snapshot->sent.packets[type];
+		snapshot->n_packets_shed += snapshot->shed[type];
+
+		snapshot->total_bytes_sent += snapshot->sent.bytes[type];
+	}
+
+}
+
+// gets the sum of the stats of every client's shard
+void client_stats_get (const Client *client, StatsSnapshot *snapshot) {
+
+	if (snapshot) {
+		if (client && client->stats) {
+			stats_shards_snapshot (client->stats->shards, STATS_N_SHARDS, snapshot);
+		}
+
+		else {
+			(void) memset (snapshot, 0, sizeof (StatsSnapshot));
+		}
+	}
+
+}
+
+// gets the packets stats of the connection
+void connection_stats_get (
+	const Connection *connection, StatsSnapshot *snapshot
+) {
+
+	if (snapshot) {
+		if (connection && connection->stats) {
+			stats_shards_snapshot (connection->stats->counters, 1, snapshot);
+		}
+
+		else {
+			(void) memset (snapshot, 0, sizeof (StatsSnapshot));
+		}
+	}
+
+}
+
+void stats_snapshot_print (const StatsSnapshot *snapshot) {
+
+	if (snapshot) {
+		client_log_msg ("N receives done:           %lu", snapshot->n_receives_done);
+
+		client_log_msg ("Total bytes received:      %lu", snapshot->total_bytes_received);
+		client_log_msg ("Total bytes sent:          %lu", snapshot->total_bytes_sent);
+
+		client_log_msg ("N packets received:        %lu", snapshot->n_packets_received);
+		client_log_msg ("N packets sent:            %lu", snapshot->n_packets_sent);
+		client_log_msg ("N packets shed:            %lu", snapshot->n_packets_shed);
+		client_log_msg ("N send failed:             %lu", snapshot->n_send_failed);
+
+		client_log_msg ("\nReceived packets:");
+		packets_per_type_array_print (snapshot->received.packets);
+		packets_stats_sizes_print (&snapshot->received);
+
+		client_log_msg ("\nSent packets:");
+		packets_per_type_array_print (snapshot->sent.packets);
+		packets_stats_sizes_print (&snapshot->sent);
+
+		client_log_msg ("\nShed packets:");
+		packets_per_type_array_print (snapshot->shed);
+	}
+
+}
+
+// prints the sizes of the packets of each type that has packets
+void packets_stats_sizes_print (const PacketsStats *stats) {
+
+	if (stats) {
+		for (unsigned int type = 0; type < PACKETS_MAX_TYPES; type++) {
+			if (stats->packets[type] && stats_packet_type_names[type]) {
+				client_log_msg (
+					"\t%s sizes (%lu bytes):",
+					stats_packet_type_names[type], stats->bytes[type]
+				);
+
+				for (unsigned int bucket = 0; bucket < STATS_SIZES_BUCKETS; bucket++) {
+					if (stats->sizes[type][bucket]) {
+						if (bucket < (STATS_SIZES_BUCKETS - 1)) {
+							client_log_msg (
+								"\t\t<= %-10lu %lu",
+								stats_size_bucket_limit (bucket), stats->sizes[type][bucket]
+							);
+						}
+
+						else {
+							client_log_msg (
+								"\t\t>  %-10lu %lu",
+								stats_size_bucket_limit (bucket - 1), stats->sizes[type][bucket]
+							);
+						}
+					}
+				}
+			}
+		}
+	}
+
+}
+
+#pragma endregion
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 
 #include "client/collections/dlist.h"
+#include "client/collections/ring.h"
 
 #include "client/threads/bsem.h"
 #include "client/threads/jobs.h"
@@ -59,9 +60,14 @@ Job *job_create (void (*work) (void *args), void *args) {
 
 }
 
+// the pool is shared by the producers & consumers of the queue
 Job *job_get (JobQueue *job_queue) {
 
-	return (Job *) pool_pop (job_queue->pool);
+	(void) pthread_mutex_lock (job_queue->rwmutex);
+	Job *job = (Job *) pool_pop (job_queue->pool);
+	(void) pthread_mutex_unlock (job_queue->rwmutex);
+
+	return job;
 
 }
 
@@ -78,7 +84,10 @@ void job_return (
 
 	if (job_queue && job) {
 		job_reset (job);
+
+		(void) pthread_mutex_lock (job_queue->rwmutex);
 		(void) pool_push (job_queue->pool, job);
+		(void) pthread_mutex_unlock (job_queue->rwmutex);
 	}
 
 }
@@ -139,7 +148,11 @@ void *job_handler_create (void) {
 
 JobHandler *job_handler_get (JobQueue *job_queue) {
 
-	return (JobHandler *) pool_pop (job_queue->pool);
+	(void) pthread_mutex_lock (job_queue->rwmutex);
+	JobHandler *job_handler = (JobHandler *) pool_pop (job_queue->pool);
+	(void) pthread_mutex_unlock (job_queue->rwmutex);
+
+	return job_handler;
 
 }
 
@@ -179,7 +192,10 @@ void job_handler_return (
 
 	if (job_queue && job_handler) {
 		job_handler_reset (job_handler);
+
+		(void) pthread_mutex_lock (job_queue->rwmutex);
 		(void) pool_push (job_queue->pool, job_handler);
+		(void) pthread_mutex_unlock (job_queue->rwmutex);
 	}
 
 }
@@ -189,7 +205,7 @@ void job_handler_wait (
 	void *data, void (*data_delete) (void *data_ptr)
 ) {
 
-	JobHandler *handler = (JobHandler *) pool_pop (job_queue->pool);
+	JobHandler *handler = job_handler_get (job_queue);
 	if (handler) {
 		handler->data = data;
 		handler->data_delete = data_delete;
@@ -224,6 +240,8 @@ JobQueue *job_queue_new (void) {
 
 		job_queue->queue = NULL;
 
+		job_queue->ring = NULL;
+
 		job_queue->rwmutex = NULL;
 		job_queue->has_jobs = NULL;
 
@@ -253,6 +271,8 @@ void job_queue_delete (void *job_queue_ptr) {
 		// job_queue_clear (job_queue);
 		dlist_delete (job_queue->queue);
 
+		ring_delete (job_queue->ring);
+
 		if (job_queue->rwmutex) {
 			(void) pthread_mutex_unlock (job_queue->rwmutex);
 			(void) pthread_mutex_destroy (job_queue->rwmutex);
@@ -339,6 +359,38 @@ void job_queue_set_handler (
 
 }
 
+// replaces the queue's list with a bounded ring of jobs
+// must be called while the queue is still empty
+// pushes fail when the ring is full & requests by id are not supported
+// returns 0 on success, 1 on error
+unsigned int job_queue_set_ring (
+	JobQueue *job_queue,
+	const RingType type, const size_t capacity
+) {
+
+	unsigned int retval = 1;
+
+	if (job_queue && !job_queue->ring && !dlist_size (job_queue->queue)) {
+		job_queue->ring = ring_create (type, capacity, sizeof (Job));
+		if (job_queue->ring) retval = 0;
+	}
+
+	return retval;
+
+}
+
+static unsigned int job_queue_push_ring (
+	JobQueue *job_queue, const Job *job
+) {
+
+	unsigned int retval = ring_push (job_queue->ring, job);
+
+	if (!retval) bsem_post (job_queue->has_jobs);
+
+	return retval;
+
+}
+
 static unsigned int job_queue_push_internal (
 	JobQueue *job_queue, void *job_ptr
 ) {
@@ -365,8 +417,20 @@ static unsigned int job_queue_push_internal (
 // returns 0 on success, 1 on error
 unsigned int job_queue_push (JobQueue *job_queue, void *job_ptr) {
 
-	return (job_queue && job_ptr) ?
-		job_queue_push_internal (job_queue, job_ptr) : 1;
+	unsigned int retval = 1;
+
+	if (job_queue && job_ptr) {
+		if (job_queue->ring) {
+			Job job = { .id = 0, .work = NULL, .args = job_ptr };
+			retval = job_queue_push_ring (job_queue, &job);
+		}
+
+		else {
+			retval = job_queue_push_internal (job_queue, job_ptr);
+		}
+	}
+
+	return retval;
 
 }
 
@@ -378,15 +442,26 @@ unsigned int job_queue_push_job (
 	unsigned int retval = 1;
 
 	if (job_queue) {
-		Job *job = (Job *) pool_pop (job_queue->pool);
-		if (job) {
-			job->work = work;
-			job->args = args;
+		if (job_queue->ring) {
+			Job job = { .id = 0, .work = work, .args = args };
+			retval = job_queue_push_ring (job_queue, &job);
+		}
 
-			if (!job_queue_push_internal (
-				job_queue, job
-			)) {
-				retval = 0;
+		else {
+			Job *job = job_get (job_queue);
+			if (job) {
+				job->work = work;
+				job->args = args;
+
+				if (!job_queue_push_internal (
+					job_queue, job
+				)) {
+					retval = 0;
+				}
+
+				else {
+					job_return (job_queue, job);
+				}
 			}
 		}
 	}
@@ -433,8 +508,13 @@ unsigned int job_queue_push_job_with_id (
 
 	unsigned int retval = 1;
 
-	if (job_queue) {
-		Job *job = (Job *) pool_pop (job_queue->pool);
+	if (job_queue && job_queue->ring) {
+		Job job = { .id = job_id, .work = work, .args = args };
+		retval = job_queue_push_ring (job_queue, &job);
+	}
+
+	else if (job_queue) {
+		Job *job = job_get (job_queue);
 		if (job) {
 			job->id = job_id;
 			job->work = work;
@@ -460,7 +540,7 @@ unsigned int job_queue_push_handler (
 	unsigned int retval = 1;
 
 	if (job_queue) {
-		JobHandler *job_handler = (JobHandler *) pool_pop (job_queue->pool);
+		JobHandler *job_handler = job_handler_get (job_queue);
 		if (job_handler) {
 			job_handler->cerver = cerver;
 			job_handler->connection = connection;
@@ -485,7 +565,12 @@ void *job_queue_pull (JobQueue *job_queue) {
 
 	void *retval = NULL;
 
-	if (job_queue) {
+	if (job_queue && job_queue->ring) {
+		Job job = { 0 };
+		if (!job_queue_pull_job (job_queue, &job)) retval = job.args;
+	}
+
+	else if (job_queue) {
 		(void) pthread_mutex_lock (job_queue->rwmutex);
 
 		switch (job_queue->queue->size) {
@@ -510,13 +595,122 @@ void *job_queue_pull (JobQueue *job_queue) {
 
 }
 
+// copies the job at the start of the queue into job
+// works with jobs pushed using job_queue_push_job ()
+// returns 0 on success, 1 if the queue is empty
+unsigned int job_queue_pull_job (JobQueue *job_queue, Job *job) {
+
+	unsigned int retval = 1;
+
+	if (job_queue && job) {
+		if (job_queue->ring) {
+			retval = ring_pop (job_queue->ring, job);
+
+			// there are still jobs left for the next pull
+			if (!retval && !ring_is_empty (job_queue->ring))
+				bsem_post (job_queue->has_jobs);
+		}
+
+		else {
+			Job *pulled = (Job *) job_queue_pull (job_queue);
+			if (pulled) {
+				*job = *pulled;
+				job_return (job_queue, pulled);
+
+				retval = 0;
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+// copies up to max jobs from the start of the queue into jobs
+// returns the number of jobs that were copied
+unsigned int job_queue_pull_jobs (
+	JobQueue *job_queue, Job *jobs, const unsigned int max
+) {
+
+	unsigned int n_jobs = 0;
+
+	if (job_queue && jobs) {
+		if (job_queue->ring) {
+			while ((n_jobs < max) && !ring_pop (job_queue->ring, &jobs[n_jobs]))
+				n_jobs += 1;
+
+			if (!ring_is_empty (job_queue->ring)) bsem_post (job_queue->has_jobs);
+		}
+
+		else {
+			(void) pthread_mutex_lock (job_queue->rwmutex);
+
+			Job *pulled = NULL;
+			while ((n_jobs < max) && job_queue->queue->size) {
+				// remove at the start of the list
+				pulled = (Job *) dlist_remove_element (job_queue->queue, NULL);
+				jobs[n_jobs] = *pulled;
+				job_reset (pulled);
+				(void) pool_push (job_queue->pool, pulled);
+
+				n_jobs += 1;
+			}
+
+			// there are still jobs left for the next pull
+			if (job_queue->queue->size) bsem_post (job_queue->has_jobs);
+
+			(void) pthread_mutex_unlock (job_queue->rwmutex);
+		}
+	}
+
+	return n_jobs;
+
+}
+
+// gets up to max jobs from the start of the queue
+// returns the number of jobs that were placed in jobs
+unsigned int job_queue_pull_many (
+	JobQueue *job_queue, void **jobs, const unsigned int max
+) {
+
+	unsigned int n_jobs = 0;
+
+	if (job_queue && jobs && job_queue->ring) {
+		Job job = { 0 };
+		while ((n_jobs < max) && !ring_pop (job_queue->ring, &job)) {
+			jobs[n_jobs] = job.args;
+			n_jobs += 1;
+		}
+
+		if (!ring_is_empty (job_queue->ring)) bsem_post (job_queue->has_jobs);
+	}
+
+	else if (job_queue && jobs) {
+		(void) pthread_mutex_lock (job_queue->rwmutex);
+
+		while ((n_jobs < max) && job_queue->queue->size) {
+			// remove at the start of the list
+			jobs[n_jobs] = dlist_remove_element (job_queue->queue, NULL);
+			n_jobs += 1;
+		}
+
+		// there are still jobs left for the next pull
+		if (job_queue->queue->size) bsem_post (job_queue->has_jobs);
+
+		(void) pthread_mutex_unlock (job_queue->rwmutex);
+	}
+
+	return n_jobs;
+
+}
+
 // requests to get an specific job from the queue by matching id
 // blocks and waits until the requested job is available
 void *job_queue_request (JobQueue *job_queue, const u64 job_id) {
 
 	void *match = NULL;
 
-	if (job_queue) {
+	if (job_queue && !job_queue->ring) {
 		(void) pthread_mutex_lock (job_queue->rwmutex);
 
 		// check if the job is already in the queue
@@ -560,21 +754,18 @@ static void *job_queue_jobs (void *job_queue_ptr) {
 
 	JobQueue *job_queue = (JobQueue *) job_queue_ptr;
 
-	Job *job = NULL;
+	Job job = { 0 };
 	while (job_queue->running) {
 		bsem_wait (job_queue->has_jobs);
 
-		job = (Job *) job_queue_pull (job_queue);
-		if (job) {
+		if (!job_queue_pull_job (job_queue, &job)) {
 			#ifdef THREADS_DEBUG
 			client_log_debug ("job_queue_jobs () new job!");
 			#endif
 
 			// do work
-			if (job->work)
-				job->work (job->args);
-
-			job_return (job_queue, job);
+			if (job.work)
+				job.work (job.args);
 		}
 	}
 
@@ -676,12 +867,36 @@ unsigned int job_queue_stop (JobQueue *job_queue) {
 
 }
 
+// returns how many jobs are waiting in the queue
+size_t job_queue_size (JobQueue *job_queue) {
+
+	size_t size = 0;
+
+	if (job_queue && job_queue->ring) {
+		size = ring_size (job_queue->ring);
+	}
+
+	else if (job_queue) {
+		(void) pthread_mutex_lock (job_queue->rwmutex);
+		size = dlist_size (job_queue->queue);
+		(void) pthread_mutex_unlock (job_queue->rwmutex);
+	}
+
+	return size;
+
+}
+
 // clears the job queue -> destroys all jobs
 void job_queue_clear (JobQueue *job_queue) {
 
 	if (job_queue) {
 		dlist_reset (job_queue->queue);
 
+		if (job_queue->ring) {
+			Job job = { 0 };
+			while (!ring_pop (job_queue->ring, &job));
+		}
+
 		bsem_reset (job_queue->has_jobs);
 	}
 
@@ -0,0 +1,1480 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#include <linux/io_uring.h>
+
+#include <pthread.h>
+
+#include "client/types/types.h"
+
+#include "client/client.h"
+#include "client/connection.h"
+#include "client/handler.h"
+#include "client/receive.h"
+#include "client/socket.h"
+#include "client/stats.h"
+#include "client/uring.h"
+
+#include "client/threads/thread.h"
+
+#include "client/utils/log.h"
+
+// multishot receives with provided buffer rings
+// are only available in the latest kernel headers
+#if defined (IORING_RECV_MULTISHOT) && defined (__NR_io_uring_setup)
+
+// the kind of operation is stored in the lower bits of an sqe user data
+#define URING_TAG_RECV				0
+#define URING_TAG_REQUEST			1
+#define URING_TAG_EVENT				2
+#define URING_TAG_CANCEL			3
+
+#define URING_TAG_MASK				3
+
+static void uring_connection_delete (UringConnection *uc);
+
+static void uring_send_cancel (Uring *uring, Connection *connection);
+
+#pragma region syscalls
+
+static inline int uring_setup_syscall (
+	unsigned int entries, struct io_uring_params *params
+) {
+
+	return (int) syscall (__NR_io_uring_setup, entries, params);
+
+}
+
+static inline int uring_enter_syscall (
+	int ring_fd,
+	unsigned int to_submit, unsigned int min_complete, unsigned int flags
+) {
+
+	return (int) syscall (
+		__NR_io_uring_enter,
+		ring_fd, to_submit, min_complete, flags, NULL, 0
+	);
+
+}
+
+static inline int uring_register_syscall (
+	int ring_fd, unsigned int opcode, void *arg, unsigned int n_args
+) {
+
+	return (int) syscall (
+		__NR_io_uring_register, ring_fd, opcode, arg, n_args
+	);
+
+}
+
+#pragma endregion
+
+#pragma region queues
+
+static inline u64 uring_user_data (void *ptr, u64 tag) {
+
+	return (u64) (uintptr_t) ptr | tag;
+
+}
+
+static inline void *uring_user_data_ptr (u64 user_data) {
+
+	return (void *) (uintptr_t) (user_data & ~((u64) URING_TAG_MASK));
+
+}
+
+static void uring_submit (Uring *uring) {
+
+	if (uring->to_submit) {
+		int submitted = uring_enter_syscall (
+			uring->ring_fd, uring->to_submit, 0, 0
+		);
+
+		if (submitted > 0) uring->to_submit -= (unsigned int) submitted;
+	}
+
+}
+
+// gets the next free submission entry
+// submits the pending entries if the queue is full
+static struct io_uring_sqe *uring_get_sqe (Uring *uring) {
+
+	struct io_uring_sqe *sqe = NULL;
+
+	unsigned int tail = *uring->sq_tail;
+	unsigned int head = __atomic_load_n (uring->sq_head, __ATOMIC_ACQUIRE);
+
+	if ((tail - head) >= uring->entries) {
+		uring_submit (uring);
+		head = __atomic_load_n (uring->sq_head, __ATOMIC_ACQUIRE);
+	}
+
+	if ((tail - head) < uring->entries) {
+		unsigned int index = tail & *uring->sq_mask;
+
+		sqe = &uring->sqes[index];
+		(void) memset (sqe, 0, sizeof (struct io_uring_sqe));
+
+		uring->sq_array[index] = index;
+		__atomic_store_n (uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+		uring->to_submit += 1;
+	}
+
+	return sqe;
+
+}
+
+static void uring_prep_event_read (Uring *uring) {
+
+	struct io_uring_sqe *sqe = uring_get_sqe (uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = uring->event_fd;
+		sqe->addr = (u64) (uintptr_t) &uring->event_value;
+		sqe->len = sizeof (u64);
+		sqe->user_data = uring_user_data (NULL, URING_TAG_EVENT);
+
+		uring->n_inflight += 1;
+	}
+
+}
+
+static void uring_prep_recv (UringConnection *uc) {
+
+	struct io_uring_sqe *sqe = uring_get_sqe (uc->uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = uc->sock_fd;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = uc->group;
+		sqe->ioprio = uc->multishot ? IORING_RECV_MULTISHOT : 0;
+		sqe->user_data = uring_user_data (uc, URING_TAG_RECV);
+
+		uc->armed = true;
+		uc->uring->n_inflight += 1;
+	}
+
+	else {
+		uc->failed = true;
+	}
+
+}
+
+static void uring_prep_send (Uring *uring, UringRequest *request) {
+
+	struct io_uring_sqe *sqe = uring_get_sqe (uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_SEND;
+		sqe->fd = request->sock_fd;
+		sqe->addr = (u64) (uintptr_t) (request->data + request->sent);
+		sqe->len = (u32) (request->size - request->sent);
+		sqe->msg_flags = (u32) (request->flags | MSG_NOSIGNAL);
+		sqe->user_data = uring_user_data (request, URING_TAG_REQUEST);
+
+		uring->n_inflight += 1;
+	}
+
+	else {
+		request->result = -EBUSY;
+	}
+
+}
+
+static void uring_prep_cancel (Uring *uring, u64 user_data, u32 flags) {
+
+	struct io_uring_sqe *sqe = uring_get_sqe (uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = user_data;
+		sqe->cancel_flags = flags;
+		sqe->user_data = uring_user_data (NULL, URING_TAG_CANCEL);
+	}
+
+}
+
+#pragma endregion
+
+#pragma region connections
+
+// takes the first free buffer group id after the last one taken
+// returns false if every id is being used
+static bool uring_group_take (Uring *uring, u16 *group) {
+
+	bool taken = false;
+
+	u16 start = __atomic_load_n (&uring->next_group, __ATOMIC_RELAXED);
+	for (unsigned int i = 0; !taken && (i < URING_MAX_GROUPS); i++) {
+		u16 id = (u16) (start + i);
+		u64 bit = (u64) 1 << (id % 64);
+
+		if (!(__atomic_fetch_or (&uring->groups[id / 64], bit, __ATOMIC_ACQ_REL) & bit)) {
+			__atomic_store_n (&uring->next_group, (u16) (id + 1), __ATOMIC_RELAXED);
+
+			*group = id;
+			taken = true;
+		}
+	}
+
+	return taken;
+
+}
+
+static inline void uring_group_release (Uring *uring, u16 group) {
+
+	(void) __atomic_fetch_and (
+		&uring->groups[group / 64], ~((u64) 1 << (group % 64)), __ATOMIC_RELEASE
+	);
+
+}
+
+static UringConnection *uring_connection_new (void) {
+
+	UringConnection *uc = (UringConnection *) malloc (sizeof (UringConnection));
+	if (uc) {
+		uc->uring = NULL;
+
+		uc->connection = NULL;
+		uc->sock_fd = -1;
+
+		uc->multishot = true;
+		uc->armed = false;
+		uc->failed = false;
+		uc->closed = false;
+
+		uc->has_group = false;
+		uc->group = 0;
+		uc->buf_ring = NULL;
+		uc->buf_ring_size = 0;
+
+		uc->buffers = NULL;
+		uc->buffer_size = 0;
+		uc->n_buffers = 0;
+
+		uc->next_closed = NULL;
+	}
+
+	return uc;
+
+}
+
+static void uring_connection_delete (UringConnection *uc) {
+
+	if (uc) {
+		if (uc->buf_ring) {
+			struct io_uring_buf_reg reg = { 0 };
+			reg.bgid = uc->group;
+
+			(void) uring_register_syscall (
+				uc->uring->ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1
+			);
+
+			(void) munmap (uc->buf_ring, uc->buf_ring_size);
+		}
+
+		// the id can only be reused once its buffers ring is unregistered
+		if (uc->has_group) uring_group_release (uc->uring, uc->group);
+
+		free (uc->buffers);
+
+		free (uc);
+	}
+
+}
+
+// gives the buffer back to the kernel to be used in another receive
+static inline void uring_connection_recycle (
+	UringConnection *uc, u16 bid
+) {
+
+	struct io_uring_buf_ring *br = uc->buf_ring;
+	u16 tail = br->tail;
+
+	struct io_uring_buf *buf = &br->bufs[tail & (uc->n_buffers - 1)];
+	buf->addr = (u64) (uintptr_t) (uc->buffers + ((size_t) bid * uc->buffer_size));
+	buf->len = (u32) uc->buffer_size;
+	buf->bid = bid;
+
+	__atomic_store_n (&br->tail, (u16) (tail + 1), __ATOMIC_RELEASE);
+
+}
+
+static UringConnection *uring_connection_create (
+	Uring *uring, Connection *connection
+) {
+
+	UringConnection *uc = uring_connection_new ();
+	if (uc) {
+		uc->uring = uring;
+		uc->connection = connection;
+		uc->sock_fd = connection->socket->sock_fd;
+
+		uc->has_group = uring_group_take (uring, &uc->group);
+
+		uc->n_buffers = URING_DEFAULT_N_BUFFERS;
+		uc->buffer_size = connection->receive_packet_buffer_size;
+		uc->buffers = (char *) malloc (uc->n_buffers * uc->buffer_size);
+
+		uc->buf_ring_size = uc->n_buffers * sizeof (struct io_uring_buf);
+		void *buf_ring = mmap (
+			NULL, uc->buf_ring_size,
+			PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE,
+			-1, 0
+		);
+
+		uc->buf_ring = (buf_ring != MAP_FAILED) ? (struct io_uring_buf_ring *) buf_ring : NULL;
+
+		u8 errors = 1;
+		if (uc->has_group && uc->buffers && uc->buf_ring) {
+			for (unsigned int bid = 0; bid < uc->n_buffers; bid++)
+				uring_connection_recycle (uc, (u16) bid);
+
+			struct io_uring_buf_reg reg = { 0 };
+			reg.ring_addr = (u64) (uintptr_t) uc->buf_ring;
+			reg.ring_entries = uc->n_buffers;
+			reg.bgid = uc->group;
+
+			errors = (u8) (uring_register_syscall (
+				uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1
+			) < 0);
+		}
+
+		if (errors) {
+			if (uc->buf_ring) {
+				(void) munmap (uc->buf_ring, uc->buf_ring_size);
+				uc->buf_ring = NULL;
+			}
+
+			uring_connection_delete (uc);
+			uc = NULL;
+		}
+	}
+
+	return uc;
+
+}
+
+// the connection's state can only be deleted
+// after its connection has been removed and its receive has ended
+static void uring_connection_check_closed (UringConnection *uc) {
+
+	if (!uc->connection && !uc->armed && !uc->closed) {
+		uc->closed = true;
+
+		uc->next_closed = uc->uring->closed;
+		uc->uring->closed = uc;
+	}
+
+}
+
+// called by the ring's thread when the connection is removed
+static void uring_connection_remove (UringConnection *uc) {
+
+	if (uc->connection) uring_send_cancel (uc->uring, uc->connection);
+
+	uc->connection = NULL;
+
+	if (uc->armed) {
+		uring_prep_cancel (
+			uc->uring, uring_user_data (uc, URING_TAG_RECV), 0
+		);
+	}
+
+	uring_connection_check_closed (uc);
+
+}
+
+#pragma endregion
+
+#pragma region thread
+
+static void uring_request_finish (
+	Uring *uring, UringRequest *request, int result
+) {
+
+	if (request->connection) {
+		(void) __atomic_sub_fetch (
+			&request->connection->uring_pending_sends, 1, __ATOMIC_RELEASE
+		);
+	}
+
+	// nobody waits for an async send
+	if (request->async) {
+		free (request);
+	}
+
+	else {
+		(void) pthread_mutex_lock (&uring->lock);
+
+		request->result = result;
+		request->done = true;
+		(void) pthread_cond_signal (&request->cond);
+
+		(void) pthread_mutex_unlock (&uring->lock);
+	}
+
+}
+
+// starts the connection's first send
+// the ones that can't be started are finished right away
+static void uring_send_start (Uring *uring, Connection *connection) {
+
+	UringRequest *request = connection->uring_sends;
+	while (request) {
+		if (!uring->stopping) uring_prep_send (uring, request);
+		else request->result = -ECANCELED;
+
+		if (!request->result) break;
+
+		// the connection can be released once its last send is finished
+		UringRequest *next = request->next_send;
+		connection->uring_sends = next;
+		if (!next) connection->uring_sends_tail = NULL;
+
+		uring_request_finish (uring, request, request->result);
+
+		request = next;
+	}
+
+}
+
+// a connection's sends are made one after the other
+// so their data is never mixed in its socket
+static void uring_send_add (Uring *uring, UringRequest *request) {
+
+	Connection *connection = request->connection;
+
+	request->next_send = NULL;
+
+	if (connection->uring_sends_tail) {
+		connection->uring_sends_tail->next_send = request;
+		connection->uring_sends_tail = request;
+	}
+
+	else {
+		connection->uring_sends = request;
+		connection->uring_sends_tail = request;
+
+		uring_send_start (uring, connection);
+	}
+
+}
+
+// ends the sends of a connection that is being removed
+// the one in flight is canceled & finished when its completion arrives
+static void uring_send_cancel (Uring *uring, Connection *connection) {
+
+	UringRequest *request = connection->uring_sends;
+
+	connection->uring_sends = NULL;
+	connection->uring_sends_tail = NULL;
+
+	if (request) {
+		(void) __atomic_sub_fetch (
+			&connection->uring_pending_sends, 1, __ATOMIC_RELEASE
+		);
+
+		request->connection = NULL;
+		uring_prep_cancel (
+			uring, uring_user_data (request, URING_TAG_REQUEST), 0
+		);
+
+		request = request->next_send;
+		while (request) {
+			UringRequest *next = request->next_send;
+			uring_request_finish (uring, request, -ECANCELED);
+			request = next;
+		}
+	}
+
+}
+
+static void uring_handle_request (Uring *uring, UringRequest *request) {
+
+	switch (request->type) {
+		case URING_REQUEST_TYPE_SEND: {
+			uring_send_add (uring, request);
+		} break;
+
+		case URING_REQUEST_TYPE_ADD: {
+			if (!uring->stopping) {
+				uring_prep_recv (request->uring_connection);
+				uring_request_finish (
+					uring, request,
+					request->uring_connection->failed ? -EBUSY : 0
+				);
+			}
+
+			else {
+				uring_request_finish (uring, request, -ECANCELED);
+			}
+		} break;
+
+		case URING_REQUEST_TYPE_REMOVE: {
+			uring_connection_remove (request->uring_connection);
+			uring_request_finish (uring, request, 0);
+		} break;
+
+		default: break;
+	}
+
+}
+
+static void uring_handle_send (
+	Uring *uring, UringRequest *request, int result
+) {
+
+	uring->n_inflight -= 1;
+
+	Connection *connection = request->connection;
+	bool finished = true;
+
+	if (result > 0) {
+		request->sent += (size_t) result;
+		result = 0;
+
+		if (request->sent < request->size) {
+			result = -ECANCELED;
+
+			// send the remaining data unless the connection has been removed
+			if (connection && !uring->stopping) {
+				uring_prep_send (uring, request);
+				result = request->result;
+				finished = (result != 0);
+			}
+		}
+	}
+
+	else if (!result) {
+		result = -EPIPE;
+	}
+
+	if (finished) {
+		// the next send is started first
+		// as the connection might be released after this one is finished
+		if (connection) {
+			connection->uring_sends = request->next_send;
+			if (!connection->uring_sends) connection->uring_sends_tail = NULL;
+
+			uring_send_start (uring, connection);
+		}
+
+		uring_request_finish (uring, request, result);
+	}
+
+}
+
+static void uring_handle_recv (
+	Uring *uring, UringConnection *uc, int result, u32 flags
+) {
+
+	if (!(flags & IORING_CQE_F_MORE)) {
+		uc->armed = false;
+		uring->n_inflight -= 1;
+	}
+
+	if (result > 0) {
+		u16 bid = (u16) (flags >> IORING_CQE_BUFFER_SHIFT);
+
+		Connection *connection = uc->connection;
+		if (connection) {
+			Client *client = uring->client;
+
+			stats_count_receive (client, connection, (size_t) result);
+
+			// the connection might be removed while handling its packets
+			client_receive_handle_data (
+				client, connection,
+				uc->buffers + ((size_t) bid * uc->buffer_size),
+				uc->buffer_size, (size_t) result
+			);
+		}
+
+		uring_connection_recycle (uc, bid);
+	}
+
+	else if (result == -ENOBUFS) {
+		// all the buffers are being used, receive again
+	}
+
+	else if ((result == -EINVAL) && uc->multishot) {
+		// the kernel does not support multishot receives
+		uc->multishot = false;
+	}
+
+	else if (result == -ECANCELED) {
+		// the connection has been removed or the ring is stopping
+	}
+
+	else if (uc->connection) {
+		#ifdef CONNECTION_DEBUG
+		client_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+			"uring_handle_recv () - connection %s sock fd: %d has been closed",
+			uc->connection->name, uc->sock_fd
+		);
+		#endif
+
+		uc->failed = true;
+
+		client_receive_handle_failed (uring->client, uc->connection);
+	}
+
+	if (!uc->armed) {
+		if (uc->connection && !uc->failed && !uring->stopping) {
+			uring_prep_recv (uc);
+		}
+
+		else {
+			uring_connection_check_closed (uc);
+		}
+	}
+
+}
+
+static void uring_handle_completions (Uring *uring) {
+
+	unsigned int head = *uring->cq_head;
+
+	while (head != __atomic_load_n (uring->cq_tail, __ATOMIC_ACQUIRE)) {
+		struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cq_mask];
+
+		u64 user_data = cqe->user_data;
+		int result = cqe->res;
+		u32 flags = cqe->flags;
+
+		head += 1;
+		__atomic_store_n (uring->cq_head, head, __ATOMIC_RELEASE);
+
+		switch (user_data & URING_TAG_MASK) {
+			case URING_TAG_RECV:
+				uring_handle_recv (
+					uring,
+					(UringConnection *) uring_user_data_ptr (user_data),
+					result, flags
+				);
+				break;
+
+			case URING_TAG_REQUEST:
+				uring_handle_send (
+					uring,
+					(UringRequest *) uring_user_data_ptr (user_data),
+					result
+				);
+				break;
+
+			case URING_TAG_EVENT:
+				uring->n_inflight -= 1;
+				if (!uring->stopping) uring_prep_event_read (uring);
+				break;
+
+			case URING_TAG_CANCEL:
+			default: break;
+		}
+	}
+
+}
+
+static void uring_handle_requests (Uring *uring, UringRequest *request) {
+
+	while (request) {
+		// the request may be finished and released by its thread
+		UringRequest *next = request->next;
+		uring_handle_request (uring, request);
+		request = next;
+	}
+
+}
+
+static void uring_delete_closed (Uring *uring) {
+
+	while (uring->closed) {
+		UringConnection *uc = uring->closed;
+		uring->closed = uc->next_closed;
+
+		uring_connection_delete (uc);
+	}
+
+}
+
+static void *uring_thread (void *uring_ptr) {
+
+	Uring *uring = (Uring *) uring_ptr;
+
+	(void) thread_set_name ("uring");
+
+	#ifdef CLIENT_DEBUG
+	client_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+		"Client %s - uring thread has started",
+		uring->client->name
+	);
+	#endif
+
+	uring_prep_event_read (uring);
+
+	for (;;) {
+		(void) pthread_mutex_lock (&uring->lock);
+
+		UringRequest *request = uring->requests;
+		uring->requests = NULL;
+		uring->requests_tail = NULL;
+
+		bool running = uring->running;
+
+		// senders only need to wake up the thread when it is waiting
+		bool wait = !request && running;
+		uring->sleeping = wait;
+
+		(void) pthread_mutex_unlock (&uring->lock);
+
+		uring_handle_requests (uring, request);
+
+		if (!running && !uring->stopping) {
+			uring->stopping = true;
+			uring_prep_cancel (uring, 0, IORING_ASYNC_CANCEL_ANY);
+		}
+
+		uring_delete_closed (uring);
+
+		if (uring->stopping && !uring->n_inflight) break;
+
+		int retval = uring_enter_syscall (
+			uring->ring_fd, uring->to_submit,
+			wait ? 1 : 0,
+			IORING_ENTER_GETEVENTS
+		);
+
+		if (retval >= 0) {
+			uring->to_submit -= (unsigned int) retval;
+		}
+
+		else if ((errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY)) {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+				"uring_thread () - io_uring_enter () failed!"
+			);
+
+			break;
+		}
+
+		uring_handle_completions (uring);
+	}
+
+	uring_delete_closed (uring);
+
+	#ifdef CLIENT_DEBUG
+	client_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+		"Client %s - uring thread has ended",
+		uring->client->name
+	);
+	#endif
+
+	return NULL;
+
+}
+
+// adds the request to be handled by the ring's thread
+// returns false if the ring is not available
+static bool uring_request_push (
+	Uring *uring, UringRequest *request, bool only_running
+) {
+
+	bool pushed = false;
+
+	(void) pthread_mutex_lock (&uring->lock);
+
+	if (only_running ? uring->running : uring->alive) {
+		if (uring->requests_tail) uring->requests_tail->next = request;
+		else uring->requests = request;
+		uring->requests_tail = request;
+
+		if (uring->sleeping) {
+			uring->sleeping = false;
+
+			u64 value = 1;
+			(void) !write (uring->event_fd, &value, sizeof (u64));
+		}
+
+		pushed = true;
+	}
+
+	(void) pthread_mutex_unlock (&uring->lock);
+
+	return pushed;
+
+}
+
+// waits until the pushed request has been completed
+static int uring_request_wait (Uring *uring, UringRequest *request) {
+
+	(void) pthread_mutex_lock (&uring->lock);
+
+	while (!request->done) {
+		(void) pthread_cond_wait (&request->cond, &uring->lock);
+	}
+
+	int result = request->result;
+
+	(void) pthread_mutex_unlock (&uring->lock);
+
+	return result;
+
+}
+
+// adds the request to be handled by the ring's thread
+// and waits until it has been completed
+static int uring_request_submit (
+	Uring *uring, UringRequest *request, bool only_running
+) {
+
+	int result = -ECANCELED;
+
+	if (uring_request_push (uring, request, only_running)) {
+		result = uring_request_wait (uring, request);
+	}
+
+	return result;
+
+}
+
+static void uring_request_init (
+	UringRequest *request, UringRequestType type,
+	UringConnection *uc
+) {
+
+	(void) memset (request, 0, sizeof (UringRequest));
+
+	request->type = type;
+	request->uring_connection = uc;
+	request->sock_fd = -1;
+
+	(void) pthread_cond_init (&request->cond, NULL);
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+static Uring *uring_new (void) {
+
+	Uring *uring = (Uring *) malloc (sizeof (Uring));
+	if (uring) {
+		(void) memset (uring, 0, sizeof (Uring));
+
+		uring->ring_fd = -1;
+		uring->event_fd = -1;
+
+		(void) pthread_mutex_init (&uring->lock, NULL);
+	}
+
+	return uring;
+
+}
+
+void uring_delete (void *uring_ptr) {
+
+	if (uring_ptr) {
+		Uring *uring = (Uring *) uring_ptr;
+
+		uring_stop (uring);
+
+		if (uring->sqes) (void) munmap (uring->sqes, uring->sqes_size);
+		if (uring->ring_ptr) (void) munmap (uring->ring_ptr, uring->ring_size);
+
+		if (uring->ring_fd >= 0) (void) close (uring->ring_fd);
+		if (uring->event_fd >= 0) (void) close (uring->event_fd);
+
+		(void) pthread_mutex_destroy (&uring->lock);
+
+		free (uring_ptr);
+	}
+
+}
+
+// checks that the kernel supports every operation we need
+static u8 uring_probe (Uring *uring) {
+
+	u8 retval = 1;
+
+	const size_t probe_size = sizeof (struct io_uring_probe)
+		+ (256 * sizeof (struct io_uring_probe_op));
+
+	struct io_uring_probe *probe = (struct io_uring_probe *) calloc (1, probe_size);
+	if (probe) {
+		if (!uring_register_syscall (
+			uring->ring_fd, IORING_REGISTER_PROBE, probe, 256
+		)) {
+			const u8 ops[] = {
+				IORING_OP_RECV, IORING_OP_SEND,
+				IORING_OP_READ, IORING_OP_ASYNC_CANCEL
+			};
+
+			retval = 0;
+			for (unsigned int i = 0; i < (sizeof (ops) / sizeof (u8)); i++) {
+				if (
+					(ops[i] > probe->last_op)
+					|| !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)
+				) {
+					retval = 1;
+				}
+			}
+		}
+
+		free (probe);
+	}
+
+	// provided buffer rings were added after the operations themselves
+	if (!retval) {
+		const size_t size = sizeof (struct io_uring_buf);
+		void *buf_ring = mmap (
+			NULL, size,
+			PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE,
+			-1, 0
+		);
+
+		if (buf_ring != MAP_FAILED) {
+			struct io_uring_buf_reg reg = { 0 };
+			reg.ring_addr = (u64) (uintptr_t) buf_ring;
+			reg.ring_entries = 1;
+			reg.bgid = UINT16_MAX;
+
+			if (!uring_register_syscall (
+				uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1
+			)) {
+				(void) uring_register_syscall (
+					uring->ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1
+				);
+			}
+
+			else {
+				retval = 1;
+			}
+
+			(void) munmap (buf_ring, size);
+		}
+
+		else {
+			retval = 1;
+		}
+	}
+
+	return retval;
+
+}
+
+static u8 uring_map (Uring *uring, const struct io_uring_params *params) {
+
+	u8 retval = 1;
+
+	size_t sq_size = params->sq_off.array + (params->sq_entries * sizeof (unsigned int));
+	size_t cq_size = params->cq_off.cqes + (params->cq_entries * sizeof (struct io_uring_cqe));
+
+	uring->ring_size = (sq_size > cq_size) ? sq_size : cq_size;
+
+	void *ring_ptr = mmap (
+		NULL, uring->ring_size,
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		uring->ring_fd, IORING_OFF_SQ_RING
+	);
+
+	uring->sqes_size = params->sq_entries * sizeof (struct io_uring_sqe);
+	void *sqes = mmap (
+		NULL, uring->sqes_size,
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		uring->ring_fd, IORING_OFF_SQES
+	);
+
+	if (ring_ptr != MAP_FAILED) uring->ring_ptr = ring_ptr;
+	if (sqes != MAP_FAILED) uring->sqes = (struct io_uring_sqe *) sqes;
+
+	if (uring->ring_ptr && uring->sqes) {
+		char *ring = (char *) uring->ring_ptr;
+
+		uring->entries = params->sq_entries;
+
+		uring->sq_head = (unsigned int *) (ring + params->sq_off.head);
+		uring->sq_tail = (unsigned int *) (ring + params->sq_off.tail);
+		uring->sq_mask = (unsigned int *) (ring + params->sq_off.ring_mask);
+		uring->sq_array = (unsigned int *) (ring + params->sq_off.array);
+
+		uring->cq_head = (unsigned int *) (ring + params->cq_off.head);
+		uring->cq_tail = (unsigned int *) (ring + params->cq_off.tail);
+		uring->cq_mask = (unsigned int *) (ring + params->cq_off.ring_mask);
+		uring->cqes = (struct io_uring_cqe *) (ring + params->cq_off.cqes);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+Uring *uring_create (Client *client) {
+
+	Uring *uring = uring_new ();
+	if (uring) {
+		uring->client = client;
+
+		struct io_uring_params params = { 0 };
+		params.flags = IORING_SETUP_CQSIZE;
+		params.cq_entries = URING_DEFAULT_ENTRIES * 4;
+
+		uring->ring_fd = uring_setup_syscall (URING_DEFAULT_ENTRIES, &params);
+		uring->event_fd = eventfd (0, EFD_CLOEXEC);
+
+		if (
+			(uring->ring_fd < 0)
+			|| (uring->event_fd < 0)
+			|| !(params.features & IORING_FEAT_SINGLE_MMAP)
+			|| uring_map (uring, &params)
+			|| uring_probe (uring)
+		) {
+			client_log (
+				LOG_TYPE_WARNING, LOG_TYPE_CLIENT,
+				"uring_create () - io_uring is not supported by the kernel!"
+			);
+
+			uring_delete (uring);
+			uring = NULL;
+		}
+	}
+
+	return uring;
+
+}
+
+u8 uring_start (Uring *uring) {
+
+	u8 retval = 1;
+
+	if (uring && !uring->alive) {
+		uring->running = true;
+		uring->alive = true;
+		uring->stopping = false;
+
+		if (!pthread_create (&uring->thread_id, NULL, uring_thread, uring)) {
+			retval = 0;
+		}
+
+		else {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+				"uring_start () - Failed to create uring thread!"
+			);
+
+			uring->running = false;
+			uring->alive = false;
+		}
+	}
+
+	return retval;
+
+}
+
+void uring_stop (Uring *uring) {
+
+	if (uring && uring->alive) {
+		(void) pthread_mutex_lock (&uring->lock);
+
+		uring->running = false;
+
+		u64 value = 1;
+		(void) !write (uring->event_fd, &value, sizeof (u64));
+
+		(void) pthread_mutex_unlock (&uring->lock);
+
+		(void) pthread_join (uring->thread_id, NULL);
+
+		// handle the requests that arrived while the thread was ending
+		(void) pthread_mutex_lock (&uring->lock);
+
+		uring->alive = false;
+
+		UringRequest *request = uring->requests;
+		uring->requests = NULL;
+		uring->requests_tail = NULL;
+
+		while (request) {
+			UringRequest *next = request->next;
+
+			if (request->type == URING_REQUEST_TYPE_REMOVE) {
+				request->uring_connection->connection = NULL;
+				uring_connection_delete (request->uring_connection);
+				request->result = 0;
+			}
+
+			else {
+				if (request->connection) {
+					(void) __atomic_sub_fetch (
+						&request->connection->uring_pending_sends, 1, __ATOMIC_RELEASE
+					);
+				}
+
+				request->result = -ECANCELED;
+			}
+
+			request->done = true;
+			(void) pthread_cond_signal (&request->cond);
+
+			request = next;
+		}
+
+		(void) pthread_mutex_unlock (&uring->lock);
+	}
+
+}
+
+#pragma endregion
+
+#pragma region public
+
+u8 uring_register_connection (Uring *uring, Connection *connection) {
+
+	u8 retval = 1;
+
+	if (uring && connection && !connection->uring_connection) {
+		UringConnection *uc = uring_connection_create (uring, connection);
+		if (uc) {
+			connection->receive_handle.client = uring->client;
+			connection->receive_handle.connection = connection;
+
+			connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
+
+			// handle any bytes read ahead by client_connection_get_next_packet ()
+			client_receive_handle_read_ahead (uring->client, connection);
+
+			connection->uring_connection = uc;
+			connection->updating = true;
+
+			UringRequest request;
+			uring_request_init (&request, URING_REQUEST_TYPE_ADD, uc);
+
+			if (!uring_request_submit (uring, &request, true)) {
+				__atomic_store_n (&connection->uring, uring, __ATOMIC_RELEASE);
+
+				retval = 0;
+			}
+
+			else {
+				connection->uring_connection = NULL;
+				connection->updating = false;
+
+				uring_connection_delete (uc);
+			}
+
+			(void) pthread_cond_destroy (&request.cond);
+		}
+
+		if (retval) {
+			client_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CONNECTION,
+				"uring_register_connection () - "
+				"Failed to register connection %s!",
+				connection->name
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+void uring_unregister_connection (Connection *connection) {
+
+	if (connection && connection->uring_connection) {
+		UringConnection *uc = connection->uring_connection;
+		Uring *uring = uc->uring;
+
+		// senders that already got the ring still use it safely,
+		// as it lives until the client is deleted
+		__atomic_store_n (&connection->uring, NULL, __ATOMIC_RELEASE);
+
+		if (uring->alive && pthread_equal (pthread_self (), uring->thread_id)) {
+			uring_connection_remove (uc);
+		}
+
+		else {
+			UringRequest request;
+			uring_request_init (&request, URING_REQUEST_TYPE_REMOVE, uc);
+
+			if (uring_request_submit (uring, &request, false)) {
+				// the ring's thread has already ended
+				uc->connection = NULL;
+				uring_connection_delete (uc);
+			}
+
+			(void) pthread_cond_destroy (&request.cond);
+		}
+
+		connection->uring_connection = NULL;
+		connection->updating = false;
+	}
+
+}
+
+// waits until the ring's thread has sent the data after the sent bytes
+// the caller's write mutex is released while waiting, so the handlers
+// running in the ring's thread can still send through the connection
+static UringSendResult uring_send_remaining (
+	Uring *uring, Connection *connection,
+	const char *data, size_t data_size, size_t sent, int flags,
+	pthread_mutex_t *write_mutex, size_t *total_sent
+) {
+
+	UringSendResult result = URING_SEND_RESULT_UNAVAILABLE;
+
+	UringRequest request;
+	uring_request_init (&request, URING_REQUEST_TYPE_SEND, NULL);
+
+	request.connection = connection;
+	request.sock_fd = connection->socket->sock_fd;
+	request.data = data;
+	request.size = data_size;
+	request.sent = sent;
+	request.flags = flags;
+
+	int retval = -ECANCELED;
+
+	(void) __atomic_add_fetch (&connection->uring_pending_sends, 1, __ATOMIC_RELEASE);
+
+	if (uring_request_push (uring, &request, true)) {
+		if (write_mutex) (void) pthread_mutex_unlock (write_mutex);
+
+		retval = uring_request_wait (uring, &request);
+
+		if (write_mutex) (void) pthread_mutex_lock (write_mutex);
+	}
+
+	else {
+		(void) __atomic_sub_fetch (&connection->uring_pending_sends, 1, __ATOMIC_RELEASE);
+	}
+
+	if (!retval) {
+		if (total_sent) *total_sent = request.sent;
+
+		result = URING_SEND_RESULT_OK;
+	}
+
+	else if ((retval == -ECANCELED) && !request.sent) {
+		// the ring has stopped
+	}
+
+	else {
+		errno = -retval;
+
+		result = URING_SEND_RESULT_ERROR;
+	}
+
+	(void) pthread_cond_destroy (&request.cond);
+
+	return result;
+
+}
+
+// takes the send requests out of the pending ones, in order
+// the rest are left to be handled by the ring's thread loop
+static UringRequest *uring_requests_take_sends (Uring *uring) {
+
+	UringRequest *sends = NULL;
+	UringRequest **sends_next = &sends;
+
+	(void) pthread_mutex_lock (&uring->lock);
+
+	UringRequest **next = &uring->requests;
+	uring->requests_tail = NULL;
+
+	while (*next) {
+		UringRequest *request = *next;
+
+		if (request->type == URING_REQUEST_TYPE_SEND) {
+			*next = request->next;
+
+			request->next = NULL;
+			*sends_next = request;
+			sends_next = &request->next;
+		}
+
+		else {
+			uring->requests_tail = request;
+			next = &request->next;
+		}
+	}
+
+	(void) pthread_mutex_unlock (&uring->lock);
+
+	return sends;
+
+}
+
+// called by the ring's thread to send a copy of the data after the sent bytes
+// as the handlers running in it can't wait for their own sends
+static UringSendResult uring_send_async (
+	Uring *uring, Connection *connection,
+	const char *data, size_t data_size, size_t sent, int flags,
+	size_t *total_sent
+) {
+
+	UringSendResult result = URING_SEND_RESULT_UNAVAILABLE;
+
+	// the sends from other threads that are waiting for the ring go first
+	uring_handle_requests (uring, uring_requests_take_sends (uring));
+
+	size_t size = data_size - sent;
+	UringRequest *request = NULL;
+
+	// the connection might have been removed by one of them
+	if (__atomic_load_n (&connection->uring, __ATOMIC_ACQUIRE) && !uring->stopping) {
+		request = (UringRequest *) malloc (sizeof (UringRequest) + size);
+	}
+
+	if (request) {
+		(void) memset (request, 0, sizeof (UringRequest));
+
+		request->type = URING_REQUEST_TYPE_SEND;
+		request->connection = connection;
+		request->sock_fd = connection->socket->sock_fd;
+		request->data = (const char *) (request + 1);
+		request->size = size;
+		request->flags = flags;
+		request->async = true;
+
+		(void) memcpy (request + 1, data + sent, size);
+
+		(void) __atomic_add_fetch (&connection->uring_pending_sends, 1, __ATOMIC_RELEASE);
+
+		uring_send_add (uring, request);
+
+		if (total_sent) *total_sent = data_size;
+
+		result = URING_SEND_RESULT_OK;
+	}
+
+	else if (sent) {
+		// the caller can't send the data again
+		errno = ENOBUFS;
+
+		result = URING_SEND_RESULT_ERROR;
+	}
+
+	return result;
+
+}
+
+UringSendResult uring_send (
+	Connection *connection,
+	const char *data, size_t data_size, int flags,
+	pthread_mutex_t *write_mutex, size_t *total_sent
+) {
+
+	UringSendResult result = URING_SEND_RESULT_UNAVAILABLE;
+
+	Uring *uring = __atomic_load_n (&connection->uring, __ATOMIC_ACQUIRE);
+
+	if (uring) {
+		size_t sent = 0;
+		bool remaining = true;
+
+		// most sends fit in the socket, so they are done right away
+		// and only the bytes that would block go through the ring,
+		// unless previous sends are still waiting for it
+		if (!__atomic_load_n (&connection->uring_pending_sends, __ATOMIC_ACQUIRE)) {
+			ssize_t retval = send (
+				connection->socket->sock_fd, data, data_size,
+				flags | MSG_DONTWAIT | MSG_NOSIGNAL
+			);
+
+			if ((size_t) retval == data_size) {
+				if (total_sent) *total_sent = data_size;
+
+				result = URING_SEND_RESULT_OK;
+				remaining = false;
+			}
+
+			else if (
+				(retval < 0)
+				&& (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)
+			) {
+				result = URING_SEND_RESULT_ERROR;
+				remaining = false;
+			}
+
+			else if (retval > 0) {
+				sent = (size_t) retval;
+			}
+		}
+
+		if (remaining) {
+			result = pthread_equal (pthread_self (), uring->thread_id) ?
+				uring_send_async (
+					uring, connection,
+					data, data_size, sent, flags,
+					total_sent
+				) :
+				uring_send_remaining (
+					uring, connection,
+					data, data_size, sent, flags,
+					write_mutex, total_sent
+				);
+		}
+	}
+
+	return result;
+
+}
+
+#pragma endregion
+
+#else
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+Uring *uring_create (Client *client) {
+
+	client_log (
+		LOG_TYPE_WARNING, LOG_TYPE_CLIENT,
+		"uring_create () - io_uring support was not compiled!"
+	);
+
+	return NULL;
+
+}
+
+void uring_delete (void *uring_ptr) {}
+
+u8 uring_start (Uring *uring) { return 1; }
+
+void uring_stop (Uring *uring) {}
+
+u8 uring_register_connection (Uring *uring, Connection *connection) { return 1; }
+
+void uring_unregister_connection (Connection *connection) {}
+
+UringSendResult uring_send (
+	Connection *connection,
+	const char *data, size_t data_size, int flags,
+	pthread_mutex_t *write_mutex, size_t *total_sent
+) {
+
+	return URING_SEND_RESULT_UNAVAILABLE;
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,33 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "client.h"
+
+int main (int argc, char **argv) {
+
+	(void) printf ("Testing CLIENT...\n");
+
+	client_tests_handler ();
+
+	client_tests_lanes ();
+
+	client_tests_mailbox ();
+
+	client_tests_requests ();
+
+	client_tests_routes ();
+
+	client_tests_resync ();
+
+	client_tests_stats ();
+
+	client_tests_stream ();
+
+	client_tests_uring ();
+
+	(void) printf ("\nDone with CLIENT tests!\n\n");
+
+	return 0;
+
+}
\ No newline at end of file
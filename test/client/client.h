@@ -0,0 +1,22 @@
+#ifndef _CLIENT_TESTS_CLIENT_H_
+#define _CLIENT_TESTS_CLIENT_H_
+
+extern void client_tests_handler (void);
+
+extern void client_tests_lanes (void);
+
+extern void client_tests_mailbox (void);
+
+extern void client_tests_requests (void);
+
+extern void client_tests_routes (void);
+
+extern void client_tests_resync (void);
+
+extern void client_tests_stats (void);
+
+extern void client_tests_stream (void);
+
+extern void client_tests_uring (void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/handler.h>
+#include <client/mailbox.h>
+#include <client/packets.h>
+#include <client/receive.h>
+#include <client/stats.h>
+
+#include "../test.h"
+
+#define HANDLER_TEST_QUEUE_LIMIT		8
+
+static Client *test_client = NULL;
+static Connection *test_connection = NULL;
+
+static int sv[2] = { -1, -1 };
+
+static unsigned int n_handled = 0;
+
+static void test_handler_count (void *packet_ptr) {
+
+	(void) packet_ptr;
+
+	n_handled += 1;
+
+}
+
+static void test_handler_connection_create (void) {
+
+	struct sockaddr_storage address = { 0 };
+
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	test_client = client_create ();
+	test_check_ptr (test_client);
+
+	test_connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (test_connection);
+
+	test_connection->receive_handle.client = test_client;
+	test_connection->receive_handle.connection = test_connection;
+	test_connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
+
+}
+
+static void test_handler_connection_delete (void) {
+
+	connection_delete (test_connection);
+	test_connection = NULL;
+
+	client_delete (test_client);
+	test_client = NULL;
+
+	(void) close (sv[1]);
+
+}
+
+// passes a packet through the connection's receive state machine
+static void test_handler_receive (
+	const PacketType packet_type, const u32 request_type
+) {
+
+	Packet *packet = packet_generate_request (packet_type, request_type, "hello", 5);
+	test_check_ptr (packet);
+
+	client_receive_handle_data (
+		test_client, test_connection,
+		packet->packet, packet->packet_size, packet->packet_size
+	);
+
+	packet_delete (packet);
+
+}
+
+static void test_handler_game (void) {
+
+	test_handler_connection_create ();
+
+	// game packets are discarded without a game handler
+	test_handler_receive (PACKET_TYPE_GAME, 1);
+
+	Handler *direct = handler_create (test_handler_count);
+	test_check_ptr (direct);
+	handler_set_direct_handle (direct, true);
+	client_set_game_handler (test_client, direct);
+
+	n_handled = 0;
+	test_handler_receive (PACKET_TYPE_GAME, 1);
+	test_handler_receive (PACKET_TYPE_GAME, 2);
+	test_check_unsigned_eq (n_handled, 2, NULL);
+
+	// game packets are conflated like the other handled packets
+	Handler *conflating = handler_create (test_handler_count);
+	test_check_ptr (conflating);
+	test_check_unsigned_eq (handler_set_conflate (conflating, handler_key_request_type), 0, NULL);
+	client_set_game_handler (test_client, conflating);
+
+	test_handler_receive (PACKET_TYPE_GAME, 1);
+	test_handler_receive (PACKET_TYPE_GAME, 1);
+	test_handler_receive (PACKET_TYPE_GAME, 2);
+	test_check_unsigned_eq (mailbox_get_n_pending (conflating->mailbox), 2, NULL);
+	test_check_unsigned_eq (mailbox_get_n_conflated (conflating->mailbox), 1, NULL);
+
+	handler_delete (direct);
+
+	test_handler_connection_delete ();
+
+}
+
+// the packet's request type is its priority
+static u8 test_handler_priority (const Packet *packet) {
+
+	return (u8) packet->header.request_type;
+
+}
+
+// pushes an app packet of the request type to the handler
+static void test_handler_push (Handler *handler, const u32 request_type) {
+
+	Packet *packet = packet_generate_request (PACKET_TYPE_APP, request_type, NULL, 0);
+	test_check_ptr (packet);
+	packet_set_network_values (packet, test_client, test_connection);
+
+	test_check_unsigned_eq (handler_push_packet (handler, NULL, packet), 0, NULL);
+
+}
+
+static u64 test_handler_shed (void) {
+
+	StatsSnapshot snapshot = { 0 };
+	connection_stats_get (test_connection, &snapshot);
+
+	return snapshot.shed[PACKET_TYPE_APP];
+
+}
+
+// takes the oldest queued packet & returns its request type
+static u32 test_handler_pull (Handler *handler) {
+
+	Job job = { 0 };
+	test_check_int_eq (job_queue_pull_job (handler->job_queue, &job), 0, NULL);
+
+	Packet *packet = (Packet *) job.args;
+	u32 request_type = packet->header.request_type;
+	packet_delete (packet);
+
+	return request_type;
+
+}
+
+static Handler *test_handler_queue_create (const HandlerQueuePolicy policy) {
+
+	Handler *handler = handler_create (test_handler_count);
+	test_check_ptr (handler);
+
+	handler_set_queue_limit (handler, HANDLER_TEST_QUEUE_LIMIT, policy);
+	client_set_app_handlers (test_client, handler, NULL);
+
+	return handler;
+
+}
+
+// lower priorities get a smaller part of the queue
+static void test_handler_drop_priority (void) {
+
+	test_handler_connection_create ();
+
+	Handler *handler = test_handler_queue_create (HANDLER_QUEUE_POLICY_DROP_PRIORITY);
+	handler_set_priority (handler, test_handler_priority);
+
+	// priority 0 packets are shed once the queue has limit / 4 packets
+	for (unsigned int i = 0; i < 4; i++) test_handler_push (handler, 0);
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), 2, NULL);
+	test_check_unsigned_eq (test_handler_shed (), 2, NULL);
+
+	// priority 1 packets once it has limit / 2
+	for (unsigned int i = 0; i < 4; i++) test_handler_push (handler, 1);
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), 4, NULL);
+	test_check_unsigned_eq (test_handler_shed (), 4, NULL);
+
+	// the highest priority can take the whole queue but nothing more
+	for (unsigned int i = 0; i < 6; i++) test_handler_push (handler, HANDLER_PRIORITY_LEVELS - 1);
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), HANDLER_TEST_QUEUE_LIMIT, NULL);
+	test_check_unsigned_eq (test_handler_shed (), 6, NULL);
+
+	// the queued packets are the ones that arrived first of each priority
+	test_check_unsigned_eq (test_handler_pull (handler), 0, NULL);
+	test_check_unsigned_eq (test_handler_pull (handler), 0, NULL);
+	test_check_unsigned_eq (test_handler_pull (handler), 1, NULL);
+
+	// out of range priorities are the highest one
+	test_handler_push (handler, 200);
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), HANDLER_TEST_QUEUE_LIMIT - 2, NULL);
+	test_check_unsigned_eq (test_handler_shed (), 6, NULL);
+
+	while (job_queue_size (handler->job_queue)) (void) test_handler_pull (handler);
+
+	test_handler_connection_delete ();
+
+}
+
+// the oldest packets make room for the new ones
+static void test_handler_drop_oldest (void) {
+
+	test_handler_connection_create ();
+
+	Handler *handler = test_handler_queue_create (HANDLER_QUEUE_POLICY_DROP_OLDEST);
+
+	for (unsigned int i = 0; i < HANDLER_TEST_QUEUE_LIMIT + 3; i++) test_handler_push (handler, i);
+
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), HANDLER_TEST_QUEUE_LIMIT, NULL);
+	test_check_unsigned_eq (test_handler_shed (), 3, NULL);
+
+	for (unsigned int i = 3; i < HANDLER_TEST_QUEUE_LIMIT + 3; i++) {
+		test_check_unsigned_eq (test_handler_pull (handler), i, NULL);
+	}
+
+	test_handler_connection_delete ();
+
+}
+
+static void *test_handler_pause_reader (void *handler_ptr) {
+
+	Handler *handler = (Handler *) handler_ptr;
+
+	// pushes one more packet than the queue can take
+	for (unsigned int i = 0; i <= HANDLER_TEST_QUEUE_LIMIT; i++) test_handler_push (handler, i);
+
+	return NULL;
+
+}
+
+// the reading thread waits for room
+// unless it is shared with other connections
+static void test_handler_pause_reads (void) {
+
+	test_handler_connection_create ();
+
+	Handler *handler = test_handler_queue_create (HANDLER_QUEUE_POLICY_PAUSE_READS);
+
+	test_client->running = true;
+	test_connection->active = true;
+
+	pthread_t reader = 0;
+	test_check_int_eq (
+		pthread_create (&reader, NULL, test_handler_pause_reader, handler), 0, NULL
+	);
+
+	while (!__atomic_load_n (&handler->n_paused, __ATOMIC_SEQ_CST)) {
+		(void) usleep (1000);
+	}
+
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), HANDLER_TEST_QUEUE_LIMIT, NULL);
+
+	// the reader goes on once a packet is taken
+	test_check_unsigned_eq (test_handler_pull (handler), 0, NULL);
+	(void) pthread_join (reader, NULL);
+
+	test_check_unsigned_eq (job_queue_size (handler->job_queue), HANDLER_TEST_QUEUE_LIMIT, NULL);
+	test_check_unsigned_eq (test_handler_shed (), 0, NULL);
+
+	// reactor & io_uring threads can't be paused, so new packets are shed
+	test_connection->reactor_thread = (struct _ReactorThread *) test_connection;
+	test_handler_push (handler, 0);
+	test_connection->reactor_thread = NULL;
+
+	test_connection->uring = (struct _Uring *) test_connection;
+	test_handler_push (handler, 0);
+	test_connection->uring = NULL;
+
+	test_check_unsigned_eq (test_handler_shed (), 2, NULL);
+	test_check_unsigned_eq (handler->n_paused, 0, NULL);
+
+	while (job_queue_size (handler->job_queue)) (void) test_handler_pull (handler);
+
+	test_client->running = false;
+	test_connection->active = false;
+
+	test_handler_connection_delete ();
+
+}
+
+// the bytes read ahead by client_connection_get_next_packet ()
+// are handled once the connection starts being updated
+static void test_handler_read_ahead (void) {
+
+	test_handler_connection_create ();
+
+	Handler *handler = handler_create (test_handler_count);
+	test_check_ptr (handler);
+	handler_set_direct_handle (handler, true);
+	client_set_app_handlers (test_client, handler, NULL);
+
+	// two packets arrive in the same read
+	Packet *first = packet_generate_request (PACKET_TYPE_APP, 1, "hello", 5);
+	Packet *second = packet_generate_request (PACKET_TYPE_APP, 2, "hello", 5);
+	test_check_ptr (first);
+	test_check_ptr (second);
+
+	char buffer[2 * (sizeof (PacketHeader) + 5)] = { 0 };
+	(void) memcpy (buffer, first->packet, first->packet_size);
+	(void) memcpy (buffer + first->packet_size, second->packet, second->packet_size);
+
+	size_t size = first->packet_size + second->packet_size;
+	test_check_int_eq ((int) send (sv[1], buffer, size, 0), (int) size, NULL);
+
+	// the update thread owns the socket
+	test_connection->updating = true;
+	test_check_unsigned_eq (
+		client_connection_get_next_packet (test_client, test_connection), 1, NULL
+	);
+	test_check_null_ptr (test_connection->receive_handle.read_buffer);
+	test_connection->updating = false;
+
+	n_handled = 0;
+	test_check_unsigned_eq (
+		client_connection_get_next_packet (test_client, test_connection), 0, NULL
+	);
+	test_check_unsigned_eq (n_handled, 1, NULL);
+	test_check_unsigned_eq (
+		test_connection->receive_handle.read_end - test_connection->receive_handle.read_start,
+		second->packet_size, NULL
+	);
+
+	client_receive_handle_read_ahead (test_client, test_connection);
+	test_check_unsigned_eq (n_handled, 2, NULL);
+	test_check_unsigned_eq (test_connection->receive_handle.read_end, 0, NULL);
+
+	packet_delete (first);
+	packet_delete (second);
+
+	test_handler_connection_delete ();
+
+}
+
+void client_tests_handler (void) {
+
+	(void) printf ("Testing CLIENT handler...\n");
+
+	test_handler_game ();
+	test_handler_drop_priority ();
+	test_handler_drop_oldest ();
+	test_handler_pause_reads ();
+	test_handler_read_ahead ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/packets.h>
+
+#include "../test.h"
+
+#define LANES_TEST_BULK_PACKETS		16
+#define LANES_TEST_BULK_SIZE		4096
+
+static int sv[2] = { -1, -1 };
+
+static Client *test_client = NULL;
+static Connection *test_connection = NULL;
+
+static void test_lanes_connection_create (void) {
+
+	struct sockaddr_storage address = { 0 };
+
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	test_client = client_create ();
+	test_check_ptr (test_client);
+
+	test_connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (test_connection);
+
+	connection_set_send_queue (test_connection, 0);
+	test_check_ptr (test_connection->send_has_packets);
+
+	test_connection->active = true;
+
+}
+
+static void test_lanes_connection_delete (void) {
+
+	connection_delete (test_connection);
+	test_connection = NULL;
+
+	client_delete (test_client);
+	test_client = NULL;
+
+	(void) close (sv[1]);
+
+}
+
+static Packet *test_lanes_packet_create (
+	const PacketType packet_type, const size_t data_size
+) {
+
+	char data[LANES_TEST_BULK_SIZE] = { 0 };
+
+	Packet *packet = packet_generate_request (
+		packet_type, 0, data_size ? data : NULL, data_size
+	);
+
+	test_check_ptr (packet);
+	packet_set_network_values (packet, test_client, test_connection);
+
+	return packet;
+
+}
+
+// reads a packet from the other end & returns its type
+static PacketType test_lanes_read_packet (void) {
+
+	PacketHeader header = { 0 };
+	test_check_int_eq (
+		(int) recv (sv[1], &header, sizeof (PacketHeader), MSG_WAITALL),
+		(int) sizeof (PacketHeader), NULL
+	);
+
+	char data[LANES_TEST_BULK_SIZE] = { 0 };
+	size_t data_size = header.packet_size - sizeof (PacketHeader);
+	if (data_size) {
+		test_check_int_eq (
+			(int) recv (sv[1], data, data_size, MSG_WAITALL), (int) data_size, NULL
+		);
+	}
+
+	return header.packet_type;
+
+}
+
+static void test_lanes_select (void) {
+
+	test_lanes_connection_create ();
+
+	// pings are control packets
+	Packet *ping = packet_create_ping ();
+	test_check_ptr (ping);
+	test_check_unsigned_eq (connection_send_packet (test_connection, ping), 0, NULL);
+	test_check_unsigned_eq (
+		test_connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL], 1, NULL
+	);
+
+	Packet *app = test_lanes_packet_create (PACKET_TYPE_APP, 8);
+	test_check_unsigned_eq (connection_send_packet (test_connection, app), 0, NULL);
+	test_check_unsigned_eq (
+		test_connection->send_lane_packets[CONNECTION_SEND_LANE_BULK], 1, NULL
+	);
+
+	// the library's packets are copied into the control lane
+	Packet *auth = test_lanes_packet_create (PACKET_TYPE_AUTH, 8);
+	test_check_unsigned_eq (connection_send_control_packet (test_connection, auth, false), 0, NULL);
+	test_check_unsigned_eq (
+		test_connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL], 2, NULL
+	);
+
+	test_check_unsigned_eq (packet_send_ping (test_client, test_connection), 0, NULL);
+	test_check_unsigned_eq (
+		test_connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL], 3, NULL
+	);
+
+	packet_delete (auth);
+
+	test_lanes_connection_delete ();
+
+}
+
+// a control packet is sent before the bulk packets queued before it
+static void test_lanes_control_first (void) {
+
+	test_lanes_connection_create ();
+
+	for (unsigned int i = 0; i < LANES_TEST_BULK_PACKETS; i++) {
+		test_check_unsigned_eq (
+			connection_send_packet (
+				test_connection,
+				test_lanes_packet_create (PACKET_TYPE_APP, LANES_TEST_BULK_SIZE)
+			), 0, NULL
+		);
+	}
+
+	Packet *close_packet = test_lanes_packet_create (PACKET_TYPE_CLIENT, 0);
+	test_check_unsigned_eq (
+		connection_send_control_packet (test_connection, close_packet, false), 0, NULL
+	);
+
+	ClientConnection *cc = (ClientConnection *) malloc (sizeof (ClientConnection));
+	test_check_ptr (cc);
+	cc->client = test_client;
+	cc->connection = test_connection;
+
+	pthread_t send_thread = 0;
+	test_check_int_eq (
+		pthread_create (&send_thread, NULL, connection_send_thread, cc), 0, NULL
+	);
+
+	test_check_unsigned_eq (test_lanes_read_packet (), PACKET_TYPE_CLIENT, NULL);
+	for (unsigned int i = 0; i < LANES_TEST_BULK_PACKETS; i++) {
+		test_check_unsigned_eq (test_lanes_read_packet (), PACKET_TYPE_APP, NULL);
+	}
+
+	// waits until the send thread has sent the copy
+	test_check_unsigned_eq (
+		connection_send_control_packet (test_connection, close_packet, true), 0, NULL
+	);
+
+	test_check_unsigned_eq (
+		test_connection->send_lane_packets[CONNECTION_SEND_LANE_CONTROL], 0, NULL
+	);
+	test_check_unsigned_eq (test_connection->send_control_sending, 0, NULL);
+	test_check_unsigned_eq (test_lanes_read_packet (), PACKET_TYPE_CLIENT, NULL);
+
+	packet_delete (close_packet);
+
+	connection_end (test_connection);
+	(void) pthread_join (send_thread, NULL);
+
+	test_lanes_connection_delete ();
+
+}
+
+// the queue stops taking packets once the send thread has failed
+static void test_lanes_send_failed (void) {
+
+	test_lanes_connection_create ();
+
+	connection_set_send_queue_limits (
+		test_connection, 1, 0, CONNECTION_SEND_QUEUE_POLICY_BLOCK
+	);
+
+	test_connection->send_flags = MSG_NOSIGNAL;
+	test_check_int_eq (shutdown (sv[0], SHUT_WR), 0, NULL);
+
+	test_check_unsigned_eq (
+		connection_send_packet (
+			test_connection, test_lanes_packet_create (PACKET_TYPE_APP, 8)
+		), 0, NULL
+	);
+
+	ClientConnection *cc = (ClientConnection *) malloc (sizeof (ClientConnection));
+	test_check_ptr (cc);
+	cc->client = test_client;
+	cc->connection = test_connection;
+
+	pthread_t send_thread = 0;
+	test_check_int_eq (
+		pthread_create (&send_thread, NULL, connection_send_thread, cc), 0, NULL
+	);
+
+	// the send thread ends by itself
+	(void) pthread_join (send_thread, NULL);
+	test_check_bool_eq (test_connection->send_failed, true, NULL);
+
+	// producers are rejected instead of waiting for room
+	Packet *packet = test_lanes_packet_create (PACKET_TYPE_APP, 8);
+	test_check_unsigned_eq (connection_send_packet (test_connection, packet), 1, NULL);
+	test_check_unsigned_eq (
+		connection_send_control_packet (test_connection, packet, true), 1, NULL
+	);
+	packet_delete (packet);
+
+	test_lanes_connection_delete ();
+
+}
+
+void client_tests_lanes (void) {
+
+	(void) printf ("Testing CLIENT lanes...\n");
+
+	test_lanes_select ();
+	test_lanes_control_first ();
+	test_lanes_send_failed ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <client/mailbox.h>
+#include <client/packets.h>
+
+#include "../test.h"
+
+#define N_KEYS			200
+
+static void test_mailbox_put_take (void) {
+
+	Mailbox *mailbox = mailbox_create ();
+	test_check_ptr (mailbox);
+
+	Packet *replaced = NULL;
+
+	Packet *first = packet_new ();
+	MailboxEntry *entry = mailbox_put (mailbox, 7, first, &replaced);
+	test_check_ptr (entry);
+	test_check_null_ptr (replaced);
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), 1, NULL);
+
+	// a new packet with the same key replaces the pending one
+	Packet *second = packet_new ();
+	test_check_null_ptr (mailbox_put (mailbox, 7, second, &replaced));
+	test_check_ptr_eq (replaced, first);
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), 1, NULL);
+	test_check_unsigned_eq (mailbox_get_n_conflated (mailbox), 1, NULL);
+	packet_delete (replaced);
+
+	// another key gets its own entry
+	Packet *other = packet_new ();
+	MailboxEntry *other_entry = mailbox_put (mailbox, 8, other, &replaced);
+	test_check_ptr (other_entry);
+	test_check_ptr_ne (other_entry, entry);
+	test_check_null_ptr (replaced);
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), 2, NULL);
+
+	// the entry returns the latest packet of its key only once
+	Packet *taken = mailbox_take (mailbox, entry);
+	test_check_ptr_eq (taken, second);
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), 1, NULL);
+	test_check_null_ptr (mailbox_take (mailbox, entry));
+	packet_delete (taken);
+
+	// the key can be pending again after being taken
+	Packet *third = packet_new ();
+	MailboxEntry *reused = mailbox_put (mailbox, 7, third, &replaced);
+	test_check_ptr (reused);
+	test_check_null_ptr (replaced);
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), 2, NULL);
+	test_check_unsigned_eq (mailbox_get_n_conflated (mailbox), 1, NULL);
+
+	// the pending packets are deleted with the mailbox
+	mailbox_delete (mailbox);
+
+}
+
+static void test_mailbox_grow (void) {
+
+	Mailbox *mailbox = mailbox_create ();
+	test_check_ptr (mailbox);
+
+	Packet *replaced = NULL;
+	MailboxEntry *entries[N_KEYS] = { 0 };
+	Packet *packets[N_KEYS] = { 0 };
+
+	for (unsigned int i = 0; i < N_KEYS; i++) {
+		packets[i] = packet_new ();
+		entries[i] = mailbox_put (mailbox, i, packets[i], &replaced);
+		test_check_ptr (entries[i]);
+		test_check_null_ptr (replaced);
+	}
+
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), N_KEYS, NULL);
+	test_check_true ((mailbox->n_buckets >= N_KEYS));
+
+	// every key still has its packet after the buckets grew
+	for (unsigned int i = 0; i < N_KEYS; i++) {
+		Packet *packet = packet_new ();
+		test_check_null_ptr (mailbox_put (mailbox, i, packet, &replaced));
+		test_check_ptr_eq (replaced, packets[i]);
+		packet_delete (replaced);
+
+		packets[i] = packet;
+	}
+
+	test_check_unsigned_eq (mailbox_get_n_conflated (mailbox), N_KEYS, NULL);
+
+	for (unsigned int i = 0; i < N_KEYS; i++) {
+		Packet *taken = mailbox_take (mailbox, entries[i]);
+		test_check_ptr_eq (taken, packets[i]);
+		packet_delete (taken);
+	}
+
+	test_check_unsigned_eq (mailbox_get_n_pending (mailbox), 0, NULL);
+
+	mailbox_delete (mailbox);
+
+}
+
+void client_tests_mailbox (void) {
+
+	(void) printf ("Testing CLIENT mailbox...\n");
+
+	test_mailbox_put_take ();
+	test_mailbox_grow ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/packets.h>
+#include <client/requests.h>
+
+#include "../test.h"
+
+#define REQUEST_TYPE_TEST			3
+
+static int sv[2] = { -1, -1 };
+
+static Client *test_client = NULL;
+static Connection *test_connection = NULL;
+
+static void test_requests_connection_create (void) {
+
+	struct sockaddr_storage address = { 0 };
+
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	test_client = client_create ();
+	test_check_ptr (test_client);
+
+	test_connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (test_connection);
+	test_check_ptr (test_connection->requests);
+
+	test_connection->active = true;
+
+}
+
+static void test_requests_connection_delete (void) {
+
+	connection_delete (test_connection);
+	test_connection = NULL;
+
+	client_delete (test_client);
+	test_client = NULL;
+
+	(void) close (sv[1]);
+
+}
+
+// reads the header & the id of a sent request from the other end
+static void test_requests_read_sent (
+	const u32 id, const size_t data_size
+) {
+
+	PacketHeader header = { 0 };
+	test_check_int_eq (
+		(int) recv (sv[1], &header, sizeof (PacketHeader), MSG_WAITALL),
+		(int) sizeof (PacketHeader), NULL
+	);
+
+	test_check_unsigned_eq (header.packet_type, PACKET_TYPE_APP, NULL);
+	test_check_unsigned_eq (
+		header.request_type, (REQUEST_TYPE_TEST | REQUEST_TYPE_CORRELATED), NULL
+	);
+	test_check_unsigned_eq (
+		header.packet_size, sizeof (PacketHeader) + REQUEST_ID_SIZE + data_size, NULL
+	);
+
+	char data[64] = { 0 };
+	test_check_int_eq (
+		(int) recv (sv[1], data, REQUEST_ID_SIZE + data_size, MSG_WAITALL),
+		(int) (REQUEST_ID_SIZE + data_size), NULL
+	);
+
+	u32 sent_id = 0;
+	(void) memcpy (&sent_id, data, REQUEST_ID_SIZE);
+	test_check_unsigned_eq (ntohl (sent_id), id, NULL);
+
+}
+
+// creates a received packet with the id after a prefix of prefix_size bytes
+static Packet *test_requests_response_create (
+	const PacketType packet_type, const u32 request_type,
+	const u32 id, const size_t prefix_size, const char *payload
+) {
+
+	char data[64] = { 0 };
+	size_t payload_size = payload ? strlen (payload) : 0;
+
+	u32 net_id = htonl (id);
+	(void) memcpy (data + prefix_size, &net_id, REQUEST_ID_SIZE);
+	if (payload) (void) memcpy (data + prefix_size + REQUEST_ID_SIZE, payload, payload_size);
+
+	Packet *packet = packet_new ();
+	test_check_ptr (packet);
+
+	test_check_unsigned_eq (
+		packet_set_data (packet, data, prefix_size + REQUEST_ID_SIZE + payload_size), 0, NULL
+	);
+
+	// the data_ptr is past the prefix like when packets are checked
+	// or not set at all like in packets that have not been read
+	packet->data_ptr = prefix_size ? packet->data_ptr + prefix_size : NULL;
+
+	packet->header.packet_type = packet_type;
+	packet->header.request_type = request_type;
+	packet->header.packet_size = sizeof (PacketHeader) + packet->data_size;
+
+	packet->client = test_client;
+	packet->connection = test_connection;
+
+	return packet;
+
+}
+
+static Request *test_requests_send (const char *payload, const u32 timeout) {
+
+	Request *request = client_request_send (
+		test_client, test_connection,
+		PACKET_TYPE_APP, REQUEST_TYPE_TEST,
+		payload, strlen (payload),
+		timeout
+	);
+
+	test_check_ptr (request);
+	test_check_unsigned_eq (request_get_state (request), REQUEST_STATE_PENDING, NULL);
+
+	test_requests_read_sent (request_get_id (request), strlen (payload));
+
+	return request;
+
+}
+
+static void test_requests_response (void) {
+
+	test_requests_connection_create ();
+
+	Request *request = test_requests_send ("ping", 0);
+	test_check_unsigned_eq (request_get_id (request), 1, NULL);
+	test_check_unsigned_eq (test_connection->requests->n_pending, 1, NULL);
+
+	// a packet without the flag is never a response
+	Packet *unmarked = test_requests_response_create (
+		PACKET_TYPE_APP, REQUEST_TYPE_TEST, request_get_id (request), 0, "pong"
+	);
+
+	test_check_unsigned_eq (requests_handle_response (test_connection->requests, unmarked), 1, NULL);
+	test_check_unsigned_eq (request_get_state (request), REQUEST_STATE_PENDING, NULL);
+	test_check_null_ptr (unmarked->data_ptr);
+	packet_delete (unmarked);
+
+	// a flagged packet with an unknown id is not taken
+	Packet *unknown = test_requests_response_create (
+		PACKET_TYPE_APP, REQUEST_TYPE_TEST | REQUEST_TYPE_CORRELATED,
+		request_get_id (request) + 1, 0, "pong"
+	);
+
+	test_check_unsigned_eq (requests_handle_response (test_connection->requests, unknown), 1, NULL);
+	packet_delete (unknown);
+
+	// the id is read from the data_ptr, after the packet's version
+	Packet *response = test_requests_response_create (
+		PACKET_TYPE_APP, REQUEST_TYPE_TEST | REQUEST_TYPE_CORRELATED,
+		request_get_id (request), sizeof (PacketVersion), "pong"
+	);
+
+	test_check_unsigned_eq (requests_handle_response (test_connection->requests, response), 0, NULL);
+	test_check_unsigned_eq (request_get_state (request), REQUEST_STATE_DONE, NULL);
+	test_check_unsigned_eq (test_connection->requests->n_pending, 0, NULL);
+
+	test_check_ptr_eq (request_get_response (request), response);
+	test_check_ptr_eq (
+		response->data_ptr,
+		(char *) response->data + sizeof (PacketVersion) + REQUEST_ID_SIZE
+	);
+	test_check_int_eq ((int) (response->data_end - response->data_ptr), 4, NULL);
+	test_check_int_eq (memcmp (response->data_ptr, "pong", 4), 0, NULL);
+
+	request_delete (request);
+
+	// app errors complete the request with an error
+	request = test_requests_send ("fail", 0);
+	test_check_unsigned_eq (request_get_id (request), 2, NULL);
+
+	response = test_requests_response_create (
+		PACKET_TYPE_APP_ERROR, REQUEST_TYPE_TEST | REQUEST_TYPE_CORRELATED,
+		request_get_id (request), 0, NULL
+	);
+
+	test_check_unsigned_eq (requests_handle_response (test_connection->requests, response), 0, NULL);
+	test_check_unsigned_eq (request_get_state (request), REQUEST_STATE_ERROR, NULL);
+	test_check_ptr_eq (response->data_ptr, (char *) response->data + REQUEST_ID_SIZE);
+	test_check_ptr_eq (response->data_ptr, response->data_end);
+
+	request_delete (request);
+
+	test_requests_connection_delete ();
+
+}
+
+static void test_requests_timeout (void) {
+
+	test_requests_connection_create ();
+
+	Request *request = test_requests_send ("slow", 10);
+	test_check_unsigned_eq (request_wait (request, 1000), REQUEST_STATE_TIMEOUT, NULL);
+	test_check_null_ptr (request_get_response (request));
+	test_check_unsigned_eq (test_connection->requests->n_pending, 0, NULL);
+
+	// a late response goes to the handlers
+	Packet *late = test_requests_response_create (
+		PACKET_TYPE_APP, REQUEST_TYPE_TEST | REQUEST_TYPE_CORRELATED,
+		request_get_id (request), 0, "late"
+	);
+
+	test_check_unsigned_eq (requests_handle_response (test_connection->requests, late), 1, NULL);
+	packet_delete (late);
+
+	request_delete (request);
+
+	test_requests_connection_delete ();
+
+}
+
+static void test_requests_cancel (void) {
+
+	test_requests_connection_create ();
+
+	Request *request = test_requests_send ("stop", 0);
+	test_check_unsigned_eq (request_cancel (request), 0, NULL);
+	test_check_unsigned_eq (request_get_state (request), REQUEST_STATE_CANCELLED, NULL);
+	test_check_unsigned_eq (test_connection->requests->n_pending, 0, NULL);
+
+	// a completed request can't be cancelled again
+	test_check_unsigned_eq (request_cancel (request), 1, NULL);
+
+	Packet *late = test_requests_response_create (
+		PACKET_TYPE_APP, REQUEST_TYPE_TEST | REQUEST_TYPE_CORRELATED,
+		request_get_id (request), 0, "late"
+	);
+
+	test_check_unsigned_eq (requests_handle_response (test_connection->requests, late), 1, NULL);
+	packet_delete (late);
+
+	request_delete (request);
+
+	test_requests_connection_delete ();
+
+}
+
+static void test_requests_ids (void) {
+
+	test_requests_connection_create ();
+
+	// a long pending request holds the id after the wrap
+	test_connection->requests->next_id = 0;
+	Request *pending = test_requests_send ("hold", 0);
+	test_check_unsigned_eq (request_get_id (pending), 1, NULL);
+
+	test_connection->requests->next_id = UINT32_MAX - 1;
+
+	Request *last = test_requests_send ("last", 0);
+	test_check_unsigned_eq (request_get_id (last), UINT32_MAX, NULL);
+
+	// ids skip 0 & the ones of pending requests
+	Request *wrapped = test_requests_send ("wrap", 0);
+	test_check_unsigned_eq (request_get_id (wrapped), 2, NULL);
+	test_check_unsigned_eq (test_connection->requests->n_pending, 3, NULL);
+
+	// the ended connection completes every pending request
+	connection_end (test_connection);
+	test_check_unsigned_eq (request_get_state (pending), REQUEST_STATE_ENDED, NULL);
+	test_check_unsigned_eq (request_get_state (last), REQUEST_STATE_ENDED, NULL);
+	test_check_unsigned_eq (request_get_state (wrapped), REQUEST_STATE_ENDED, NULL);
+
+	request_delete (pending);
+	request_delete (last);
+	request_delete (wrapped);
+
+	test_requests_connection_delete ();
+
+}
+
+void client_tests_requests (void) {
+
+	(void) printf ("Testing CLIENT requests...\n");
+
+	test_requests_response ();
+	test_requests_timeout ();
+	test_requests_cancel ();
+	test_requests_ids ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/handler.h>
+#include <client/packets.h>
+#include <client/receive.h>
+#include <client/stats.h>
+
+#include "../test.h"
+
+#define RESYNC_BUFFER_SIZE			256
+#define RESYNC_GARBAGE_SIZE			20
+
+static Client *test_client = NULL;
+static Connection *test_connection = NULL;
+
+static int sv[2] = { -1, -1 };
+
+static void test_resync_connection_create (void) {
+
+	struct sockaddr_storage address = { 0 };
+
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	test_client = client_create ();
+	test_check_ptr (test_client);
+
+	test_connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (test_connection);
+
+	test_connection->receive_handle.client = test_client;
+	test_connection->receive_handle.connection = test_connection;
+	test_connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
+
+}
+
+static void test_resync_connection_delete (void) {
+
+	connection_delete (test_connection);
+	test_connection = NULL;
+
+	client_delete (test_client);
+	test_client = NULL;
+
+	(void) close (sv[1]);
+
+}
+
+// writes a test packet with a 5 bytes message at the buffer's position
+static size_t test_resync_put_packet (char *buffer) {
+
+	Packet *packet = packet_generate_request (PACKET_TYPE_TEST, 0, "hello", 5);
+	test_check_ptr (packet);
+
+	size_t packet_size = packet->packet_size;
+	(void) memcpy (buffer, packet->packet, packet_size);
+
+	packet_delete (packet);
+
+	return packet_size;
+
+}
+
+// writes a test packet header with an invalid size
+static size_t test_resync_put_bad_header (char *buffer) {
+
+	PacketHeader header = { 0 };
+	header.packet_type = PACKET_TYPE_TEST;
+	header.packet_size = test_connection->max_packet_size + 1;
+
+	(void) memcpy (buffer, &header, sizeof (PacketHeader));
+
+	return sizeof (PacketHeader);
+
+}
+
+static void test_resync_scan (void) {
+
+	test_resync_connection_create ();
+
+	const ReceiveHandle *receive_handle = &test_connection->receive_handle;
+
+	char buffer[RESYNC_BUFFER_SIZE] = { 0 };
+	(void) memset (buffer, 0xff, sizeof (buffer));
+
+	// buffers without a complete header
+	test_check_unsigned_eq (client_receive_resync_scan (receive_handle, buffer, 0), 0, NULL);
+	test_check_unsigned_eq (
+		client_receive_resync_scan (receive_handle, buffer, sizeof (PacketHeader) - 1),
+		sizeof (PacketHeader) - 1, NULL
+	);
+
+	test_check_unsigned_eq (
+		client_receive_resync_scan (receive_handle, buffer, sizeof (buffer)),
+		sizeof (buffer), NULL
+	);
+
+	// a header at the start & after garbage
+	(void) test_resync_put_packet (buffer);
+	test_check_unsigned_eq (client_receive_resync_scan (receive_handle, buffer, sizeof (buffer)), 0, NULL);
+
+	(void) memset (buffer, 0xff, sizeof (buffer));
+	(void) test_resync_put_packet (buffer + 37);
+	test_check_unsigned_eq (client_receive_resync_scan (receive_handle, buffer, sizeof (buffer)), 37, NULL);
+
+	// a header with an invalid size is skipped
+	(void) test_resync_put_bad_header (buffer + 3);
+	test_check_unsigned_eq (client_receive_resync_scan (receive_handle, buffer, sizeof (buffer)), 37, NULL);
+
+	// a header that is not complete in the buffer is not checked
+	(void) memset (buffer, 0xff, sizeof (buffer));
+	(void) test_resync_put_packet (buffer + 100);
+	test_check_unsigned_eq (
+		client_receive_resync_scan (receive_handle, buffer, 100 + sizeof (PacketHeader)),
+		100, NULL
+	);
+	test_check_unsigned_eq (
+		client_receive_resync_scan (receive_handle, buffer, 100 + sizeof (PacketHeader) - 1),
+		100 + sizeof (PacketHeader) - 1, NULL
+	);
+
+	test_resync_connection_delete ();
+
+}
+
+// a bad header, garbage & two packets
+static size_t test_resync_stream_create (char *buffer, size_t *first_packet) {
+
+	size_t size = test_resync_put_bad_header (buffer);
+
+	(void) memset (buffer + size, 0xff, RESYNC_GARBAGE_SIZE);
+	size += RESYNC_GARBAGE_SIZE;
+
+	*first_packet = size;
+
+	size += test_resync_put_packet (buffer + size);
+	size += test_resync_put_packet (buffer + size);
+
+	return size;
+
+}
+
+static void test_resync_check_stats (void) {
+
+	StatsSnapshot snapshot = { 0 };
+	connection_stats_get (test_connection, &snapshot);
+
+	test_check_unsigned_eq (snapshot.received.packets[PACKET_TYPE_TEST], 2, NULL);
+	test_check_unsigned_eq (test_connection->stats->n_resyncs, 1, NULL);
+	test_check_unsigned_eq (
+		test_connection->stats->resync_skipped_bytes,
+		sizeof (PacketHeader) + RESYNC_GARBAGE_SIZE, NULL
+	);
+
+	test_check_unsigned_eq (
+		test_connection->receive_handle.state, RECEIVE_HANDLE_STATE_NORMAL, NULL
+	);
+
+}
+
+// the first buffer ends in the middle of the header that ends the resync
+static void test_resync_split_header (void) {
+
+	test_resync_connection_create ();
+
+	char buffer[RESYNC_BUFFER_SIZE] = { 0 };
+	size_t first_packet = 0;
+	size_t size = test_resync_stream_create (buffer, &first_packet);
+
+	size_t split = first_packet + 10;
+	client_receive_handle_data (test_client, test_connection, buffer, split, split);
+	test_check_unsigned_eq (
+		test_connection->receive_handle.state, RECEIVE_HANDLE_STATE_LOST, NULL
+	);
+
+	client_receive_handle_data (
+		test_client, test_connection, buffer + split, size - split, size - split
+	);
+
+	test_resync_check_stats ();
+
+	test_resync_connection_delete ();
+
+}
+
+// the resync keeps going through buffers without a header
+static void test_resync_many_buffers (void) {
+
+	test_resync_connection_create ();
+
+	char buffer[RESYNC_BUFFER_SIZE] = { 0 };
+	char garbage[64] = { 0 };
+	(void) memset (garbage, 0xff, sizeof (garbage));
+
+	size_t size = test_resync_put_bad_header (buffer);
+	(void) memset (buffer + size, 0xff, RESYNC_GARBAGE_SIZE);
+	size += RESYNC_GARBAGE_SIZE;
+
+	client_receive_handle_data (test_client, test_connection, buffer, size, size);
+	test_check_unsigned_eq (
+		test_connection->receive_handle.state, RECEIVE_HANDLE_STATE_LOST, NULL
+	);
+
+	// a buffer bigger than a header & one that only adds to the tail
+	client_receive_handle_data (test_client, test_connection, garbage, 40, 40);
+	client_receive_handle_data (test_client, test_connection, garbage, 5, 5);
+	test_check_unsigned_eq (
+		test_connection->receive_handle.resync_tail_size, sizeof (PacketHeader) - 1, NULL
+	);
+
+	// the next header starts in a buffer smaller than itself
+	size = test_resync_put_packet (buffer);
+	size += test_resync_put_packet (buffer + size);
+
+	client_receive_handle_data (test_client, test_connection, buffer, 10, 10);
+	test_check_unsigned_eq (
+		test_connection->receive_handle.state, RECEIVE_HANDLE_STATE_LOST, NULL
+	);
+
+	client_receive_handle_data (
+		test_client, test_connection, buffer + 10, size - 10, size - 10
+	);
+
+	StatsSnapshot snapshot = { 0 };
+	connection_stats_get (test_connection, &snapshot);
+
+	test_check_unsigned_eq (snapshot.received.packets[PACKET_TYPE_TEST], 2, NULL);
+	test_check_unsigned_eq (test_connection->stats->n_resyncs, 1, NULL);
+	test_check_unsigned_eq (
+		test_connection->stats->resync_skipped_bytes,
+		sizeof (PacketHeader) + RESYNC_GARBAGE_SIZE + 40 + 5, NULL
+	);
+
+	test_resync_connection_delete ();
+
+}
+
+void client_tests_resync (void) {
+
+	(void) printf ("Testing CLIENT resync...\n");
+
+	test_resync_scan ();
+	test_resync_split_header ();
+	test_resync_many_buffers ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
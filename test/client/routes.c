@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/handler.h>
+#include <client/packets.h>
+#include <client/receive.h>
+#include <client/routes.h>
+
+#include "../test.h"
+
+#define ROUTES_TEST_REQUEST			5
+
+typedef struct RoutesTestData {
+
+	unsigned int n_called;
+	u32 request_type;
+
+} RoutesTestData;
+
+static void test_routes_callback (void *handler_data_ptr) {
+
+	HandlerData *handler_data = (HandlerData *) handler_data_ptr;
+	RoutesTestData *data = (RoutesTestData *) handler_data->data;
+
+	data->n_called += 1;
+	data->request_type = handler_data->packet->header.request_type;
+
+}
+
+static void test_routes_table (void) {
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	// only app, app error & custom packets can have routes
+	Route *app = client_route_register (
+		client, PACKET_TYPE_APP, ROUTES_TEST_REQUEST, test_routes_callback, ROUTE_MODE_INLINE
+	);
+	test_check_ptr (app);
+	test_check_unsigned_eq (app->packet_type, PACKET_TYPE_APP, NULL);
+	test_check_unsigned_eq (app->request_type, ROUTES_TEST_REQUEST, NULL);
+
+	Route *app_error = client_route_register (
+		client, PACKET_TYPE_APP_ERROR, ROUTES_TEST_REQUEST, test_routes_callback, ROUTE_MODE_QUEUED
+	);
+	Route *custom = client_route_register (
+		client, PACKET_TYPE_CUSTOM, ROUTES_MAX_REQUEST_TYPES - 1, test_routes_callback, ROUTE_MODE_INLINE
+	);
+	test_check_ptr (app_error);
+	test_check_ptr (custom);
+	test_check_ptr_ne (app_error, app);
+
+	test_check_null_ptr (client_route_register (
+		client, PACKET_TYPE_GAME, ROUTES_TEST_REQUEST, test_routes_callback, ROUTE_MODE_INLINE
+	));
+	test_check_null_ptr (client_route_register (
+		client, PACKET_TYPE_APP, ROUTES_MAX_REQUEST_TYPES, test_routes_callback, ROUTE_MODE_INLINE
+	));
+	test_check_null_ptr (client_route_register (
+		client, PACKET_TYPE_APP, 6, NULL, ROUTE_MODE_INLINE
+	));
+
+	// a request type can only have one route for each packet type
+	test_check_null_ptr (client_route_register (
+		client, PACKET_TYPE_APP, ROUTES_TEST_REQUEST, test_routes_callback, ROUTE_MODE_QUEUED
+	));
+
+	test_check_unsigned_eq (client->routes->n_routes, 3, NULL);
+
+	test_check_ptr_eq (routes_get (client->routes, PACKET_TYPE_APP, ROUTES_TEST_REQUEST), app);
+	test_check_ptr_eq (routes_get (client->routes, PACKET_TYPE_APP_ERROR, ROUTES_TEST_REQUEST), app_error);
+	test_check_ptr_eq (
+		client_route_get (client, PACKET_TYPE_CUSTOM, ROUTES_MAX_REQUEST_TYPES - 1), custom
+	);
+
+	test_check_null_ptr (routes_get (client->routes, PACKET_TYPE_APP, 6));
+	test_check_null_ptr (routes_get (client->routes, PACKET_TYPE_CUSTOM, ROUTES_TEST_REQUEST));
+	test_check_null_ptr (routes_get (client->routes, PACKET_TYPE_GAME, ROUTES_TEST_REQUEST));
+	test_check_null_ptr (routes_get (client->routes, PACKET_TYPE_APP, ROUTES_MAX_REQUEST_TYPES));
+	test_check_null_ptr (routes_get (NULL, PACKET_TYPE_APP, ROUTES_TEST_REQUEST));
+
+	client_delete (client);
+
+}
+
+// passes a packet through the connection's receive state machine
+static void test_routes_receive (
+	Client *client, Connection *connection,
+	const PacketType packet_type, const u32 request_type
+) {
+
+	Packet *packet = packet_generate_request (packet_type, request_type, "hello", 5);
+	test_check_ptr (packet);
+
+	client_receive_handle_data (
+		client, connection, packet->packet, packet->packet_size, packet->packet_size
+	);
+
+	packet_delete (packet);
+
+}
+
+static void test_routes_handle (void) {
+
+	int sv[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	struct sockaddr_storage address = { 0 };
+	Connection *connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (connection);
+
+	connection->receive_handle.client = client;
+	connection->receive_handle.connection = connection;
+	connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
+
+	RoutesTestData data = { 0 };
+
+	Route *route = client_route_register (
+		client, PACKET_TYPE_APP, ROUTES_TEST_REQUEST, test_routes_callback, ROUTE_MODE_INLINE
+	);
+	test_check_ptr (route);
+	route_set_data (route, &data);
+
+	// a queued route without a running handler is called inline
+	Route *queued = client_route_register (
+		client, PACKET_TYPE_CUSTOM, ROUTES_TEST_REQUEST, test_routes_callback, ROUTE_MODE_QUEUED
+	);
+	test_check_ptr (queued);
+	route_set_data (queued, &data);
+
+	test_routes_receive (client, connection, PACKET_TYPE_APP, ROUTES_TEST_REQUEST);
+	test_check_unsigned_eq (data.n_called, 1, NULL);
+	test_check_unsigned_eq (data.request_type, ROUTES_TEST_REQUEST, NULL);
+	test_check_unsigned_eq (route->n_packets, 1, NULL);
+	test_check_unsigned_eq (route->n_bytes, sizeof (PacketHeader) + 5, NULL);
+
+	test_routes_receive (client, connection, PACKET_TYPE_CUSTOM, ROUTES_TEST_REQUEST);
+	test_check_unsigned_eq (data.n_called, 2, NULL);
+	test_check_unsigned_eq (queued->n_packets, 1, NULL);
+	test_check_unsigned_eq (queued->n_failed, 0, NULL);
+
+	// packets without a route go to the client's handlers
+	Packet *packet = packet_generate_request (PACKET_TYPE_APP, 6, "hello", 5);
+	test_check_ptr (packet);
+	packet_set_network_values (packet, client, connection);
+	test_check_unsigned_eq (routes_handle_packet (client->routes, packet), 1, NULL);
+	test_check_unsigned_eq (data.n_called, 2, NULL);
+	packet_delete (packet);
+
+	connection_delete (connection);
+
+	client_delete (client);
+
+	(void) close (sv[1]);
+
+}
+
+void client_tests_routes (void) {
+
+	(void) printf ("Testing CLIENT routes...\n");
+
+	test_routes_table ();
+	test_routes_handle ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
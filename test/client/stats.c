@@ -0,0 +1,128 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <client/packets.h>
+#include <client/stats.h>
+
+#include "../test.h"
+
+#define MEGABYTE			1048576
+
+static void test_stats_size_bucket (void) {
+
+	test_check_unsigned_eq (stats_size_bucket (0), 0, NULL);
+	test_check_unsigned_eq (stats_size_bucket (1), 0, NULL);
+	test_check_unsigned_eq (stats_size_bucket (64), 0, NULL);
+	test_check_unsigned_eq (stats_size_bucket (65), 1, NULL);
+	test_check_unsigned_eq (stats_size_bucket (128), 1, NULL);
+	test_check_unsigned_eq (stats_size_bucket (129), 2, NULL);
+	test_check_unsigned_eq (stats_size_bucket (MEGABYTE), 14, NULL);
+	test_check_unsigned_eq (stats_size_bucket (MEGABYTE + 1), 15, NULL);
+	test_check_unsigned_eq (stats_size_bucket ((size_t) -1), STATS_SIZES_BUCKETS - 1, NULL);
+
+}
+
+static void test_stats_size_bucket_limit (void) {
+
+	test_check_unsigned_eq (stats_size_bucket_limit (0), 64, NULL);
+	test_check_unsigned_eq (stats_size_bucket_limit (1), 128, NULL);
+	test_check_unsigned_eq (stats_size_bucket_limit (14), MEGABYTE, NULL);
+	test_check_unsigned_eq (stats_size_bucket_limit (15), (size_t) -1, NULL);
+
+	// every limit is counted in its own bucket
+	for (unsigned int bucket = 0; bucket < (STATS_SIZES_BUCKETS - 1); bucket++) {
+		test_check_unsigned_eq (stats_size_bucket (stats_size_bucket_limit (bucket)), bucket, NULL);
+		test_check_unsigned_eq (stats_size_bucket (stats_size_bucket_limit (bucket) + 1), bucket + 1, NULL);
+	}
+
+}
+
+static void test_stats_shards_create (void) {
+
+	StatsShard *shards = stats_shards_create (STATS_N_SHARDS);
+	test_check_ptr (shards);
+	test_check_unsigned_eq (((size_t) shards) % STATS_CACHE_LINE_SIZE, 0, NULL);
+	test_check_unsigned_eq (sizeof (StatsShard) % STATS_CACHE_LINE_SIZE, 0, NULL);
+
+	// the calling thread always updates the same shard
+	StatsShard *shard = stats_shard_get (shards);
+	test_check_true (((shard >= shards) && (shard < (shards + STATS_N_SHARDS))));
+	test_check_ptr_eq (stats_shard_get (shards), shard);
+
+	stats_shards_delete (shards);
+
+	test_check_null_ptr (stats_shards_create (0));
+
+}
+
+static void test_stats_shards_snapshot (void) {
+
+	StatsShard *shards = stats_shards_create (3);
+	test_check_ptr (shards);
+
+	for (unsigned int i = 0; i < 3; i++) {
+		shards[i].n_receives_done = i + 1;
+		shards[i].total_bytes_received = 1000 * (i + 1);
+		shards[i].n_send_failed = i;
+
+		shards[i].received.packets[PACKET_TYPE_APP] = 10;
+		shards[i].received.bytes[PACKET_TYPE_APP] = 640;
+		shards[i].received.sizes[PACKET_TYPE_APP][0] = 10;
+
+		shards[i].received.packets[PACKET_TYPE_CERVER] = 1;
+		shards[i].received.bytes[PACKET_TYPE_CERVER] = MEGABYTE + 1;
+		shards[i].received.sizes[PACKET_TYPE_CERVER][15] = 1;
+
+		shards[i].sent.packets[PACKET_TYPE_REQUEST] = 2 * i;
+		shards[i].sent.bytes[PACKET_TYPE_REQUEST] = 200 * i;
+		shards[i].sent.sizes[PACKET_TYPE_REQUEST][2] = 2 * i;
+
+		shards[i].shed[PACKET_TYPE_APP] = i;
+		shards[i].shed[PACKET_TYPE_CUSTOM] = 1;
+	}
+
+	StatsSnapshot snapshot = { 0 };
+	stats_shards_snapshot (shards, 3, &snapshot);
+
+	test_check_unsigned_eq (snapshot.n_receives_done, 6, NULL);
+	test_check_unsigned_eq (snapshot.total_bytes_received, 6000, NULL);
+	test_check_unsigned_eq (snapshot.n_send_failed, 3, NULL);
+
+	test_check_unsigned_eq (snapshot.received.packets[PACKET_TYPE_APP], 30, NULL);
+	test_check_unsigned_eq (snapshot.received.bytes[PACKET_TYPE_APP], 1920, NULL);
+	test_check_unsigned_eq (snapshot.received.sizes[PACKET_TYPE_APP][0], 30, NULL);
+	test_check_unsigned_eq (snapshot.received.sizes[PACKET_TYPE_CERVER][15], 3, NULL);
+	test_check_unsigned_eq (snapshot.n_packets_received, 33, NULL);
+
+	test_check_unsigned_eq (snapshot.sent.packets[PACKET_TYPE_REQUEST], 6, NULL);
+	test_check_unsigned_eq (snapshot.sent.sizes[PACKET_TYPE_REQUEST][2], 6, NULL);
+	test_check_unsigned_eq (snapshot.n_packets_sent, 6, NULL);
+	test_check_unsigned_eq (snapshot.total_bytes_sent, 600, NULL);
+
+	test_check_unsigned_eq (snapshot.shed[PACKET_TYPE_APP], 3, NULL);
+	test_check_unsigned_eq (snapshot.shed[PACKET_TYPE_CUSTOM], 3, NULL);
+	test_check_unsigned_eq (snapshot.n_packets_shed, 6, NULL);
+
+	// the snapshot starts from zero every time
+	stats_shards_snapshot (shards, 1, &snapshot);
+	test_check_unsigned_eq (snapshot.n_receives_done, 1, NULL);
+	test_check_unsigned_eq (snapshot.n_packets_received, 11, NULL);
+	test_check_unsigned_eq (snapshot.n_packets_sent, 0, NULL);
+
+	stats_shards_delete (shards);
+
+}
+
+void client_tests_stats (void) {
+
+	(void) printf ("Testing CLIENT stats...\n");
+
+	test_stats_size_bucket ();
+	test_stats_size_bucket_limit ();
+	test_stats_shards_create ();
+	test_stats_shards_snapshot ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/handler.h>
+#include <client/packets.h>
+#include <client/receive.h>
+
+#include "../test.h"
+
+#define STREAM_TEST_MAX_PACKET_SIZE			1024
+#define STREAM_TEST_MAX_STREAM_SIZE			8192
+#define STREAM_TEST_THRESHOLD				512
+
+#define STREAM_TEST_DATA_SIZE				4096
+#define STREAM_TEST_CHUNK_SIZE				1000
+
+typedef struct StreamTestData {
+
+	size_t delivered;
+	unsigned int n_done;
+
+} StreamTestData;
+
+static void test_stream_handler (PacketStream *stream) {
+
+	StreamTestData *data = (StreamTestData *) stream->data;
+
+	data->delivered += stream->chunk_size;
+	if (stream->done) data->n_done += 1;
+
+}
+
+static void test_stream_max_size (void) {
+
+	int sv[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	struct sockaddr_storage address = { 0 };
+	Connection *connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (connection);
+
+	connection->receive_handle.client = client;
+	connection->receive_handle.connection = connection;
+	connection->receive_handle.state = RECEIVE_HANDLE_STATE_NORMAL;
+
+	StreamTestData data = { 0 };
+	connection_set_max_packet_size (connection, STREAM_TEST_MAX_PACKET_SIZE);
+	connection_set_max_stream_packet_size (connection, STREAM_TEST_MAX_STREAM_SIZE);
+	connection_set_stream_handler (
+		connection, STREAM_TEST_THRESHOLD, test_stream_handler, &data
+	);
+
+	// streamed packets are checked against the max stream packet size
+	test_check_bool_eq (
+		connection_packet_size_is_valid (connection, STREAM_TEST_MAX_PACKET_SIZE + 1), true, NULL
+	);
+	test_check_bool_eq (
+		connection_packet_size_is_valid (connection, STREAM_TEST_MAX_STREAM_SIZE + 1), false, NULL
+	);
+	test_check_bool_eq (
+		connection_packet_size_is_valid (connection, sizeof (PacketHeader) - 1), false, NULL
+	);
+
+	// a packet bigger than the max packet size is streamed
+	char *buffer = (char *) calloc (sizeof (PacketHeader) + STREAM_TEST_DATA_SIZE, sizeof (char));
+	test_check_ptr (buffer);
+
+	PacketHeader header = { 0 };
+	header.packet_type = PACKET_TYPE_APP;
+	header.packet_size = sizeof (PacketHeader) + STREAM_TEST_DATA_SIZE;
+	(void) memcpy (buffer, &header, sizeof (PacketHeader));
+
+	size_t size = header.packet_size;
+	for (size_t pos = 0; pos < size; pos += STREAM_TEST_CHUNK_SIZE) {
+		size_t chunk = ((size - pos) < STREAM_TEST_CHUNK_SIZE) ?
+			(size - pos) : STREAM_TEST_CHUNK_SIZE;
+
+		client_receive_handle_data (client, connection, buffer + pos, chunk, chunk);
+	}
+
+	test_check_unsigned_eq (data.delivered, STREAM_TEST_DATA_SIZE, NULL);
+	test_check_unsigned_eq (data.n_done, 1, NULL);
+	test_check_unsigned_eq (connection->stats->n_resyncs, 0, NULL);
+
+	// but not one bigger than the max stream packet size
+	header.packet_size = STREAM_TEST_MAX_STREAM_SIZE + 1;
+	(void) memcpy (buffer, &header, sizeof (PacketHeader));
+
+	client_receive_handle_data (
+		client, connection, buffer, sizeof (PacketHeader), sizeof (PacketHeader)
+	);
+
+	test_check_unsigned_eq (data.n_done, 1, NULL);
+	test_check_unsigned_eq (connection->stats->n_resyncs, 1, NULL);
+
+	free (buffer);
+
+	connection_delete (connection);
+
+	client_delete (client);
+
+	(void) close (sv[1]);
+
+}
+
+void client_tests_stream (void) {
+
+	(void) printf ("Testing CLIENT stream...\n");
+
+	test_stream_max_size ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include <sys/socket.h>
+
+#include <client/client.h>
+#include <client/connection.h>
+#include <client/uring.h>
+
+#include "../test.h"
+
+#define URING_TEST_BIG_SIZE			(1 << 20)
+
+typedef struct UringTestReader {
+
+	int sock_fd;
+	char *buffer;
+	size_t size;
+	size_t received;
+
+} UringTestReader;
+
+static void *uring_test_reader (void *reader_ptr) {
+
+	UringTestReader *reader = (UringTestReader *) reader_ptr;
+
+	while (reader->received < reader->size) {
+		ssize_t received = recv (
+			reader->sock_fd,
+			reader->buffer + reader->received, reader->size - reader->received,
+			0
+		);
+
+		if (received <= 0) break;
+
+		reader->received += (size_t) received;
+	}
+
+	return NULL;
+
+}
+
+static void test_uring_send (void) {
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	// the running kernel might lack io_uring support
+	Uring *uring = uring_create (client);
+	if (!uring) {
+		(void) printf ("Skipping io_uring tests...\n");
+		client_delete (client);
+		return;
+	}
+
+	test_check_unsigned_eq (uring_start (uring), 0, NULL);
+
+	int sv[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	// so big sends don't fit in the socket & go through the ring
+	int small = 4096;
+	(void) setsockopt (sv[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof (int));
+
+	struct sockaddr_storage address = { 0 };
+	Connection *connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (connection);
+	connection->active = true;
+
+	test_check_unsigned_eq (uring_register_connection (uring, connection), 0, NULL);
+	test_check_ptr_eq (connection->uring, uring);
+
+	// a small send fits in the socket
+	size_t sent = 0;
+	test_check_unsigned_eq (
+		uring_send (connection, "hello", 5, 0, NULL, &sent), URING_SEND_RESULT_OK, NULL
+	);
+	test_check_unsigned_eq (sent, 5, NULL);
+
+	char small_buffer[8] = { 0 };
+	test_check_int_eq ((int) recv (sv[1], small_buffer, 5, MSG_WAITALL), 5, NULL);
+	test_check_int_eq (memcmp (small_buffer, "hello", 5), 0, NULL);
+
+	// a big send is finished by the ring while the other end reads
+	char *data = (char *) malloc (URING_TEST_BIG_SIZE);
+	test_check_ptr (data);
+	for (size_t i = 0; i < URING_TEST_BIG_SIZE; i++) data[i] = (char) (i % 251);
+
+	UringTestReader reader = {
+		.sock_fd = sv[1],
+		.buffer = (char *) calloc (URING_TEST_BIG_SIZE, sizeof (char)),
+		.size = URING_TEST_BIG_SIZE,
+		.received = 0
+	};
+
+	test_check_ptr (reader.buffer);
+
+	pthread_t reader_thread = 0;
+	test_check_int_eq (pthread_create (&reader_thread, NULL, uring_test_reader, &reader), 0, NULL);
+
+	sent = 0;
+	test_check_unsigned_eq (
+		uring_send (connection, data, URING_TEST_BIG_SIZE, 0, NULL, &sent),
+		URING_SEND_RESULT_OK, NULL
+	);
+	test_check_unsigned_eq (sent, URING_TEST_BIG_SIZE, NULL);
+
+	(void) pthread_join (reader_thread, NULL);
+	test_check_unsigned_eq (reader.received, URING_TEST_BIG_SIZE, NULL);
+	test_check_int_eq (memcmp (reader.buffer, data, URING_TEST_BIG_SIZE), 0, NULL);
+
+	free (reader.buffer);
+	free (data);
+
+	// a removed connection must be sent by the caller
+	uring_unregister_connection (connection);
+	test_check_null_ptr (connection->uring);
+	test_check_null_ptr (connection->uring_connection);
+	test_check_unsigned_eq (
+		uring_send (connection, "hello", 5, 0, NULL, &sent), URING_SEND_RESULT_UNAVAILABLE, NULL
+	);
+
+	// a shut down socket fails without raising SIGPIPE
+	test_check_unsigned_eq (uring_register_connection (uring, connection), 0, NULL);
+	test_check_int_eq (shutdown (sv[0], SHUT_WR), 0, NULL);
+	test_check_unsigned_eq (
+		uring_send (connection, "hello", 5, 0, NULL, &sent), URING_SEND_RESULT_ERROR, NULL
+	);
+
+	uring_stop (uring);
+
+	connection_delete (connection);
+
+	(void) close (sv[1]);
+
+	uring_delete (uring);
+
+	client_delete (client);
+
+}
+
+typedef struct UringTestSender {
+
+	Connection *connection;
+	const char *data;
+	size_t size;
+	size_t sent;
+	UringSendResult result;
+
+} UringTestSender;
+
+// sends while holding the connection's write mutex like packet_send () does
+static void *uring_test_sender (void *sender_ptr) {
+
+	UringTestSender *sender = (UringTestSender *) sender_ptr;
+	pthread_mutex_t *write_mutex = sender->connection->socket->write_mutex;
+
+	(void) pthread_mutex_lock (write_mutex);
+
+	sender->result = uring_send (
+		sender->connection, sender->data, sender->size, 0,
+		write_mutex, &sender->sent
+	);
+
+	(void) pthread_mutex_unlock (write_mutex);
+
+	return NULL;
+
+}
+
+// a send waiting for the ring releases the write mutex
+// and the sends made meanwhile go after it
+static void test_uring_send_order (void) {
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	Uring *uring = uring_create (client);
+	if (!uring) {
+		client_delete (client);
+		return;
+	}
+
+	test_check_unsigned_eq (uring_start (uring), 0, NULL);
+
+	int sv[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	int small = 4096;
+	(void) setsockopt (sv[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof (int));
+
+	struct sockaddr_storage address = { 0 };
+	Connection *connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (connection);
+	connection->active = true;
+
+	test_check_unsigned_eq (uring_register_connection (uring, connection), 0, NULL);
+
+	char *data = (char *) malloc (URING_TEST_BIG_SIZE);
+	test_check_ptr (data);
+	for (size_t i = 0; i < URING_TEST_BIG_SIZE; i++) data[i] = (char) (i % 251);
+
+	UringTestSender sender = {
+		.connection = connection,
+		.data = data,
+		.size = URING_TEST_BIG_SIZE,
+		.sent = 0,
+		.result = URING_SEND_RESULT_UNAVAILABLE
+	};
+
+	pthread_t sender_thread = 0;
+	test_check_int_eq (pthread_create (&sender_thread, NULL, uring_test_sender, &sender), 0, NULL);
+
+	// nobody reads yet, so the sender ends up waiting for the ring
+	while (!__atomic_load_n (&connection->uring_pending_sends, __ATOMIC_ACQUIRE)) {
+		(void) usleep (1000);
+	}
+
+	UringTestReader reader = {
+		.sock_fd = sv[1],
+		.buffer = (char *) calloc (URING_TEST_BIG_SIZE + 5, sizeof (char)),
+		.size = URING_TEST_BIG_SIZE + 5,
+		.received = 0
+	};
+
+	test_check_ptr (reader.buffer);
+
+	pthread_mutex_t *write_mutex = connection->socket->write_mutex;
+	(void) pthread_mutex_lock (write_mutex);
+
+	pthread_t reader_thread = 0;
+	test_check_int_eq (pthread_create (&reader_thread, NULL, uring_test_reader, &reader), 0, NULL);
+
+	size_t sent = 0;
+	test_check_unsigned_eq (
+		uring_send (connection, "hello", 5, 0, write_mutex, &sent), URING_SEND_RESULT_OK, NULL
+	);
+	test_check_unsigned_eq (sent, 5, NULL);
+
+	(void) pthread_mutex_unlock (write_mutex);
+
+	(void) pthread_join (sender_thread, NULL);
+	(void) pthread_join (reader_thread, NULL);
+
+	test_check_unsigned_eq (sender.result, URING_SEND_RESULT_OK, NULL);
+	test_check_unsigned_eq (sender.sent, URING_TEST_BIG_SIZE, NULL);
+	test_check_unsigned_eq (connection->uring_pending_sends, 0, NULL);
+
+	test_check_unsigned_eq (reader.received, URING_TEST_BIG_SIZE + 5, NULL);
+	test_check_int_eq (memcmp (reader.buffer, data, URING_TEST_BIG_SIZE), 0, NULL);
+	test_check_int_eq (memcmp (reader.buffer + URING_TEST_BIG_SIZE, "hello", 5), 0, NULL);
+
+	free (reader.buffer);
+	free (data);
+
+	uring_stop (uring);
+
+	connection_delete (connection);
+
+	(void) close (sv[1]);
+
+	uring_delete (uring);
+
+	client_delete (client);
+
+}
+
+// ending the connection cancels the send that waits for the ring
+static void test_uring_send_end (void) {
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	Uring *uring = uring_create (client);
+	if (!uring) {
+		client_delete (client);
+		return;
+	}
+
+	test_check_unsigned_eq (uring_start (uring), 0, NULL);
+
+	int sv[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	int small = 4096;
+	(void) setsockopt (sv[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof (int));
+
+	struct sockaddr_storage address = { 0 };
+	Connection *connection = connection_create (sv[0], &address, PROTOCOL_TCP);
+	test_check_ptr (connection);
+	connection->active = true;
+
+	test_check_unsigned_eq (uring_register_connection (uring, connection), 0, NULL);
+
+	char *data = (char *) calloc (URING_TEST_BIG_SIZE, sizeof (char));
+	test_check_ptr (data);
+
+	UringTestSender sender = {
+		.connection = connection,
+		.data = data,
+		.size = URING_TEST_BIG_SIZE,
+		.sent = 0,
+		.result = URING_SEND_RESULT_OK
+	};
+
+	pthread_t sender_thread = 0;
+	test_check_int_eq (pthread_create (&sender_thread, NULL, uring_test_sender, &sender), 0, NULL);
+
+	while (!__atomic_load_n (&connection->uring_pending_sends, __ATOMIC_ACQUIRE)) {
+		(void) usleep (1000);
+	}
+
+	// nobody reads, so the send can only end when it is canceled
+	connection_end (connection);
+	test_check_null_ptr (connection->uring);
+
+	(void) pthread_join (sender_thread, NULL);
+
+	test_check_unsigned_eq (sender.result, URING_SEND_RESULT_ERROR, NULL);
+	test_check_unsigned_eq (connection->uring_pending_sends, 0, NULL);
+
+	free (data);
+
+	uring_stop (uring);
+
+	connection_delete (connection);
+
+	(void) close (sv[1]);
+
+	uring_delete (uring);
+
+	client_delete (client);
+
+}
+
+// a new connection never takes the group id of a registered one
+static void test_uring_groups (void) {
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+
+	Uring *uring = uring_create (client);
+	if (!uring) {
+		client_delete (client);
+		return;
+	}
+
+	test_check_unsigned_eq (uring_start (uring), 0, NULL);
+
+	int sv[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), 0, NULL);
+
+	struct sockaddr_storage address = { 0 };
+	Connection *first = connection_create (sv[0], &address, PROTOCOL_TCP);
+	Connection *second = connection_create (sv[1], &address, PROTOCOL_TCP);
+	test_check_ptr (first);
+	test_check_ptr (second);
+
+	test_check_unsigned_eq (uring_register_connection (uring, first), 0, NULL);
+	test_check_ptr (first->uring_connection);
+	u16 group = first->uring_connection->group;
+
+	// as if the ids had wrapped around
+	uring->next_group = group;
+
+	test_check_unsigned_eq (uring_register_connection (uring, second), 0, NULL);
+	test_check_ptr (second->uring_connection);
+	test_check_bool_eq ((second->uring_connection->group != group), true, NULL);
+
+	uring_stop (uring);
+
+	connection_delete (first);
+	connection_delete (second);
+
+	uring_delete (uring);
+
+	client_delete (client);
+
+}
+
+void client_tests_uring (void) {
+
+	(void) printf ("Testing CLIENT uring...\n");
+
+	test_uring_send ();
+	test_uring_send_order ();
+	test_uring_send_end ();
+	test_uring_groups ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
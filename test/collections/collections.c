@@ -29,6 +29,8 @@ int main (int argc, char **argv) {
 
 	collections_tests_htab ();
 
+	collections_tests_ring ();
+
 	(void) printf ("\nDone with COLLECTIONS tests!\n\n");
 
 	client_log_end ();
@@ -5,4 +5,6 @@ extern int collections_tests_dlist (void);
 
 extern void collections_tests_htab (void);
 
+extern void collections_tests_ring (void);
+
 #endif
\ No newline at end of file
@@ -305,6 +305,7 @@ static void test_htab_int_remove_multiple (void) {
 	// insert a new value
 	unsigned int final_value = 18;
 	key = &final_value;
+	data = data_new (final_value, final_value);
 	int resutl = htab_insert (
 		map,
 		key, sizeof (unsigned int),
@@ -0,0 +1,213 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <client/collections/ring.h>
+
+#include "../test.h"
+
+#define RING_TEST_PRODUCERS				4
+#define RING_TEST_CONSUMERS				4
+#define RING_TEST_ITEMS					20000
+
+typedef struct Item {
+
+	unsigned int producer;
+	unsigned int value;
+
+} Item;
+
+static void test_ring_create (void) {
+
+	Ring *ring = ring_create (RING_TYPE_MPMC, 100, sizeof (Item));
+
+	test_check_ptr (ring);
+	test_check_unsigned_eq (ring->capacity, 128, NULL);
+	test_check_unsigned_eq (ring->mask, 127, NULL);
+	test_check_unsigned_eq (ring->element_size, sizeof (Item), NULL);
+	test_check_ptr (ring->slots);
+	test_check_unsigned_eq (ring_size (ring), 0, NULL);
+	test_check_true (ring_is_empty (ring));
+	test_check_false (ring_is_full (ring));
+
+	ring_delete (ring);
+
+	test_check_null_ptr (ring_create (RING_TYPE_MPMC, 0, sizeof (Item)));
+	test_check_null_ptr (ring_create (RING_TYPE_MPMC, 8, 0));
+
+}
+
+static void test_ring_push_pop (const RingType type) {
+
+	Ring *ring = ring_create (type, 8, sizeof (Item));
+	test_check_ptr (ring);
+
+	Item item = { 0 };
+	test_check_unsigned_eq (ring_pop (ring, &item), 1, NULL);
+
+	// wraps around the slots a few times
+	unsigned int pushed = 0;
+	unsigned int popped = 0;
+	for (unsigned int lap = 0; lap < 4; lap++) {
+		while (!ring_is_full (ring)) {
+			item.value = pushed;
+			test_check_unsigned_eq (ring_push (ring, &item), 0, NULL);
+			pushed += 1;
+		}
+
+		test_check_unsigned_eq (ring_size (ring), 8, NULL);
+		test_check_unsigned_eq (ring_push (ring, &item), 1, NULL);
+
+		for (unsigned int i = 0; i < 5; i++) {
+			test_check_unsigned_eq (ring_pop (ring, &item), 0, NULL);
+			test_check_unsigned_eq (item.value, popped, NULL);
+			popped += 1;
+		}
+	}
+
+	while (!ring_pop (ring, &item)) {
+		test_check_unsigned_eq (item.value, popped, NULL);
+		popped += 1;
+	}
+
+	test_check_unsigned_eq (popped, pushed, NULL);
+	test_check_true (ring_is_empty (ring));
+
+	ring_delete (ring);
+
+}
+
+typedef struct RingTest {
+
+	Ring *ring;
+	unsigned int id;
+
+	unsigned int consumed;
+	unsigned long long sum;
+
+	// the last value that was seen from each producer
+	int last[RING_TEST_PRODUCERS];
+	unsigned int unordered;
+
+} RingTest;
+
+static unsigned int ring_test_remaining = RING_TEST_PRODUCERS * RING_TEST_ITEMS;
+
+static void *ring_test_producer (void *test_ptr) {
+
+	RingTest *test = (RingTest *) test_ptr;
+
+	Item item = { .producer = test->id, .value = 0 };
+	for (unsigned int i = 0; i < RING_TEST_ITEMS; i++) {
+		item.value = i;
+		while (ring_push (test->ring, &item)) (void) sched_yield ();
+	}
+
+	return NULL;
+
+}
+
+static void *ring_test_consumer (void *test_ptr) {
+
+	RingTest *test = (RingTest *) test_ptr;
+
+	for (unsigned int i = 0; i < RING_TEST_PRODUCERS; i++) test->last[i] = -1;
+
+	Item item = { 0 };
+	while (__atomic_load_n (&ring_test_remaining, __ATOMIC_RELAXED)) {
+		if (!ring_pop (test->ring, &item)) {
+			__atomic_sub_fetch (&ring_test_remaining, 1, __ATOMIC_RELAXED);
+
+			// values of each producer are always seen in order
+			if ((int) item.value <= test->last[item.producer]) test->unordered += 1;
+			test->last[item.producer] = (int) item.value;
+
+			test->consumed += 1;
+			test->sum += item.value;
+		}
+
+		else {
+			(void) sched_yield ();
+		}
+	}
+
+	return NULL;
+
+}
+
+static void test_ring_mpmc_threads (void) {
+
+	Ring *ring = ring_create (RING_TYPE_MPMC, 64, sizeof (Item));
+	test_check_ptr (ring);
+
+	RingTest producers[RING_TEST_PRODUCERS];
+	RingTest consumers[RING_TEST_CONSUMERS];
+	pthread_t producers_ids[RING_TEST_PRODUCERS];
+	pthread_t consumers_ids[RING_TEST_CONSUMERS];
+
+	(void) memset (consumers, 0, sizeof (consumers));
+
+	for (unsigned int i = 0; i < RING_TEST_CONSUMERS; i++) {
+		consumers[i].ring = ring;
+		test_check_int_eq (
+			pthread_create (&consumers_ids[i], NULL, ring_test_consumer, &consumers[i]),
+			0, NULL
+		);
+	}
+
+	for (unsigned int i = 0; i < RING_TEST_PRODUCERS; i++) {
+		producers[i].ring = ring;
+		producers[i].id = i;
+		test_check_int_eq (
+			pthread_create (&producers_ids[i], NULL, ring_test_producer, &producers[i]),
+			0, NULL
+		);
+	}
+
+	for (unsigned int i = 0; i < RING_TEST_PRODUCERS; i++)
+		(void) pthread_join (producers_ids[i], NULL);
+
+	unsigned int consumed = 0;
+	unsigned long long sum = 0;
+	for (unsigned int i = 0; i < RING_TEST_CONSUMERS; i++) {
+		(void) pthread_join (consumers_ids[i], NULL);
+
+		test_check_unsigned_eq (consumers[i].unordered, 0, NULL);
+		consumed += consumers[i].consumed;
+		sum += consumers[i].sum;
+	}
+
+	// every item is consumed exactly once
+	test_check_unsigned_eq (consumed, RING_TEST_PRODUCERS * RING_TEST_ITEMS, NULL);
+	test_check (
+		sum == (
+			(unsigned long long) RING_TEST_PRODUCERS
+			* ((unsigned long long) RING_TEST_ITEMS * (RING_TEST_ITEMS - 1) / 2)
+		),
+		NULL
+	);
+
+	test_check_true (ring_is_empty (ring));
+
+	ring_delete (ring);
+
+}
+
+void collections_tests_ring (void) {
+
+	(void) printf ("Testing COLLECTIONS ring...\n");
+
+	test_ring_create ();
+
+	test_ring_push_pop (RING_TYPE_MPMC);
+
+	test_ring_push_pop (RING_TYPE_SPSC);
+
+	test_ring_mpmc_threads ();
+
+	(void) printf ("Done!\n");
+
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 
 #include <client/packets.h>
+#include <client/receive.h>
 
 #include "test.h"
 
@@ -226,6 +227,45 @@ static void test_packets_add_data_multiple (void) {
 
 }
 
+static void test_packets_create_with_buffer (void) {
+
+	ReceiveBufferPool *pool = receive_buffer_pool_create (BUFFER_SIZE, 1);
+	test_check_ptr (pool);
+
+	ReceiveBuffer *buffer = receive_buffer_pool_get (pool);
+	test_check_ptr (buffer);
+	test_check_unsigned_eq (buffer->refs, 1, NULL);
+	test_check_unsigned_eq (buffer->size, BUFFER_SIZE, NULL);
+
+	(void) strncpy (buffer->data, "1234567890", BUFFER_SIZE - 1);
+
+	Packet *first = packet_create_with_buffer (buffer, buffer->data, 5);
+	Packet *second = packet_create_with_buffer (buffer, buffer->data + 5, 5);
+	test_check_ptr (first);
+	test_check_ptr (second);
+	test_check_unsigned_eq (buffer->refs, 3, NULL);
+
+	test_check_ptr_eq (first->receive_buffer, buffer);
+	test_check_ptr_eq (first->data, buffer->data);
+	test_check_ptr_eq (first->data_ptr, buffer->data);
+	test_check_unsigned_eq (first->data_size, 5, NULL);
+	test_check_true (first->data_ref);
+	test_check (!strncmp (second->data_ptr, "67890", 5), NULL);
+
+	// the receiver releases its reference, packets keep the buffer alive
+	receive_buffer_unref (buffer);
+	test_check_unsigned_eq (buffer->refs, 2, NULL);
+
+	packet_delete (first);
+	test_check_unsigned_eq (buffer->refs, 1, NULL);
+
+	// the pool outlives its owner until every buffer has been released
+	receive_buffer_pool_delete (pool);
+
+	packet_delete (second);
+
+}
+
 #pragma endregion
 
 #pragma region public
@@ -513,6 +553,211 @@ static void test_packets_generate_request (void) {
 
 #pragma endregion
 
+#pragma region pool
+
+static void test_packets_pool_reuse (void) {
+
+	PacketsPoolStats before = { 0 };
+	packets_pool_get_stats (&before);
+
+	Packet *packet = packet_create_with_data (BUFFER_SIZE);
+	test_check_ptr (packet);
+	test_check_unsigned_eq (packet->data_class, 2, NULL);
+
+	void *packet_ptr = packet;
+	void *data_ptr = packet->data;
+	packet_delete (packet);
+
+	// the same packet & data are returned by the calling thread's cache
+	packet = packet_create_with_data (BUFFER_SIZE);
+	test_check_ptr_eq (packet, packet_ptr);
+	test_check_ptr_eq (packet->data, data_ptr);
+	test_check_null_ptr (packet->receive_buffer);
+	test_check_unsigned_eq (packet->data_size, BUFFER_SIZE, NULL);
+	test_check_bool_eq (packet->data_ref, false, NULL);
+
+	packet_delete (packet);
+
+	PacketsPoolStats after = { 0 };
+	packets_pool_get_stats (&after);
+	test_check_unsigned_gt (after.packets_hits, before.packets_hits);
+	test_check_unsigned_gt (after.data_hits, before.data_hits);
+
+}
+
+static void test_packets_pool_append_grow (void) {
+
+	char buffer[BUFFER_SIZE] = { 0 };
+	(void) memset (buffer, 'a', BUFFER_SIZE);
+
+	Packet *packet = packet_new ();
+	test_check_ptr (packet);
+
+	// grows inside its class buffer
+	packet_append_data (packet, buffer, 100);
+	test_check_unsigned_eq (packet->data_class, 2, NULL);
+	void *data_ptr = packet->data;
+
+	packet_append_data (packet, buffer, 100);
+	test_check_ptr_eq (packet->data, data_ptr);
+	test_check_unsigned_eq (packet->data_size, 200, NULL);
+
+	// moves to the next class
+	packet_append_data (packet, buffer, 100);
+	test_check_unsigned_eq (packet->data_class, 3, NULL);
+	test_check_unsigned_eq (packet->data_size, 300, NULL);
+	test_check (!memcmp ((char *) packet->data + 200, buffer, 100), NULL);
+	test_check_ptr_eq (packet->data_end, (char *) packet->data + 300);
+
+	packet_delete (packet);
+
+	// bigger than the largest class
+	u8 data_class = 0;
+	void *data = packets_pool_data_get (1048576, &data_class);
+	test_check_ptr (data);
+	test_check_unsigned_eq (data_class, 0, NULL);
+	packets_pool_data_release (data, data_class);
+
+}
+
+static void test_packets_generate_headroom (void) {
+
+	char buffer[BUFFER_SIZE * 4] = { 0 };
+	(void) memset (buffer, 'a', BUFFER_SIZE * 4);
+
+	Packet *packet = packet_create (PACKET_TYPE_TEST, 1, buffer, BUFFER_SIZE);
+	test_check_ptr (packet);
+	test_check_bool_eq (packet->data_headroom, true, NULL);
+
+	// the header is written in front of the data
+	test_check_unsigned_eq (packet_generate (packet), 0, NULL);
+	test_check_ptr_eq (packet->packet, (char *) packet->data - sizeof (PacketHeader));
+	test_check_bool_eq (packet->packet_ref, true, NULL);
+	test_check_unsigned_eq (((PacketHeader *) packet->packet)->packet_size, packet->packet_size, NULL);
+	test_check (!memcmp ((char *) packet->packet + sizeof (PacketHeader), buffer, BUFFER_SIZE), NULL);
+
+	// growing the data drops the generated packet
+	packet_append_data (packet, buffer, BUFFER_SIZE * 4);
+	test_check_null_ptr (packet->packet);
+	test_check_unsigned_eq (packet_generate (packet), 0, NULL);
+	test_check_ptr_eq (packet->packet, (char *) packet->data - sizeof (PacketHeader));
+	test_check_unsigned_eq (packet->packet_size, sizeof (PacketHeader) + BUFFER_SIZE * 5, NULL);
+
+	// referenced data still gets copied
+	(void) packet_set_data_ref (packet, buffer, BUFFER_SIZE);
+	test_check_bool_eq (packet->data_headroom, false, NULL);
+	test_check_unsigned_eq (packet_generate (packet), 0, NULL);
+	test_check_bool_eq (packet->packet_ref, false, NULL);
+	test_check (!memcmp ((char *) packet->packet + sizeof (PacketHeader), buffer, BUFFER_SIZE), NULL);
+
+	packet_delete (packet);
+
+}
+
+#pragma endregion
+
+#pragma region serialize
+
+static void test_packets_writer_reader (void) {
+
+	Packet *packet = packet_new ();
+	test_check_ptr (packet);
+
+	PacketWriter writer = { 0 };
+	test_check_unsigned_eq (packet_writer_init (&writer, packet, 16), 0, NULL);
+	test_check_ptr (packet->data);
+	test_check_unsigned_eq (packet->data_size, 0, NULL);
+
+	test_check_unsigned_eq (packet_writer_put_u8 (&writer, 0xAB), 0, NULL);
+	test_check_unsigned_eq (packet_writer_put_u16 (&writer, 0x1234), 0, NULL);
+	test_check_unsigned_eq (packet_writer_put_u32 (&writer, 0xDEADBEEF), 0, NULL);
+	test_check_unsigned_eq (packet_writer_put_u64 (&writer, 0x0102030405060708), 0, NULL);
+	test_check_unsigned_eq (packet_writer_put_i32 (&writer, -42), 0, NULL);
+	test_check_unsigned_eq (packet_writer_put_string (&writer, "cerver"), 0, NULL);
+	test_check_unsigned_eq (packet_writer_put_blob (&writer, "\0\1\2", 3), 0, NULL);
+	test_check_unsigned_eq (packet->data_size, 1 + 2 + 4 + 8 + 4 + 4 + 6 + 4 + 3, NULL);
+
+	// integers are written in network byte order
+	test_check (!memcmp ((char *) packet->data + 1, "\x12\x34\xDE\xAD\xBE\xEF", 6), NULL);
+
+	// grows geometrically
+	char buffer[BUFFER_SIZE] = { 0 };
+	(void) memset (buffer, 'a', BUFFER_SIZE);
+	for (unsigned int i = 0; i < 32; i++) {
+		test_check_unsigned_eq (packet_writer_put_bytes (&writer, buffer, BUFFER_SIZE), 0, NULL);
+	}
+
+	test_check_unsigned_gt (writer.capacity, packet->data_size - 1);
+
+	test_check_unsigned_eq (packet_writer_finish (&writer), 0, NULL);
+	test_check_unsigned_eq (packet->packet_size, sizeof (PacketHeader) + packet->data_size, NULL);
+
+	PacketReader reader = { 0 };
+	packet_reader_init (&reader, packet);
+
+	u8 value_u8 = 0;
+	u16 value_u16 = 0;
+	u32 value_u32 = 0;
+	u64 value_u64 = 0;
+	i32 value_i32 = 0;
+	char string[16] = { 0 };
+	const void *blob = NULL;
+	u32 blob_size = 0;
+
+	test_check_unsigned_eq (packet_reader_get_u8 (&reader, &value_u8), 0, NULL);
+	test_check_unsigned_eq (value_u8, 0xAB, NULL);
+	test_check_unsigned_eq (packet_reader_get_u16 (&reader, &value_u16), 0, NULL);
+	test_check_unsigned_eq (value_u16, 0x1234, NULL);
+	test_check_unsigned_eq (packet_reader_get_u32 (&reader, &value_u32), 0, NULL);
+	test_check_unsigned_eq (value_u32, 0xDEADBEEF, NULL);
+	test_check_unsigned_eq (packet_reader_get_u64 (&reader, &value_u64), 0, NULL);
+	test_check (value_u64 == 0x0102030405060708, NULL);
+	test_check_unsigned_eq (packet_reader_get_i32 (&reader, &value_i32), 0, NULL);
+	test_check_int_eq (value_i32, -42, NULL);
+	test_check_unsigned_eq (packet_reader_get_string (&reader, string, sizeof (string)), 0, NULL);
+	test_check_str_eq (string, "cerver", NULL);
+	test_check_unsigned_eq (packet_reader_get_blob (&reader, &blob, &blob_size), 0, NULL);
+	test_check_unsigned_eq (blob_size, 3, NULL);
+	test_check (!memcmp (blob, "\0\1\2", 3), NULL);
+
+	test_check_unsigned_eq (packet_reader_remaining (&reader), 32 * BUFFER_SIZE, NULL);
+
+	packet_delete (packet);
+
+}
+
+static void test_packets_reader_bounds (void) {
+
+	// a string whose length goes past the end of the data
+	char data[8] = { 0, 0, 0, 100, 'a', 'b', 'c', 'd' };
+	Packet *packet = packet_create (PACKET_TYPE_TEST, 0, data, sizeof (data));
+	test_check_ptr (packet);
+
+	PacketReader reader = { 0 };
+	packet_reader_init (&reader, packet);
+
+	char string[128] = { 0 };
+	test_check_unsigned_eq (packet_reader_get_string (&reader, string, sizeof (string)), 1, NULL);
+	test_check_bool_eq (reader.error, true, NULL);
+	test_check_ptr_eq (packet->data_ptr, packet->data);
+
+	// every other get fails
+	u8 value = 0;
+	test_check_unsigned_eq (packet_reader_get_u8 (&reader, &value), 1, NULL);
+	test_check_unsigned_eq (packet_reader_remaining (&reader), 0, NULL);
+
+	// reads past the end
+	packet_reader_init (&reader, packet);
+	u64 value_u64 = 0;
+	test_check_unsigned_eq (packet_reader_get_u64 (&reader, &value_u64), 0, NULL);
+	test_check_unsigned_eq (packet_reader_get_u8 (&reader, &value), 1, NULL);
+
+	packet_delete (packet);
+
+}
+
+#pragma endregion
+
 int main (int argc, char **argv) {
 
 	(void) printf ("Testing PACKETS...\n");
@@ -527,6 +772,7 @@ int main (int argc, char **argv) {
 	test_packets_add_data_good ();
 	test_packets_add_data_bad ();
 	test_packets_add_data_multiple ();
+	test_packets_create_with_buffer ();
 
 	// public
 	test_packets_create_ping ();
@@ -539,6 +785,17 @@ int main (int argc, char **argv) {
 	test_packets_generate_full ();
 	test_packets_generate_request ();
 
+	// pool
+	test_packets_pool_reuse ();
+	test_packets_pool_append_grow ();
+	test_packets_generate_headroom ();
+
+	// serialize
+	test_packets_writer_reader ();
+	test_packets_reader_bounds ();
+
+	packets_pool_clear ();
+
 	(void) printf ("\nDone with PACKETS tests!\n\n");
 
 	return 0;
@@ -1,5 +1,7 @@
 #!/bin/bash
 
+./test/bin/client || { exit 1; }
+
 ./test/bin/collections --quiet || { exit 1; }
 
 ./test/bin/json || { exit 1; }
@@ -215,6 +215,86 @@ static void test_job_queue_set_handler (void) {
 
 }
 
+static void test_job_queue_pull_many (void) {
+
+	JobQueue *job_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+
+	test_check_ptr (job_queue);
+
+	for (unsigned int i = 0; i < 10; i++) {
+		test_check_unsigned_eq (
+			job_queue_push_job_with_id (job_queue, i, NULL, NULL), 0, NULL
+		);
+	}
+
+	void *jobs[8] = { 0 };
+
+	// jobs are pulled in order up to the max
+	test_check_unsigned_eq (job_queue_pull_many (job_queue, jobs, 8), 8, NULL);
+	for (unsigned int i = 0; i < 8; i++) {
+		test_check_unsigned_eq (((Job *) jobs[i])->id, i, NULL);
+		job_return (job_queue, (Job *) jobs[i]);
+	}
+
+	test_check_unsigned_eq (job_queue->queue->size, 2, NULL);
+
+	test_check_unsigned_eq (job_queue_pull_many (job_queue, jobs, 8), 2, NULL);
+	test_check_unsigned_eq (((Job *) jobs[0])->id, 8, NULL);
+	test_check_unsigned_eq (((Job *) jobs[1])->id, 9, NULL);
+	job_return (job_queue, (Job *) jobs[0]);
+	job_return (job_queue, (Job *) jobs[1]);
+
+	test_check_unsigned_eq (job_queue_pull_many (job_queue, jobs, 8), 0, NULL);
+
+	job_queue_delete (job_queue);
+
+}
+
+static void test_job_queue_ring (void) {
+
+	JobQueue *job_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+
+	test_check_ptr (job_queue);
+	test_check_unsigned_eq (job_queue_set_ring (job_queue, RING_TYPE_MPMC, 8), 0, NULL);
+	test_check_ptr (job_queue->ring);
+
+	// the ring can only be set once
+	test_check_unsigned_eq (job_queue_set_ring (job_queue, RING_TYPE_MPMC, 8), 1, NULL);
+
+	unsigned int value = 10;
+	for (unsigned int i = 0; i < 8; i++) {
+		test_check_unsigned_eq (
+			job_queue_push_job_with_id (job_queue, i, work_method, &value), 0, NULL
+		);
+	}
+
+	// jobs are not allocated, so a full ring fails
+	test_check_unsigned_eq (job_queue_push_job (job_queue, work_method, &value), 1, NULL);
+	test_check_unsigned_eq (job_queue->queue->size, 0, NULL);
+
+	Job job = { 0 };
+	test_check_unsigned_eq (job_queue_pull_job (job_queue, &job), 0, NULL);
+	test_check_unsigned_eq (job.id, 0, NULL);
+	test_check_ptr_eq (job.work, work_method);
+	test_check_ptr_eq (job.args, &value);
+
+	Job jobs[8] = { 0 };
+	test_check_unsigned_eq (job_queue_pull_jobs (job_queue, jobs, 8), 7, NULL);
+	for (unsigned int i = 0; i < 7; i++) {
+		test_check_unsigned_eq (jobs[i].id, i + 1, NULL);
+	}
+
+	test_check_unsigned_eq (job_queue_pull_job (job_queue, &job), 1, NULL);
+
+	// pointers are returned as they were pushed
+	test_check_unsigned_eq (job_queue_push (job_queue, &value), 0, NULL);
+	test_check_ptr_eq (job_queue_pull (job_queue), &value);
+	test_check_null_ptr (job_queue_pull (job_queue));
+
+	job_queue_delete (job_queue);
+
+}
+
 void threads_tests_jobs (void) {
 
 	(void) printf ("Testing THREADS jobs...\n");
@@ -234,6 +314,8 @@ void threads_tests_jobs (void) {
 	test_job_queue_create_jobs ();
 	test_job_queue_create_handlers ();
 	test_job_queue_set_handler ();
+	test_job_queue_pull_many ();
+	test_job_queue_ring ();
 
 	(void) printf ("Done!\n");
 